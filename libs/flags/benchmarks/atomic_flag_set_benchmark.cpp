@@ -0,0 +1,137 @@
+/**
+ * \file atomic_flag_set_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Size = 128
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Unused:1;
+	} ;
+} ;
+
+namespace
+{
+	typedef rtl::flag_set<Status::Type, Status::Size, Status::Names> status_set;
+	typedef rtl::atomic_flag_set<Status::Type, Status::Size, Status::Names> atomic_status_set;
+
+	const std::int32_t OperationsPerThread = 1000000;
+
+	/// flag_set guarded by a mutex
+	struct locked_status_set
+	{
+		std::mutex _mutex;
+		status_set _flags;
+
+		void set(Status::Type flag)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_flags.set(flag);
+		}
+
+		void clear(Status::Type flag)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_flags.clear(flag);
+		}
+	} ;
+
+	/**
+	 * Runs a set/clear mix on a shared flag set from a number of threads.
+	 *
+	 * \returns The cost of a single operation in nanoseconds of wall time.
+	 */
+	template <typename Set>
+	double run(std::int32_t threadCount)
+	{
+		Set flags;
+		std::vector<std::thread> threads;
+
+		const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		for (std::int32_t t = 0; t < threadCount; ++t)
+		{
+			threads.push_back(std::thread([&flags, t]()
+			{
+				std::uint32_t seed = 0x9e3779b9u * (t + 1);
+
+				for (std::int32_t i = 0; i < OperationsPerThread; i += 2)
+				{
+					seed = seed * 1664525 + 1013904223;
+					const Status::Type flag = static_cast<Status::Type>((seed >> 8) % Status::Size);
+
+					flags.set(flag);
+					flags.clear(flag);
+				}
+			}));
+		}
+
+		for (std::size_t t = 0; t < threads.size(); ++t)
+			threads[t].join();
+
+		const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+		return nanoseconds / (static_cast<double>(OperationsPerThread) * threadCount);
+	}
+
+}
+
+int main()
+{
+	std::printf("%7s %14s %14s %9s\n", "threads", "mutex ns/op", "atomic ns/op", "speedup");
+
+	for (std::int32_t threads = 1; threads <= 64; threads *= 2)
+	{
+		const double locked = run<locked_status_set>(threads);
+		const double atomic = run<atomic_status_set>(threads);
+
+		std::printf("%7d %14.3f %14.3f %8.2fx\n", threads, locked, atomic, locked / atomic);
+	}
+}
@@ -0,0 +1,170 @@
+/**
+ * \file benchmark_harness.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_BENCHMARK_HARNESS_HPP_INCLUDED
+#define RECHARGEABLE_BENCHMARK_HARNESS_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace harness
+{
+	/**
+	 * Keeps the compiler from discarding a value that is never used.
+	 *
+	 * \param value The value to keep.
+	 */
+	template <typename T>
+	inline void do_not_optimize(const T& value)
+	{
+	#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+	#else
+		static volatile char sink;
+		sink = *reinterpret_cast<const volatile char*>(&value);
+	#endif
+	}
+
+	/**
+	 * Runs a benchmark and reports the fastest run.
+	 *
+	 * The function is run once to warm up and then the given number of
+	 * times. Taking the fastest run filters out interruptions.
+	 *
+	 * \param function The function to measure. Performs the given number of operations.
+	 * \param operations The number of operations performed by the function.
+	 * \param runs The number of measured runs.
+	 * \returns The cost of a single operation in nanoseconds.
+	 */
+	template <typename Function>
+	double measure(Function function, std::int64_t operations, std::int32_t runs = 5)
+	{
+		typedef std::chrono::high_resolution_clock clock_type;
+
+		function();
+
+		double best = 0.0;
+
+		for (std::int32_t run = 0; run < runs; ++run)
+		{
+			const clock_type::time_point start = clock_type::now();
+			function();
+			const double elapsed = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+			if ((run == 0) || (elapsed < best))
+				best = elapsed;
+		}
+
+		return best / static_cast<double>(operations);
+	}
+
+	/**
+	 * Writes benchmark results as comma separated values.
+	 *
+	 * Each row records the build so results from Debug and Release
+	 * builds can be collected into one file and compared over time.
+	 */
+	class report
+	{
+		public:
+
+			/**
+			 * Creates an instance of the report class.
+			 *
+			 * \param filter Only benchmarks whose name contains the filter are run. May be null.
+			 */
+			explicit report(const char* filter)
+			: _filter(filter)
+			{
+				std::printf("benchmark,container,bits,build,storage,ns_per_op\n");
+			}
+
+			/**
+			 * Determines whether a benchmark should be run.
+			 *
+			 * \param benchmark The name of the benchmark.
+			 * \returns \b true \b if the benchmark passes the filter; \b false \b otherwise.
+			 */
+			bool enabled(const char* benchmark) const
+			{
+				return (_filter == nullptr) || (std::strstr(benchmark, _filter) != nullptr);
+			}
+
+			/**
+			 * Writes a result.
+			 *
+			 * \param benchmark The name of the benchmark.
+			 * \param container The name of the container measured.
+			 * \param bits The number of bits in the container.
+			 * \param nanoseconds The cost of a single operation.
+			 */
+			void add(const char* benchmark, const char* container, std::int32_t bits, double nanoseconds) const
+			{
+				std::printf("%s,%s,%d,%s,%s,%.4f\n", benchmark, container, bits, build(), storage(), nanoseconds);
+				std::fflush(stdout);
+			}
+
+		private:
+
+			static const char* build()
+			{
+			#ifdef NDEBUG
+				return "release";
+			#else
+				return "debug";
+			#endif
+			}
+
+			static const char* storage()
+			{
+			#ifdef RECHARGEABLE_USE_BIT_UNION
+				return "bit_union";
+			#else
+				return "bit_set";
+			#endif
+			}
+
+			/// The benchmark name filter
+			const char* _filter;
+
+	} ; // end class report
+
+} // end namespace harness
+
+#endif // end RECHARGEABLE_BENCHMARK_HARNESS_HPP_INCLUDED
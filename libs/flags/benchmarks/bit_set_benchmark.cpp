@@ -0,0 +1,156 @@
+/**
+ * \file bit_set_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace legacy
+{
+	// Byte based storage used by bit_set before the move to 64-bit words.
+	template <std::int32_t Bits>
+	struct bit_set
+	{
+		std::uint8_t _bit_array[((Bits + 7) & ~7) >> 3];
+	} ;
+
+	template <std::int32_t Bits>
+	inline void set_bit(bit_set<Bits>& set, std::int32_t location)
+	{
+		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
+		const std::int32_t bit = location - (8 * index);
+
+		set._bit_array[index] |= (1 << bit);
+	}
+
+	template <std::int32_t Bits>
+	inline void clear_bit(bit_set<Bits>& set, std::int32_t location)
+	{
+		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
+		const std::int32_t bit = location - (8 * index);
+
+		set._bit_array[index] &= ~(1 << bit);
+	}
+
+	template <std::int32_t Bits>
+	inline bool is_bit_set(const bit_set<Bits>& set, std::int32_t location)
+	{
+		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
+		const std::int32_t bit = location - (8 * index);
+
+		const std::int32_t mask = (1 << bit);
+		return (set._bit_array[index] & mask) == mask;
+	}
+
+} // end namespace legacy
+
+namespace
+{
+	const std::int32_t Locations = 4096;
+	const std::int32_t Iterations = 20000000;
+
+	volatile std::int32_t sink;
+
+	/**
+	 * Runs a set/query/clear mix against a bit container.
+	 *
+	 * \returns The cost of a single operation in nanoseconds.
+	 */
+	template <typename Set>
+	double run(Set& set, const std::vector<std::int32_t>& locations)
+	{
+		using rtl::detail::set_bit;
+		using rtl::detail::clear_bit;
+		using rtl::detail::is_bit_set;
+
+		std::int32_t hits = 0;
+
+		const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		for (std::int32_t i = 0; i < Iterations; ++i)
+		{
+			set_bit(set, locations[i & (Locations - 1)]);
+			hits += is_bit_set(set, locations[(i + 7) & (Locations - 1)]);
+			clear_bit(set, locations[(i + 13) & (Locations - 1)]);
+		}
+
+		const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		sink = hits;
+
+		const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+		return nanoseconds / (Iterations * 3.0);
+	}
+
+	template <std::int32_t Size>
+	void compare()
+	{
+		std::vector<std::int32_t> locations(Locations);
+		std::uint32_t seed = 0x2545f491;
+
+		for (std::int32_t i = 0; i < Locations; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			locations[i] = static_cast<std::int32_t>((seed >> 8) % Size);
+		}
+
+		legacy::bit_set<Size> before = { };
+		rtl::detail::bit_set<rtl::detail::select_bits<Size>::value> after;
+		rtl::detail::clear_bit_set(after);
+
+		const double beforeTime = run(before, locations);
+		const double afterTime = run(after, locations);
+
+		std::printf("%5d %12.3f %12.3f %9.2fx\n", Size, beforeTime, afterTime, beforeTime / afterTime);
+	}
+
+}
+
+int main()
+{
+	std::printf("%5s %12s %12s %10s\n", "flags", "bytes ns/op", "words ns/op", "speedup");
+
+	compare<33>();
+	compare<40>();
+	compare<64>();
+	compare<96>();
+	compare<128>();
+	compare<200>();
+	compare<256>();
+}
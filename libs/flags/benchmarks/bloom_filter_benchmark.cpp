@@ -0,0 +1,150 @@
+/**
+ * \file bloom_filter_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	const std::int32_t Lookups = 1 << 22;
+
+	/**
+	 * Compares membership tests against std::unordered_set.
+	 *
+	 * Half of the lookups are for inserted keys. The bits reported are
+	 * the size of the filter. The false positive rate is written to
+	 * stderr so stdout stays comma separated values.
+	 *
+	 * \param report The report to write the results to.
+	 * \param benchmark The name of the benchmark.
+	 * \param keyCount The number of keys inserted.
+	 * \returns \b true \b if the filter found every inserted key and the batch agrees; \b false \b otherwise.
+	 */
+	bool compare(const harness::report& report, const char* benchmark, std::int32_t keyCount)
+	{
+		std::mt19937_64 random(keyCount);
+		std::vector<std::uint64_t> keys(keyCount);
+		std::vector<std::uint64_t> lookups(Lookups);
+
+		for (std::uint64_t& key : keys)
+			key = random();
+
+		for (std::uint64_t& key : lookups)
+			key = (random() & 1) ? keys[random() % keyCount] : random();
+
+		std::unordered_set<std::uint64_t> set(keys.begin(), keys.end());
+		rtl::blocked_bloom_filter<> filter(keys.size());
+		filter.insert(keys.data(), keys.size());
+
+		const std::int32_t bits = static_cast<std::int32_t>(filter.memory_usage() * 8);
+
+		std::size_t setFound = 0;
+		std::size_t filterFound = 0;
+		std::size_t batchFound = 0;
+
+		report.add(benchmark, "unordered_set", bits, harness::measure([&]()
+		{
+			setFound = 0;
+
+			for (std::uint64_t key : lookups)
+				setFound += set.count(key);
+
+			harness::do_not_optimize(setFound);
+		}, Lookups));
+
+		report.add(benchmark, "blocked_bloom_filter", bits, harness::measure([&]()
+		{
+			filterFound = 0;
+
+			for (std::uint64_t key : lookups)
+				filterFound += filter.contains(key) ? 1 : 0;
+
+			harness::do_not_optimize(filterFound);
+		}, Lookups));
+
+		std::vector<std::uint8_t> results(lookups.size());
+
+		report.add(benchmark, "blocked_bloom_filter_batch", bits, harness::measure([&]()
+		{
+			batchFound = filter.contains(lookups.data(), lookups.size(), &results[0]);
+
+			harness::do_not_optimize(batchFound);
+		}, Lookups));
+
+		std::fprintf(stderr, "%s: false positive rate %.3f%%\n", benchmark, 100.0 * (filterFound - setFound) / (lookups.size() - setFound));
+
+		return (filterFound >= setFound) && (filterFound == batchFound);
+	}
+
+}
+
+/**
+ * Runs the bloom filter benchmarks and writes the results as CSV to stdout.
+ *
+ * The benchmark names give the number of keys inserted, at 12 bits
+ * per key. An optional argument restricts the run to benchmarks whose
+ * name contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	const struct
+	{
+		const char* name;
+		std::int32_t keys;
+	} runs[] =
+	{
+		{ "contains_1000", 1000 },
+		{ "contains_100000", 100000 },
+		{ "contains_1000000", 1000000 },
+		{ "contains_10000000", 10000000 }
+	} ;
+
+	for (const auto& run : runs)
+	{
+		if (report.enabled(run.name) && !compare(report, run.name, run.keys))
+		{
+			std::fprintf(stderr, "%s: unordered_set, filter and batch disagree\n", run.name);
+			return 1;
+		}
+	}
+}
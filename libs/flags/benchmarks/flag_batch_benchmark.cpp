@@ -0,0 +1,129 @@
+/**
+ * \file flag_batch_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <vector>
+
+namespace Entity
+{
+	enum Type
+	{
+		DirtyThisFrame,
+		Visible,
+		Moving
+	} ;
+
+	struct Names
+	{
+		std::uint32_t DirtyThisFrame:1;
+		std::uint32_t Visible:1;
+		std::uint32_t Moving:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Entities = 200000;
+
+	/**
+	 * Compares setting, counting and clearing one flag in a loop against the batch functions.
+	 *
+	 * \param report The report to write the results to.
+	 * eturns \b true \b if both approaches counted the same flags; \b false \b otherwise.
+	 */
+	template <std::int32_t Size>
+	bool compare(const harness::report& report)
+	{
+		typedef rtl::flag_set<Entity::Type, Size, Entity::Names> entity_set;
+
+		std::vector<entity_set> entities(Entities);
+		std::size_t loopCount = 0;
+		std::size_t batchCount = 0;
+
+		// One flag_set at a time
+		report.add("set_count_clear", "loop", Size, harness::measure([&]()
+		{
+			loopCount = 0;
+
+			for (std::int32_t i = 0; i < Entities; ++i)
+				entities[i].set(Entity::DirtyThisFrame);
+
+			for (std::int32_t i = 0; i < Entities; ++i)
+				loopCount += entities[i].is_set(Entity::DirtyThisFrame) ? 1 : 0;
+
+			for (std::int32_t i = 0; i < Entities; ++i)
+				entities[i].clear(Entity::DirtyThisFrame);
+
+			harness::do_not_optimize(loopCount);
+		}, Entities));
+
+		// Batched
+		report.add("set_count_clear", "batch", Size, harness::measure([&]()
+		{
+			rtl::set_all(&entities[0], Entities, Entity::DirtyThisFrame);
+			batchCount = rtl::count_set(&entities[0], Entities, Entity::DirtyThisFrame);
+			rtl::clear_all(&entities[0], Entities, Entity::DirtyThisFrame);
+
+			harness::do_not_optimize(batchCount);
+		}, Entities));
+
+		return (loopCount == batchCount);
+	}
+
+}
+
+/**
+ * Runs the batch benchmarks and writes the results as CSV to stdout.
+ *
+ * An optional argument restricts the run to benchmarks whose name
+ * contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	if (report.enabled("set_count_clear"))
+	{
+		if (!(compare<8>(report) && compare<16>(report) && compare<32>(report) && compare<64>(report) && compare<128>(report)))
+		{
+			std::fprintf(stderr, "set_count_clear: loop and batch counts disagree\n");
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,143 @@
+/**
+ * \file flag_column_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Burning,
+		Frozen,
+		Poisoned,
+		Size = 48
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Burning:1;
+		std::uint32_t Frozen:1;
+		std::uint32_t Poisoned:1;
+	} ;
+} ;
+
+namespace
+{
+	typedef rtl::flag_set<Status::Type, Status::Size, Status::Names> status_set;
+	typedef rtl::flag_column<Status::Type, Status::Size> status_column;
+
+	const std::int32_t Entities = 1000000;
+	const std::int32_t Repeats = 20;
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	double milliseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count() / Repeats;
+	}
+
+}
+
+int main()
+{
+	std::vector<status_set> entities(Entities);
+	status_column column(Entities);
+
+	std::uint32_t seed = 0x12345678;
+
+	for (std::int32_t i = 0; i < Entities; ++i)
+	{
+		for (std::int32_t flag = 0; flag < Status::Size; ++flag)
+		{
+			seed = seed * 1664525 + 1013904223;
+
+			if ((seed >> 29) < 3)
+			{
+				entities[i].set(static_cast<Status::Type>(flag));
+				column.set(i, static_cast<Status::Type>(flag));
+			}
+		}
+	}
+
+	status_set required;
+	required.set(Status::Burning);
+	required.set(Status::Poisoned);
+
+	status_set excluded;
+	excluded.set(Status::Frozen);
+
+	std::vector<std::int32_t> aosMatches;
+	std::vector<std::int32_t> columnMatches;
+
+	// Array of flag_set
+	clock_type::time_point start = clock_type::now();
+
+	for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+	{
+		aosMatches.clear();
+
+		for (std::int32_t i = 0; i < Entities; ++i)
+		{
+			const status_set& flags = entities[i];
+
+			if (flags.is_set(Status::Burning) && flags.is_set(Status::Poisoned) && !flags.is_set(Status::Frozen))
+				aosMatches.push_back(i);
+		}
+	}
+
+	const double aosTime = milliseconds(start, clock_type::now());
+
+	// Bit-planes
+	start = clock_type::now();
+
+	for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+	{
+		columnMatches.clear();
+		column.match_indices(required, excluded, columnMatches);
+	}
+
+	const double columnTime = milliseconds(start, clock_type::now());
+
+	const std::int32_t count = column.count_matching(required, excluded);
+
+	std::printf("entities %d, matches %d (%s)\n", Entities, static_cast<std::int32_t>(columnMatches.size()), (aosMatches == columnMatches) && (count == static_cast<std::int32_t>(aosMatches.size())) ? "agree" : "DISAGREE");
+	std::printf("%-24s %10.3f ms\n", "flag_set array", aosTime);
+	std::printf("%-24s %10.3f ms\n", "flag_column indices", columnTime);
+}
@@ -0,0 +1,129 @@
+/**
+ * \file flag_delta_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Burning,
+		Frozen,
+		Poisoned,
+		Size = 48
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Burning:1;
+		std::uint32_t Frozen:1;
+		std::uint32_t Poisoned:1;
+	} ;
+} ;
+
+namespace
+{
+	typedef rtl::flag_set<Status::Type, Status::Size, Status::Names> status_set;
+	typedef rtl::flag_delta_traits<status_set> delta_traits;
+
+	const std::int32_t Entities = 100000;
+	const std::int32_t Ticks = 100;
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	double milliseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count() / Ticks;
+	}
+
+}
+
+int main()
+{
+	std::vector<status_set> sent(Entities);
+	std::vector<status_set> received(Entities);
+	std::vector<status_set> current(Entities);
+
+	std::vector<std::uint8_t> full(Entities * sizeof(status_set));
+	std::vector<std::uint8_t> buffer(delta_traits::max_batch_size(Entities));
+
+	std::uint32_t seed = 0x12345678;
+	std::size_t deltaBytes = 0;
+	double fullTime = 0.0;
+	double encodeTime = 0.0;
+	double applyTime = 0.0;
+	bool agree = true;
+
+	for (std::int32_t tick = 0; tick < Ticks; ++tick)
+	{
+		// Change a flag on roughly 2% of the entities
+		for (std::int32_t i = 0; i < Entities; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+
+			if ((seed >> 26) == 0)
+				current[i].toggle(static_cast<Status::Type>((seed >> 8) % Status::Size));
+		}
+
+		// Full state
+		clock_type::time_point start = clock_type::now();
+		std::memcpy(&full[0], &current[0], full.size());
+		fullTime += milliseconds(start, clock_type::now());
+
+		// Deltas
+		start = clock_type::now();
+		const std::size_t written = rtl::encode_deltas(&sent[0], &current[0], Entities, &buffer[0]);
+		encodeTime += milliseconds(start, clock_type::now());
+
+		start = clock_type::now();
+		const std::size_t read = rtl::apply_deltas(&received[0], Entities, &buffer[0], written);
+		applyTime += milliseconds(start, clock_type::now());
+
+		agree = agree && (read == written) && (received == current);
+		deltaBytes += written;
+		sent = current;
+	}
+
+	std::printf("entities %d, ticks %d (%s)\n", Entities, Ticks, agree ? "agree" : "DISAGREE");
+	std::printf("%-24s %10zu bytes/tick %10.3f ms\n", "full state", full.size(), fullTime);
+	std::printf("%-24s %10zu bytes/tick %10.3f ms\n", "delta encode", deltaBytes / Ticks, encodeTime);
+	std::printf("%-24s %10s            %10.3f ms\n", "delta apply", "", applyTime);
+}
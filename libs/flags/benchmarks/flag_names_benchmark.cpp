@@ -0,0 +1,196 @@
+/**
+ * \file flag_names_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Size = 32
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Burning:1;
+	} ;
+} ;
+
+namespace
+{
+	typedef rtl::flag_set<Status::Type, Status::Size, Status::Names> status_set;
+
+	constexpr const char* status_names[] =
+	{
+		"Burning", "Frozen", "Poisoned", "Stunned", "Silenced", "Rooted", "Slowed", "Hasted",
+		"Invisible", "Invulnerable", "Bleeding", "Blinded", "Charmed", "Confused", "Cursed", "Diseased",
+		"Feared", "Frenzied", "Grappled", "Hidden", "Immobile", "Marked", "Petrified", "Prone",
+		"Regenerating", "Shielded", "Sleeping", "Taunted", "Weakened", "Wet", "Chilled", "Shocked"
+	} ;
+
+	constexpr rtl::flag_name_table<Status::Size> status_table(status_names);
+
+	const std::int32_t Lists = 100000;
+
+	/**
+	 * Parses a list with a chain of string compares.
+	 */
+	bool parse_compare(const char* text, std::size_t length, status_set& flags)
+	{
+		flags = status_set();
+
+		const char* position = text;
+		const char* const end = text + length;
+
+		while (position < end)
+		{
+			const char* last = position;
+
+			while ((last != end) && (*last != '|'))
+				++last;
+
+			const std::size_t count = static_cast<std::size_t>(last - position);
+			std::int32_t bit = -1;
+
+			for (std::int32_t i = 0; i < Status::Size; ++i)
+			{
+				if ((std::strlen(status_names[i]) == count) && (std::strncmp(status_names[i], position, count) == 0))
+				{
+					bit = i;
+					break;
+				}
+			}
+
+			if (bit < 0)
+				return false;
+
+			flags.set(static_cast<Status::Type>(bit));
+			position = last + 1;
+		}
+
+		return true;
+	}
+
+}
+
+/**
+ * Runs the flag name benchmarks and writes the results as CSV to stdout.
+ *
+ * An optional argument restricts the run to benchmarks whose name
+ * contains it, for example "parse".
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	std::vector<std::string> lists(Lists);
+	std::uint32_t seed = 0x12345678;
+
+	for (std::int32_t i = 0; i < Lists; ++i)
+	{
+		const std::int32_t count = 1 + (i % 4);
+
+		for (std::int32_t j = 0; j < count; ++j)
+		{
+			seed = seed * 1664525 + 1013904223;
+
+			if (j != 0)
+				lists[i] += '|';
+
+			lists[i] += status_names[(seed >> 8) % Status::Size];
+		}
+	}
+
+	if (report.enabled("parse"))
+	{
+		std::uint64_t compareSum = 0;
+		std::uint64_t tableSum = 0;
+
+		report.add("parse", "string_compare", Status::Size, harness::measure([&]()
+		{
+			compareSum = 0;
+
+			for (std::int32_t i = 0; i < Lists; ++i)
+			{
+				status_set flags;
+				parse_compare(lists[i].data(), lists[i].size(), flags);
+				compareSum += static_cast<std::uint32_t>(flags);
+			}
+
+			harness::do_not_optimize(compareSum);
+		}, Lists));
+
+		report.add("parse", "flag_name_table", Status::Size, harness::measure([&]()
+		{
+			tableSum = 0;
+
+			for (std::int32_t i = 0; i < Lists; ++i)
+			{
+				status_set flags;
+				rtl::parse(lists[i].data(), lists[i].size(), status_table, flags);
+				tableSum += static_cast<std::uint32_t>(flags);
+			}
+
+			harness::do_not_optimize(tableSum);
+		}, Lists));
+
+		if (compareSum != tableSum)
+		{
+			std::fprintf(stderr, "parse: string compares and flag_name_table disagree\n");
+			return 1;
+		}
+	}
+
+	if (report.enabled("format"))
+	{
+		report.add("format", "flag_name_table", Status::Size, harness::measure([&]()
+		{
+			char buffer[256];
+			std::size_t formatted = 0;
+
+			for (std::int32_t i = 0; i < Lists; ++i)
+				formatted += rtl::to_string(status_set(static_cast<std::uint32_t>(i * 2654435761u) & 0x1111u), status_table, buffer, sizeof(buffer));
+
+			harness::do_not_optimize(formatted);
+		}, Lists));
+	}
+}
@@ -0,0 +1,158 @@
+/**
+ * \file flag_query_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Entity
+{
+	enum Type
+	{
+		Alive,
+		Visible,
+		Frozen,
+		Burning,
+		Poisoned,
+		Bleeding,
+		Stunned,
+		Hidden
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Alive:1;
+		std::uint32_t Visible:1;
+		std::uint32_t Frozen:1;
+		std::uint32_t Burning:1;
+		std::uint32_t Poisoned:1;
+		std::uint32_t Bleeding:1;
+		std::uint32_t Stunned:1;
+		std::uint32_t Hidden:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Entities = 200000;
+
+	/**
+	 * Compares a chain of is_set calls against a folded predicate.
+	 *
+	 * \param report The report to write the results to.
+	 * \returns \b true \b if both approaches matched the same entities; \b false \b otherwise.
+	 */
+	template <std::int32_t Size>
+	bool compare(const harness::report& report)
+	{
+		using namespace rtl::query;
+
+		typedef rtl::flag_set<Entity::Type, Size, Entity::Names> entity_set;
+
+		std::vector<entity_set> entities(Entities);
+		std::mt19937 random(Size);
+
+		for (std::int32_t i = 0; i < Entities; ++i)
+		{
+			for (std::int32_t flag = 0; flag < 8; ++flag)
+			{
+				if (random() & 1)
+					entities[i].set(static_cast<Entity::Type>(flag));
+			}
+		}
+
+		std::size_t loopCount = 0;
+		std::size_t predicateCount = 0;
+
+		// Chain of is_set calls
+		report.add("query", "is_set", Size, harness::measure([&]()
+		{
+			loopCount = 0;
+
+			for (std::int32_t i = 0; i < Entities; ++i)
+			{
+				const entity_set& flags = entities[i];
+
+				loopCount +=
+					(flags.is_set(Entity::Alive) &&
+					 flags.is_set(Entity::Visible) &&
+					!flags.is_set(Entity::Frozen) &&
+					!flags.is_set(Entity::Hidden) &&
+					(flags.is_set(Entity::Burning) || flags.is_set(Entity::Poisoned) || flags.is_set(Entity::Bleeding))) ? 1 : 0;
+			}
+
+			harness::do_not_optimize(loopCount);
+		}, Entities));
+
+		// Folded predicate
+		constexpr auto predicate = rtl::make_predicate<entity_set>(
+			has(Entity::Alive) & has(Entity::Visible) & lacks(Entity::Frozen) & lacks(Entity::Hidden) & any(Entity::Burning, Entity::Poisoned, Entity::Bleeding)
+		);
+
+		report.add("query", "predicate", Size, harness::measure([&]()
+		{
+			predicateCount = rtl::count_matching(&entities[0], Entities, predicate);
+
+			harness::do_not_optimize(predicateCount);
+		}, Entities));
+
+		return (loopCount == predicateCount);
+	}
+
+}
+
+/**
+ * Runs the query benchmarks and writes the results as CSV to stdout.
+ *
+ * An optional argument restricts the run to benchmarks whose name
+ * contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	if (report.enabled("query"))
+	{
+		if (!(compare<8>(report) && compare<16>(report) && compare<32>(report) && compare<64>(report) && compare<128>(report)))
+		{
+			std::fprintf(stderr, "query: is_set chain and predicate disagree\n");
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,168 @@
+/**
+ * \file flag_signature_index_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <rtl/flags/flag_signature_index.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Component
+{
+	enum Type
+	{
+		Transform,
+		Velocity,
+		Renderable
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Transform:1;
+		std::uint32_t Velocity:1;
+		std::uint32_t Renderable:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Entities = 2000000;
+	const std::int32_t Queries = 1000;
+	const std::int32_t Bits = 64;
+
+	typedef rtl::flag_set<Component::Type, Bits, Component::Names> component_set;
+
+	/**
+	 * Compares scanning every entity to querying the signature index.
+	 *
+	 * Both are reported per query. The index answers a query far faster
+	 * than the clock resolution so its query is repeated.
+	 *
+	 * \param report The report to write the results to.
+	 * \param benchmark The name of the benchmark.
+	 * \param signatures The number of distinct signatures.
+	 * \returns \b true \b if both approaches counted the same entities; \b false \b otherwise.
+	 */
+	bool compare(const harness::report& report, const char* benchmark, std::int32_t signatures)
+	{
+		std::mt19937_64 random(signatures);
+		std::vector<component_set> archetypes(signatures);
+
+		for (component_set& archetype : archetypes)
+		{
+			for (std::int32_t bit = 0; bit < Bits; ++bit)
+			{
+				if ((random() % 6) == 0)
+					archetype.set(static_cast<Component::Type>(bit));
+			}
+		}
+
+		std::vector<component_set> entities(Entities);
+		rtl::flag_signature_index<component_set> index;
+
+		for (std::int32_t i = 0; i < Entities; ++i)
+		{
+			entities[i] = archetypes[random() % signatures];
+			index.insert(i, entities[i]);
+		}
+
+		const component_set mask(Component::Transform, Component::Velocity);
+		std::size_t scanCount = 0;
+		std::size_t indexCount = 0;
+
+		// Per entity is_set calls
+		report.add(benchmark, "scan", Bits, harness::measure([&]()
+		{
+			scanCount = 0;
+
+			for (std::int32_t i = 0; i < Entities; ++i)
+			{
+				if (entities[i].is_set(Component::Transform) && entities[i].is_set(Component::Velocity))
+					++scanCount;
+			}
+
+			harness::do_not_optimize(scanCount);
+		}, 1));
+
+		// Signature index
+		report.add(benchmark, "flag_signature_index", Bits, harness::measure([&]()
+		{
+			for (std::int32_t query = 0; query < Queries; ++query)
+			{
+				indexCount = index.count_supersets(mask);
+
+				harness::do_not_optimize(indexCount);
+			}
+		}, Queries));
+
+		return (scanCount == indexCount);
+	}
+
+}
+
+/**
+ * Runs the signature index benchmarks and writes the results as CSV to stdout.
+ *
+ * Each benchmark counts the entities with Transform and Velocity, and
+ * its name gives the number of distinct signatures. An optional
+ * argument restricts the run to benchmarks whose name contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	const struct
+	{
+		const char* name;
+		std::int32_t signatures;
+	} runs[] =
+	{
+		{ "count_supersets_16", 16 },
+		{ "count_supersets_256", 256 },
+		{ "count_supersets_4096", 4096 }
+	} ;
+
+	for (const auto& run : runs)
+	{
+		if (report.enabled(run.name) && !compare(report, run.name, run.signatures))
+		{
+			std::fprintf(stderr, "%s: scan and flag_signature_index disagree\n", run.name);
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,171 @@
+/**
+ * \file flag_snapshot_ring_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace Entity
+{
+	enum Type
+	{
+		Grounded,
+		Jumping,
+		Firing
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Grounded:1;
+		std::uint32_t Jumping:1;
+		std::uint32_t Firing:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Entities = 1 << 20;
+	const std::int32_t Ticks = 600;
+	const std::int32_t History = 8;
+	const std::int32_t Bits = 64;
+
+	typedef rtl::flag_set<Entity::Type, Bits, Entity::Names> entity_set;
+	typedef rtl::flag_snapshot_ring<entity_set, History> ring_type;
+
+	/**
+	 * Compares copying the whole table each tick to the snapshot ring.
+	 *
+	 * Each tick a number of entities are modified and a snapshot is
+	 * taken. Every tenth tick rolls back four ticks. Both approaches
+	 * start from a cleared table on every run.
+	 *
+	 * \param report The report to write the results to.
+	 * \param benchmark The name of the benchmark.
+	 * \param writes The number of entities modified each tick.
+	 * \param clustered Whether the modified entities are contiguous.
+	 * \returns \b true \b if both approaches end with the same table; \b false \b otherwise.
+	 */
+	bool compare(const harness::report& report, const char* benchmark, std::int32_t writes, bool clustered)
+	{
+		std::mt19937 random(writes);
+		std::vector<std::int32_t> targets(static_cast<std::size_t>(Ticks) * writes);
+
+		for (std::size_t i = 0; i < targets.size(); ++i)
+			targets[i] = clustered ? static_cast<std::int32_t>(((i / writes) * 977 + (i % writes)) % Entities) : static_cast<std::int32_t>(random() % Entities);
+
+		// Full copies
+		std::vector<entity_set> table;
+		std::vector<std::vector<entity_set> > copies(History, std::vector<entity_set>(Entities));
+
+		report.add(benchmark, "full_copy", Bits, harness::measure([&]()
+		{
+			table.assign(Entities, entity_set());
+
+			for (std::int32_t tick = 0; tick < Ticks; ++tick)
+			{
+				for (std::int32_t i = 0; i < writes; ++i)
+					table[targets[tick * writes + i]].toggle(Entity::Jumping);
+
+				copies[tick % History] = table;
+
+				if ((tick % 10 == 9) && (tick >= 4))
+					table = copies[(tick - 4) % History];
+			}
+		}, Ticks));
+
+		// Snapshot ring
+		std::unique_ptr<ring_type> ring;
+
+		report.add(benchmark, "flag_snapshot_ring", Bits, harness::measure([&]()
+		{
+			ring.reset(new ring_type(Entities));
+
+			for (std::int32_t tick = 0; tick < Ticks; ++tick)
+			{
+				for (std::int32_t i = 0; i < writes; ++i)
+					ring->modify(targets[tick * writes + i]).toggle(Entity::Jumping);
+
+				ring->snapshot();
+
+				if ((tick % 10 == 9) && (tick >= 4))
+					ring->restore(ring->newest_tick() - 4);
+			}
+		}, Ticks));
+
+		return std::equal(table.begin(), table.end(), ring->data());
+	}
+
+}
+
+/**
+ * Runs the snapshot ring benchmarks and writes the results as CSV to stdout.
+ *
+ * The benchmark names give the writes per tick and their pattern. An
+ * optional argument restricts the run to benchmarks whose name
+ * contains it, for example "clustered".
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	const struct
+	{
+		const char* name;
+		std::int32_t writes;
+		bool clustered;
+	} runs[] =
+	{
+		{ "rollback_random_16", 16, false },
+		{ "rollback_random_256", 256, false },
+		{ "rollback_random_4096", 4096, false },
+		{ "rollback_clustered_4096", 4096, true },
+		{ "rollback_clustered_65536", 65536, true }
+	} ;
+
+	for (const auto& run : runs)
+	{
+		if (report.enabled(run.name) && !compare(report, run.name, run.writes, run.clustered))
+		{
+			std::fprintf(stderr, "%s: full copies and flag_snapshot_ring disagree\n", run.name);
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,147 @@
+/**
+ * \file flag_table_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <rtl/flags/flag_table.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Burning,
+		Frozen,
+		Poisoned,
+		Size = 48
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Burning:1;
+		std::uint32_t Frozen:1;
+		std::uint32_t Poisoned:1;
+	} ;
+} ;
+
+namespace
+{
+	typedef rtl::flag_set<Status::Type, Status::Size, Status::Names> status_set;
+
+	const std::int32_t Entities = 4000000;
+	const std::int32_t Repeats = 10;
+	const char* const Path = "flag_table_benchmark.rtlf";
+	const std::uint64_t Schema = rtl::flag_schema_hash("Burning,Frozen,Poisoned");
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	double milliseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count() / Repeats;
+	}
+
+}
+
+int main()
+{
+	std::vector<status_set> entities(Entities);
+
+	std::uint32_t seed = 0x12345678;
+
+	for (std::int32_t i = 0; i < Entities; ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		entities[i] = status_set(static_cast<std::uint64_t>(seed));
+	}
+
+	if (rtl::write_flag_table(Path, &entities[0], Entities, Schema) != rtl::flag_table_ok)
+	{
+		std::printf("failed to write %s\n", Path);
+		return 1;
+	}
+
+	std::uint64_t readChecksum = 0;
+	std::uint64_t mapChecksum = 0;
+
+	// Element by element
+	clock_type::time_point start = clock_type::now();
+
+	for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+	{
+		std::vector<status_set> loaded;
+		std::FILE* file = std::fopen(Path, "rb");
+
+		rtl::flag_table_header header;
+
+		if ((file != nullptr) && (std::fread(&header, sizeof(header), 1, file) == 1))
+		{
+			loaded.reserve(static_cast<std::size_t>(header.count));
+
+			status_set flags;
+
+			while (std::fread(&flags, sizeof(flags), 1, file) == 1)
+				loaded.push_back(flags);
+		}
+
+		if (file != nullptr)
+			std::fclose(file);
+
+		readChecksum += loaded.size() + static_cast<std::uint64_t>(loaded.back());
+	}
+
+	const double readTime = milliseconds(start, clock_type::now());
+
+	// Memory mapped
+	start = clock_type::now();
+
+	for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+	{
+		rtl::flag_table_view<status_set> view;
+
+		if (view.open(Path, Schema) == rtl::flag_table_ok)
+			mapChecksum += view.size() + static_cast<std::uint64_t>(view[view.size() - 1]);
+	}
+
+	const double mapTime = milliseconds(start, clock_type::now());
+
+	std::remove(Path);
+
+	std::printf("entities %d (%s)\n", Entities, (readChecksum == mapChecksum) ? "agree" : "DISAGREE");
+	std::printf("%-24s %10.3f ms\n", "element by element", readTime);
+	std::printf("%-24s %10.3f ms\n", "flag_table_view", mapTime);
+}
@@ -0,0 +1,473 @@
+/**
+ * \file flags_benchmarks.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <algorithm>
+#include <bitset>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum bench_flag : std::int32_t { } ;
+
+	struct bench_names
+	{
+		std::uint32_t First:1;
+	} ;
+
+	//----------------------------------------------------------------------
+	// Containers
+	//
+	// Each adapter exposes the same operations so the benchmarks can be
+	// written once for every container.
+	//----------------------------------------------------------------------
+
+	/**
+	 * Adapts rtl::flag_set.
+	 */
+	template <std::int32_t Bits>
+	struct flag_set_adapter
+	{
+		typedef rtl::flag_set<bench_flag, Bits, bench_names> type;
+
+		static const char* name() { return "flag_set"; }
+
+		static type make() { return type(); }
+		static type make(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d)
+		{
+			return type { static_cast<bench_flag>(a), static_cast<bench_flag>(b), static_cast<bench_flag>(c), static_cast<bench_flag>(d) };
+		}
+
+		static void set(type& value, std::int32_t location) { value.set(static_cast<bench_flag>(location)); }
+		static void clear(type& value, std::int32_t location) { value.clear(static_cast<bench_flag>(location)); }
+		static bool test(const type& value, std::int32_t location) { return value.is_set(static_cast<bench_flag>(location)); }
+
+		static type bulk(const type& a, const type& b, const type& c) { return (a & b) | (c ^ ~a); }
+		static std::int32_t count(const type& value) { return value.count(); }
+
+		template <typename Function>
+		static void for_each(const type& value, Function function)
+		{
+			value.for_each_set([&](bench_flag flag) { function(static_cast<std::int32_t>(flag)); });
+		}
+	} ;
+
+	/**
+	 * Holds bits in the smallest built in integer, or an array of 64-bit words.
+	 */
+	template <std::int32_t Bits>
+	struct raw_bits
+	{
+		typedef typename std::conditional<(Bits <= 8), std::uint8_t,
+			typename std::conditional<(Bits <= 16), std::uint16_t,
+			typename std::conditional<(Bits <= 32), std::uint32_t, std::uint64_t>::type>::type>::type word_type;
+
+		static const std::int32_t word_bits = sizeof(word_type) * 8;
+		static const std::int32_t word_count = (Bits + word_bits - 1) / word_bits;
+
+		word_type words[word_count];
+	} ;
+
+	/**
+	 * Adapts hand written integer code.
+	 */
+	template <std::int32_t Bits>
+	struct raw_adapter
+	{
+		typedef raw_bits<Bits> type;
+		typedef typename type::word_type word_type;
+
+		static const char* name() { return "raw"; }
+
+		static type make() { type value = { }; return value; }
+		static type make(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d)
+		{
+			type value = { };
+			set(value, a);
+			set(value, b);
+			set(value, c);
+			set(value, d);
+			return value;
+		}
+
+		static void set(type& value, std::int32_t location)
+		{
+			value.words[location / type::word_bits] |= static_cast<word_type>(word_type(1) << (location % type::word_bits));
+		}
+
+		static void clear(type& value, std::int32_t location)
+		{
+			value.words[location / type::word_bits] &= static_cast<word_type>(~(word_type(1) << (location % type::word_bits)));
+		}
+
+		static bool test(const type& value, std::int32_t location)
+		{
+			return ((value.words[location / type::word_bits] >> (location % type::word_bits)) & 1) != 0;
+		}
+
+		static type bulk(const type& a, const type& b, const type& c)
+		{
+			type result;
+
+			for (std::int32_t i = 0; i < type::word_count; ++i)
+				result.words[i] = static_cast<word_type>((a.words[i] & b.words[i]) | (c.words[i] ^ static_cast<word_type>(~a.words[i])));
+
+			return result;
+		}
+
+		static std::int32_t count(const type& value)
+		{
+			std::int32_t total = 0;
+
+			for (std::int32_t i = 0; i < type::word_count; ++i)
+				total += rtl::detail::popcount(value.words[i]);
+
+			return total;
+		}
+
+		template <typename Function>
+		static void for_each(const type& value, Function function)
+		{
+			for (std::int32_t i = 0; i < type::word_count; ++i)
+			{
+				std::uint64_t word = value.words[i];
+
+				while (word != 0)
+				{
+					function((i * type::word_bits) + rtl::detail::count_trailing_zeros(word));
+					word &= word - 1;
+				}
+			}
+		}
+	} ;
+
+	/**
+	 * Adapts std::bitset.
+	 */
+	template <std::int32_t Bits>
+	struct bitset_adapter
+	{
+		typedef std::bitset<Bits> type;
+
+		static const char* name() { return "std::bitset"; }
+
+		static type make() { return type(); }
+		static type make(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d)
+		{
+			type value;
+			value.set(a);
+			value.set(b);
+			value.set(c);
+			value.set(d);
+			return value;
+		}
+
+		static void set(type& value, std::int32_t location) { value.set(location); }
+		static void clear(type& value, std::int32_t location) { value.reset(location); }
+		static bool test(const type& value, std::int32_t location) { return value[location]; }
+
+		static type bulk(const type& a, const type& b, const type& c) { return (a & b) | (c ^ ~a); }
+		static std::int32_t count(const type& value) { return static_cast<std::int32_t>(value.count()); }
+
+		template <typename Function>
+		static void for_each(const type& value, Function function)
+		{
+			for (std::int32_t i = 0; i < Bits; ++i)
+			{
+				if (value[i])
+					function(i);
+			}
+		}
+	} ;
+
+	/**
+	 * Adapts std::vector<bool>.
+	 */
+	template <std::int32_t Bits>
+	struct vector_bool_adapter
+	{
+		typedef std::vector<bool> type;
+
+		static const char* name() { return "std::vector<bool>"; }
+
+		static type make() { return type(Bits); }
+		static type make(std::int32_t a, std::int32_t b, std::int32_t c, std::int32_t d)
+		{
+			type value(Bits);
+			value[a] = true;
+			value[b] = true;
+			value[c] = true;
+			value[d] = true;
+			return value;
+		}
+
+		static void set(type& value, std::int32_t location) { value[location] = true; }
+		static void clear(type& value, std::int32_t location) { value[location] = false; }
+		static bool test(const type& value, std::int32_t location) { return value[location]; }
+
+		static type bulk(const type& a, const type& b, const type& c)
+		{
+			type result(Bits);
+
+			for (std::int32_t i = 0; i < Bits; ++i)
+				result[i] = (a[i] && b[i]) || (c[i] != !a[i]);
+
+			return result;
+		}
+
+		static std::int32_t count(const type& value)
+		{
+			return static_cast<std::int32_t>(std::count(value.begin(), value.end(), true));
+		}
+
+		template <typename Function>
+		static void for_each(const type& value, Function function)
+		{
+			for (std::int32_t i = 0; i < Bits; ++i)
+			{
+				if (value[i])
+					function(i);
+			}
+		}
+	} ;
+
+	//----------------------------------------------------------------------
+	// Benchmarks
+	//----------------------------------------------------------------------
+
+	/// The number of values cycled through by a benchmark
+	const std::int32_t Values = 64;
+	/// The number of random locations cycled through by a benchmark
+	const std::int32_t Locations = 4096;
+	/// The number of bit operations performed by a benchmark
+	const std::int64_t Work = 20000000;
+
+	/**
+	 * Generates pseudo random numbers.
+	 */
+	struct random_source
+	{
+		random_source()
+		: seed(0x2545f491)
+		{ }
+
+		std::uint32_t next()
+		{
+			seed = seed * 1664525 + 1013904223;
+			return seed >> 8;
+		}
+
+		std::uint32_t seed;
+	} ;
+
+	/**
+	 * Creates values with roughly a quarter of their bits set.
+	 */
+	template <typename Adapter, std::int32_t Bits>
+	std::vector<typename Adapter::type> make_values()
+	{
+		random_source random;
+		std::vector<typename Adapter::type> values;
+
+		for (std::int32_t i = 0; i < Values; ++i)
+		{
+			typename Adapter::type value = Adapter::make();
+
+			for (std::int32_t bit = 0; bit < Bits; ++bit)
+			{
+				if ((random.next() & 3) == 0)
+					Adapter::set(value, bit);
+			}
+
+			values.push_back(value);
+		}
+
+		return values;
+	}
+
+	/**
+	 * Sets, tests and clears single bits at random locations.
+	 */
+	template <typename Adapter, std::int32_t Bits>
+	double single_bit()
+	{
+		random_source random;
+		std::vector<std::int32_t> locations(Locations);
+
+		for (std::int32_t i = 0; i < Locations; ++i)
+			locations[i] = static_cast<std::int32_t>(random.next() % Bits);
+
+		typename Adapter::type value = Adapter::make();
+		const std::int64_t iterations = Work / 3;
+
+		return harness::measure([&]()
+		{
+			std::int32_t hits = 0;
+
+			for (std::int64_t i = 0; i < iterations; ++i)
+			{
+				Adapter::set(value, locations[i & (Locations - 1)]);
+				hits += Adapter::test(value, locations[(i + 7) & (Locations - 1)]);
+				Adapter::clear(value, locations[(i + 13) & (Locations - 1)]);
+			}
+
+			harness::do_not_optimize(hits);
+		}, iterations * 3);
+	}
+
+	/**
+	 * Combines whole values and counts the result.
+	 */
+	template <typename Adapter, std::int32_t Bits>
+	double bulk()
+	{
+		const std::vector<typename Adapter::type> values = make_values<Adapter, Bits>();
+		const std::int64_t iterations = std::max<std::int64_t>(Work / Bits, 1000);
+
+		return harness::measure([&]()
+		{
+			std::int32_t total = 0;
+
+			for (std::int64_t i = 0; i < iterations; ++i)
+			{
+				const typename Adapter::type result = Adapter::bulk(values[i & (Values - 1)], values[(i + 1) & (Values - 1)], values[(i + 2) & (Values - 1)]);
+				total += Adapter::count(result);
+			}
+
+			harness::do_not_optimize(total);
+		}, iterations);
+	}
+
+	/**
+	 * Visits every bit set.
+	 */
+	template <typename Adapter, std::int32_t Bits>
+	double iteration()
+	{
+		const std::vector<typename Adapter::type> values = make_values<Adapter, Bits>();
+		const std::int64_t iterations = std::max<std::int64_t>(Work / Bits, 1000);
+
+		return harness::measure([&]()
+		{
+			std::int32_t total = 0;
+
+			for (std::int64_t i = 0; i < iterations; ++i)
+				Adapter::for_each(values[i & (Values - 1)], [&](std::int32_t location) { total += location; });
+
+			harness::do_not_optimize(total);
+		}, iterations);
+	}
+
+	/**
+	 * Constructs values from four flags.
+	 */
+	template <typename Adapter, std::int32_t Bits>
+	double construction()
+	{
+		random_source random;
+		std::vector<std::int32_t> locations(Locations);
+
+		for (std::int32_t i = 0; i < Locations; ++i)
+			locations[i] = static_cast<std::int32_t>(random.next() % Bits);
+
+		const std::int64_t iterations = Work / 4;
+
+		return harness::measure([&]()
+		{
+			std::int32_t total = 0;
+
+			for (std::int64_t i = 0; i < iterations; ++i)
+			{
+				const std::int64_t j = i & (Locations - 1);
+				const typename Adapter::type value = Adapter::make(locations[j], locations[(j + 1) & (Locations - 1)], locations[(j + 2) & (Locations - 1)], locations[(j + 3) & (Locations - 1)]);
+
+				total += Adapter::test(value, locations[j]);
+			}
+
+			harness::do_not_optimize(total);
+		}, iterations);
+	}
+
+	template <template <std::int32_t> class Adapter, std::int32_t Bits>
+	void run_container(const harness::report& report)
+	{
+		typedef Adapter<Bits> adapter;
+
+		if (report.enabled("single_bit"))
+			report.add("single_bit", adapter::name(), Bits, single_bit<adapter, Bits>());
+
+		if (report.enabled("bulk"))
+			report.add("bulk", adapter::name(), Bits, bulk<adapter, Bits>());
+
+		if (report.enabled("iteration"))
+			report.add("iteration", adapter::name(), Bits, iteration<adapter, Bits>());
+
+		if (report.enabled("construction"))
+			report.add("construction", adapter::name(), Bits, construction<adapter, Bits>());
+	}
+
+	template <std::int32_t Bits>
+	void run_size(const harness::report& report)
+	{
+		run_container<flag_set_adapter, Bits>(report);
+		run_container<raw_adapter, Bits>(report);
+		run_container<bitset_adapter, Bits>(report);
+		run_container<vector_bool_adapter, Bits>(report);
+	}
+
+}
+
+/**
+ * Runs the flags benchmarks and writes the results as CSV to stdout.
+ *
+ * An optional argument restricts the run to benchmarks whose name
+ * contains it, for example "bulk".
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	run_size<8>(report);
+	run_size<16>(report);
+	run_size<32>(report);
+	run_size<64>(report);
+	run_size<128>(report);
+	run_size<256>(report);
+	run_size<1024>(report);
+}
@@ -0,0 +1,140 @@
+/**
+ * \file hierarchical_bit_set_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const std::int32_t Slots = 1 << 20;
+	const std::int32_t Operations = 20000;
+
+	typedef rtl::hierarchical_bit_set<Slots> hierarchical_type;
+	typedef rtl::detail::bit_set<Slots> flat_type;
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	double nanoseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::nano>(end - start).count() / Operations;
+	}
+
+	/**
+	 * Finds the first clear bit with a linear scan of the words.
+	 */
+	std::int32_t find_first_clear(const flat_type& slots)
+	{
+		const flat_type::word_type* words = rtl::detail::word_data(slots);
+
+		for (std::int32_t i = 0; i < flat_type::word_count; ++i)
+		{
+			if (words[i] != ~flat_type::word_type(0))
+				return (i << 6) + rtl::detail::count_trailing_zeros(~words[i]);
+		}
+
+		return -1;
+	}
+
+}
+
+int main()
+{
+	std::unique_ptr<hierarchical_type> hierarchical(new hierarchical_type);
+	std::unique_ptr<flat_type> flat(new flat_type());
+
+	const double fills[] = { 0.5, 0.9, 0.99, 0.999 };
+
+	std::printf("%-10s %20s %20s\n", "full", "linear ns/op", "hierarchical ns/op");
+
+	for (std::size_t f = 0; f < sizeof(fills) / sizeof(fills[0]); ++f)
+	{
+		const std::int32_t used = static_cast<std::int32_t>(Slots * fills[f]);
+
+		hierarchical->clear_all();
+		rtl::detail::clear_bit_set(*flat);
+
+		for (std::int32_t i = 0; i < used; ++i)
+		{
+			hierarchical->set(i);
+			rtl::detail::set_bit(*flat, i);
+		}
+
+		// Free a random slot below the fill line then allocate the lowest free slot
+		std::vector<std::int32_t> frees(Operations);
+		std::uint32_t seed = 0x12345678;
+
+		for (std::int32_t i = 0; i < Operations; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			frees[i] = static_cast<std::int32_t>(seed % static_cast<std::uint32_t>(used));
+		}
+
+		std::int64_t flatSum = 0;
+		std::int64_t hierarchicalSum = 0;
+
+		clock_type::time_point start = clock_type::now();
+
+		for (std::int32_t i = 0; i < Operations; ++i)
+		{
+			rtl::detail::clear_bit(*flat, frees[i]);
+
+			const std::int32_t slot = find_first_clear(*flat);
+			rtl::detail::set_bit(*flat, slot);
+			flatSum += slot;
+		}
+
+		const double flatTime = nanoseconds(start, clock_type::now());
+
+		start = clock_type::now();
+
+		for (std::int32_t i = 0; i < Operations; ++i)
+		{
+			hierarchical->clear(frees[i]);
+
+			const std::int32_t slot = hierarchical->find_first_clear();
+			hierarchical->set(slot);
+			hierarchicalSum += slot;
+		}
+
+		const double hierarchicalTime = nanoseconds(start, clock_type::now());
+
+		std::printf("%-10.3f %20.1f %20.1f %s\n", fills[f], flatTime, hierarchicalTime, (flatSum == hierarchicalSum) ? "" : "DISAGREE");
+	}
+}
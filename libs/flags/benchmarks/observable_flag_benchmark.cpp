@@ -0,0 +1,291 @@
+/**
+ * \file observable_flag_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <rtl/flags/observable_flag_table.hpp>
+#include "benchmark_harness.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace Entity
+{
+	enum Type
+	{
+		Visible,
+		Moving,
+		Jumping,
+		Firing,
+		Damaged,
+		Dead,
+		Audible,
+		Replicated
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Visible:1;
+		std::uint32_t Moving:1;
+		std::uint32_t Jumping:1;
+		std::uint32_t Firing:1;
+		std::uint32_t Damaged:1;
+		std::uint32_t Dead:1;
+		std::uint32_t Audible:1;
+		std::uint32_t Replicated:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Flags = 8;
+	const std::int32_t Frames = 100;
+
+	typedef rtl::flag_set<Entity::Type, Flags, Entity::Names> entity_set;
+	typedef rtl::observable_flag_table<entity_set> observable_table;
+
+	/**
+	 * The state a subscriber keeps for each entity.
+	 *
+	 * A system reacting to a flag, such as a widget or a sound voice,
+	 * typically owns at least a cache line of data per entity.
+	 */
+	struct record
+	{
+		std::uint32_t value;
+		std::uint32_t changes;
+		std::uint8_t padding[56];
+	} ;
+
+	typedef std::vector<std::vector<record> > state_type;
+
+	/**
+	 * Applies a change to the state of a subscriber.
+	 */
+	inline void apply(record* state, std::int32_t entity, bool value)
+	{
+		state[entity].value = value ? 1 : 0;
+		state[entity].changes++;
+	}
+
+	/**
+	 * Determines whether the state of two sets of subscribers match.
+	 */
+	bool same_state(const state_type& lhs, const state_type& rhs)
+	{
+		for (std::size_t flag = 0; flag < lhs.size(); ++flag)
+		{
+			for (std::size_t entity = 0; entity < lhs[flag].size(); ++entity)
+			{
+				if (lhs[flag][entity].value != rhs[flag][entity].value)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Clears the state of a set of subscribers.
+	 */
+	void reset_state(state_type& state)
+	{
+		for (std::vector<record>& records : state)
+			std::fill(records.begin(), records.end(), record());
+	}
+
+	/**
+	 * Compares firing callbacks on every write to dispatching at a sync.
+	 *
+	 * Each frame a number of random flags of entities drawn from a hot
+	 * subset are set, cleared or toggled. Every flag has one subscriber
+	 * that updates a record of the entity it is told about. Both
+	 * approaches start from cleared entities on every run. The results
+	 * are nanoseconds per frame, and the changes dispatched per frame
+	 * are written to stderr.
+	 *
+	 * \param report The report to write the results to.
+	 * \param benchmark The name of the benchmark.
+	 * \param entities The number of entities.
+	 * \param hot The number of entities written to.
+	 * \param writes The number of writes each frame.
+	 * \returns \b true \b if both approaches end with the same flags and state; \b false \b otherwise.
+	 */
+	bool compare(const harness::report& report, const char* benchmark, std::int32_t entities, std::int32_t hot, std::int32_t writes)
+	{
+		std::mt19937 random(entities + hot);
+		std::vector<std::int32_t> hotEntities(hot);
+		std::vector<std::uint32_t> operations(static_cast<std::size_t>(Frames) * writes);
+
+		for (std::int32_t i = 0; i < hot; ++i)
+			hotEntities[i] = static_cast<std::int32_t>(random() % entities);
+
+		for (std::size_t i = 0; i < operations.size(); ++i)
+			operations[i] = (static_cast<std::uint32_t>(hotEntities[random() % hot]) * Flags + random() % Flags) * 3 + random() % 3;
+
+		// Immediate callbacks
+		std::vector<entity_set> immediate;
+		state_type immediateState(Flags, std::vector<record>(entities));
+		std::function<void(Entity::Type, std::int32_t, bool)> callbacks[Flags];
+
+		for (std::int32_t flag = 0; flag < Flags; ++flag)
+		{
+			record* state = immediateState[flag].data();
+
+			callbacks[flag] = [state] (Entity::Type, std::int32_t entity, bool value)
+			{
+				apply(state, entity, value);
+			};
+		}
+
+		report.add(benchmark, "immediate", Flags, harness::measure([&]()
+		{
+			immediate.assign(entities, entity_set());
+			reset_state(immediateState);
+
+			for (std::size_t i = 0; i < operations.size(); ++i)
+			{
+				const std::uint32_t target = operations[i] / 3;
+				const std::int32_t entity = static_cast<std::int32_t>(target / Flags);
+				const Entity::Type flag = static_cast<Entity::Type>(target % Flags);
+				entity_set& flags = immediate[entity];
+				const bool before = flags.is_set(flag);
+
+				switch (operations[i] % 3)
+				{
+					case 0: flags.set(flag); break;
+					case 1: flags.clear(flag); break;
+					default: flags.toggle(flag); break;
+				}
+
+				if (flags.is_set(flag) != before)
+					callbacks[flag](flag, entity, !before);
+			}
+		}, Frames));
+
+		// Batched dispatch
+		std::unique_ptr<observable_table> batched;
+		state_type batchedState(Flags, std::vector<record>(entities));
+		std::size_t batchedChanges = 0;
+
+		report.add(benchmark, "observable_flag_table", Flags, harness::measure([&]()
+		{
+			batched.reset(new observable_table(entities));
+			reset_state(batchedState);
+			batchedChanges = 0;
+
+			for (std::int32_t flag = 0; flag < Flags; ++flag)
+			{
+				record* state = batchedState[flag].data();
+
+				batched->subscribe(static_cast<Entity::Type>(flag), [state] (Entity::Type, const observable_table::change* changes, std::size_t count)
+				{
+					for (std::size_t i = 0; i < count; ++i)
+						apply(state, changes[i].entity, changes[i].value);
+				});
+			}
+
+			for (std::int32_t frame = 0; frame < Frames; ++frame)
+			{
+				for (std::int32_t i = 0; i < writes; ++i)
+				{
+					const std::uint32_t operation = operations[static_cast<std::size_t>(frame) * writes + i];
+					const std::uint32_t target = operation / 3;
+					const std::int32_t entity = static_cast<std::int32_t>(target / Flags);
+					const Entity::Type flag = static_cast<Entity::Type>(target % Flags);
+
+					switch (operation % 3)
+					{
+						case 0: batched->set(entity, flag); break;
+						case 1: batched->clear(entity, flag); break;
+						default: batched->toggle(entity, flag); break;
+					}
+				}
+
+				batchedChanges += batched->sync();
+			}
+		}, Frames));
+
+		std::fprintf(stderr, "%s: %.1f changes dispatched per frame\n", benchmark, static_cast<double>(batchedChanges) / Frames);
+
+		bool agree = same_state(immediateState, batchedState);
+
+		for (std::int32_t entity = 0; entity < entities; ++entity)
+			agree &= (immediate[entity] == (*batched)[entity]);
+
+		return agree;
+	}
+
+}
+
+/**
+ * Runs the observable flag benchmarks and writes the results as CSV to stdout.
+ *
+ * The benchmark names give the number of entities, the number of hot
+ * entities written to and the writes each frame. An optional argument
+ * restricts the run to benchmarks whose name contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	const struct
+	{
+		const char* name;
+		std::int32_t entities;
+		std::int32_t hot;
+		std::int32_t writes;
+	} runs[] =
+	{
+		{ "notify_10000_10000_10000", 10000, 10000, 10000 },
+		{ "notify_100000_100000_10000", 100000, 100000, 10000 },
+		{ "notify_100000_100000_100000", 100000, 100000, 100000 },
+		{ "notify_100000_10000_100000", 100000, 10000, 100000 },
+		{ "notify_100000_100000_1000000", 100000, 100000, 1000000 }
+	} ;
+
+	for (const auto& run : runs)
+	{
+		if (report.enabled(run.name) && !compare(report, run.name, run.entities, run.hot, run.writes))
+		{
+			std::fprintf(stderr, "%s: immediate callbacks and observable_flag_table disagree\n", run.name);
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,165 @@
+/**
+ * \file parallel_query_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <rtl/flags/parallel_query.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace Entity
+{
+	enum Type
+	{
+		Alive,
+		Visible,
+		Moving
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Alive:1;
+		std::uint32_t Visible:1;
+		std::uint32_t Moving:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Entities = 8 * 1024 * 1024;
+	const std::int32_t Bits = 64;
+
+	typedef rtl::flag_set<Entity::Type, Bits, Entity::Names> entity_set;
+
+	/**
+	 * Measures count and gather queries on an executor.
+	 *
+	 * \param report The report to write the results to.
+	 * \param name The name of the executor.
+	 * \param executor The executor to run the queries on.
+	 * \param entities The entities to query.
+	 * \param expected The count and gather results of the first executor. Filled in when zero.
+	 * \returns \b true \b if the results match the first executor; \b false \b otherwise.
+	 */
+	template <typename Executor>
+	bool compare(const harness::report& report, const char* name, Executor& executor, const std::vector<entity_set>& entities, std::size_t expected[2])
+	{
+		const entity_set mask(Entity::Alive, Entity::Moving);
+		std::vector<std::int32_t> indices;
+		std::size_t counted = expected[0];
+		std::size_t gathered = expected[1];
+
+		if (report.enabled("parallel_count"))
+		{
+			report.add("parallel_count", name, Bits, harness::measure([&]()
+			{
+				counted = rtl::parallel_count_set(executor, &entities[0], entities.size(), Entity::Moving);
+
+				harness::do_not_optimize(counted);
+			}, Entities));
+		}
+
+		if (report.enabled("parallel_gather"))
+		{
+			report.add("parallel_gather", name, Bits, harness::measure([&]()
+			{
+				indices.clear();
+				rtl::parallel_gather_matching(executor, &entities[0], entities.size(), mask, indices);
+				gathered = indices.size();
+
+				harness::do_not_optimize(gathered);
+			}, Entities));
+		}
+
+		if ((expected[0] == 0) && (expected[1] == 0))
+		{
+			expected[0] = counted;
+			expected[1] = gathered;
+		}
+
+		return (counted == expected[0]) && (gathered == expected[1]);
+	}
+
+}
+
+/**
+ * Runs the parallel query benchmarks and writes the results as CSV to stdout.
+ *
+ * Each query runs inline and then on thread pools of doubling size up
+ * to the hardware concurrency. An optional argument restricts the run
+ * to benchmarks whose name contains it, for example "gather".
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	std::vector<entity_set> entities(Entities);
+	std::mt19937 random(1);
+
+	for (entity_set& flags : entities)
+	{
+		for (std::int32_t flag = 0; flag < 3; ++flag)
+		{
+			if (random() & 1)
+				flags.set(static_cast<Entity::Type>(flag));
+		}
+	}
+
+	std::size_t expected[2] = { 0, 0 };
+
+	rtl::inline_executor sequential;
+
+	compare(report, "inline_executor", sequential, entities, expected);
+
+	const std::int32_t hardware = static_cast<std::int32_t>(std::thread::hardware_concurrency());
+
+	for (std::int32_t threads = 1; threads <= hardware; threads *= 2)
+	{
+		rtl::flag_thread_pool pool(threads);
+		char name[32];
+
+		std::snprintf(name, sizeof(name), "flag_thread_pool_%d", threads);
+
+		if (!compare(report, name, pool, entities, expected))
+		{
+			std::fprintf(stderr, "parallel: %s disagrees with inline_executor\n", name);
+			return 1;
+		}
+	}
+}
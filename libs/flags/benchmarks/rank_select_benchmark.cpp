@@ -0,0 +1,230 @@
+/**
+ * \file rank_select_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Component
+{
+	enum Type
+	{
+		Transform
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Transform:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Queries = 1 << 20;
+
+	/**
+	 * Compares a loop over the flags below a component to flag_set::rank.
+	 *
+	 * \param report The report to write the results to.
+	 * \returns \b true \b if both approaches counted the same flags; \b false \b otherwise.
+	 */
+	template <std::int32_t Size>
+	bool compare_flag_set(const harness::report& report)
+	{
+		typedef rtl::flag_set<Component::Type, Size, Component::Names> signature;
+
+		std::mt19937 random(Size);
+		std::vector<signature> signatures(256);
+		std::vector<Component::Type> components(Queries);
+
+		for (signature& flags : signatures)
+		{
+			for (std::int32_t i = 0; i < Size; ++i)
+			{
+				if (random() & 1)
+					flags.set(static_cast<Component::Type>(i));
+			}
+		}
+
+		for (Component::Type& component : components)
+			component = static_cast<Component::Type>(random() % Size);
+
+		std::size_t loopTotal = 0;
+		std::size_t rankTotal = 0;
+
+		report.add("flag_set_rank", "loop", Size, harness::measure([&]()
+		{
+			loopTotal = 0;
+
+			for (std::int32_t i = 0; i < Queries; ++i)
+			{
+				const signature& flags = signatures[i & 255];
+
+				for (std::int32_t bit = 0; bit < components[i]; ++bit)
+					loopTotal += flags.is_set(static_cast<Component::Type>(bit)) ? 1 : 0;
+			}
+
+			harness::do_not_optimize(loopTotal);
+		}, Queries));
+
+		report.add("flag_set_rank", "flag_set", Size, harness::measure([&]()
+		{
+			rankTotal = 0;
+
+			for (std::int32_t i = 0; i < Queries; ++i)
+				rankTotal += signatures[i & 255].rank(components[i]);
+
+			harness::do_not_optimize(rankTotal);
+		}, Queries));
+
+		return (loopTotal == rankTotal);
+	}
+
+	/**
+	 * Compares scanning a dynamic_bit_set to a rank_select_index.
+	 *
+	 * \param report The report to write the results to.
+	 * \param bits The number of bits in the set.
+	 * \returns \b true \b if both approaches gave the same answers; \b false \b otherwise.
+	 */
+	bool compare_index(const harness::report& report, std::int32_t bits)
+	{
+		std::mt19937 random(bits);
+		rtl::dynamic_bit_set set;
+		std::vector<std::int32_t> locations(Queries / 16);
+
+		set.resize(bits);
+
+		for (std::int32_t i = 0; i < bits; ++i)
+		{
+			if ((random() & 3) == 0)
+				set.set(i);
+		}
+
+		for (std::int32_t& location : locations)
+			location = static_cast<std::int32_t>(random() % bits);
+
+		const rtl::rank_select_index index(set);
+		const std::int32_t count = set.count();
+		const std::int32_t lookups = static_cast<std::int32_t>(locations.size());
+
+		std::size_t scanRank = 0;
+		std::size_t indexRank = 0;
+		std::size_t scanSelect = 0;
+		std::size_t indexSelect = 0;
+
+		if (report.enabled("rank"))
+		{
+			report.add("rank", "dynamic_bit_set", bits, harness::measure([&]()
+			{
+				scanRank = 0;
+
+				for (std::int32_t i = 0; i < lookups; ++i)
+					scanRank += set.rank(locations[i]);
+
+				harness::do_not_optimize(scanRank);
+			}, lookups));
+
+			report.add("rank", "rank_select_index", bits, harness::measure([&]()
+			{
+				indexRank = 0;
+
+				for (std::int32_t i = 0; i < lookups; ++i)
+					indexRank += index.rank(locations[i]);
+
+				harness::do_not_optimize(indexRank);
+			}, lookups));
+		}
+
+		if (report.enabled("select"))
+		{
+			report.add("select", "dynamic_bit_set", bits, harness::measure([&]()
+			{
+				scanSelect = 0;
+
+				for (std::int32_t i = 0; i < lookups; ++i)
+					scanSelect += set.select(locations[i] % count);
+
+				harness::do_not_optimize(scanSelect);
+			}, lookups));
+
+			report.add("select", "rank_select_index", bits, harness::measure([&]()
+			{
+				indexSelect = 0;
+
+				for (std::int32_t i = 0; i < lookups; ++i)
+					indexSelect += index.select(locations[i] % count);
+
+				harness::do_not_optimize(indexSelect);
+			}, lookups));
+		}
+
+		return (scanRank == indexRank) && (scanSelect == indexSelect);
+	}
+
+}
+
+/**
+ * Runs the rank and select benchmarks and writes the results as CSV to stdout.
+ *
+ * An optional argument restricts the run to benchmarks whose name
+ * contains it, for example "select".
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	if (report.enabled("flag_set_rank"))
+	{
+		if (!(compare_flag_set<16>(report) && compare_flag_set<64>(report) && compare_flag_set<256>(report)))
+		{
+			std::fprintf(stderr, "flag_set_rank: loop and flag_set::rank disagree\n");
+			return 1;
+		}
+	}
+
+	if (report.enabled("rank") || report.enabled("select"))
+	{
+		if (!(compare_index(report, 1 << 12) && compare_index(report, 1 << 16) && compare_index(report, 1 << 20)))
+		{
+			std::fprintf(stderr, "rank_select_index: scan and index disagree\n");
+			return 1;
+		}
+	}
+}
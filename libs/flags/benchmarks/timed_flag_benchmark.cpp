@@ -0,0 +1,185 @@
+/**
+ * \file timed_flag_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <rtl/flags/timed_flag_manager.hpp>
+#include "benchmark_harness.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace Status
+{
+	enum Type
+	{
+		Stunned,
+		Burning,
+		Frozen,
+		Poisoned
+	} ;
+
+	struct Names
+	{
+		std::uint32_t Stunned:1;
+		std::uint32_t Burning:1;
+		std::uint32_t Frozen:1;
+		std::uint32_t Poisoned:1;
+	} ;
+} ;
+
+namespace
+{
+	const std::int32_t Flags = 4;
+	const std::int32_t Frames = 1000;
+	const std::int32_t Bits = 8;
+
+	typedef rtl::flag_set<Status::Type, Bits, Status::Names> status_set;
+
+	/**
+	 * Compares polling expiry ticks each frame to the timer wheel.
+	 *
+	 * Each frame a number of status effects lasting 30 to 300 frames are
+	 * applied to random entities. Both approaches start from cleared
+	 * entities on every run. The results are nanoseconds per frame.
+	 *
+	 * \param report The report to write the results to.
+	 * \param benchmark The name of the benchmark.
+	 * \param entities The number of entities.
+	 * \param applied The number of effects applied each frame.
+	 * \returns \b true \b if both approaches end with the same flags; \b false \b otherwise.
+	 */
+	bool compare(const harness::report& report, const char* benchmark, std::int32_t entities, std::int32_t applied)
+	{
+		std::mt19937 random(entities);
+		std::vector<std::int32_t> targets(static_cast<std::size_t>(Frames) * applied);
+		std::vector<std::uint64_t> durations(targets.size());
+
+		for (std::size_t i = 0; i < targets.size(); ++i)
+		{
+			targets[i] = static_cast<std::int32_t>(random() % (entities * Flags));
+			durations[i] = 30 + random() % 270;
+		}
+
+		// Polling
+		std::vector<status_set> polled;
+		std::vector<std::uint64_t> expiries;
+
+		report.add(benchmark, "poll", Bits, harness::measure([&]()
+		{
+			polled.assign(entities, status_set());
+			expiries.assign(static_cast<std::size_t>(entities) * Flags, 0);
+
+			for (std::uint64_t frame = 1; frame <= Frames; ++frame)
+			{
+				for (std::int32_t i = 0; i < applied; ++i)
+				{
+					const std::int32_t target = targets[(frame - 1) * applied + i];
+
+					polled[target / Flags].set(static_cast<Status::Type>(target % Flags));
+					expiries[target] = frame + durations[(frame - 1) * applied + i];
+				}
+
+				for (std::int32_t entity = 0; entity < entities; ++entity)
+				{
+					for (std::int32_t flag = 0; flag < Flags; ++flag)
+					{
+						if (polled[entity].is_set(static_cast<Status::Type>(flag)) && (expiries[entity * Flags + flag] <= frame + 1))
+							polled[entity].clear(static_cast<Status::Type>(flag));
+					}
+				}
+			}
+		}, Frames));
+
+		// Timer wheel
+		std::vector<status_set> timed;
+
+		report.add(benchmark, "timed_flag_manager", Bits, harness::measure([&]()
+		{
+			rtl::timed_flag_manager<Status::Type> timers;
+
+			timed.assign(entities, status_set());
+
+			for (std::uint64_t frame = 1; frame <= Frames; ++frame)
+			{
+				for (std::int32_t i = 0; i < applied; ++i)
+				{
+					const std::int32_t target = targets[(frame - 1) * applied + i];
+
+					timers.set(&timed[0], target / Flags, static_cast<Status::Type>(target % Flags), durations[(frame - 1) * applied + i]);
+				}
+
+				timers.advance(&timed[0]);
+			}
+		}, Frames));
+
+		return (polled == timed);
+	}
+
+}
+
+/**
+ * Runs the timed flag benchmarks and writes the results as CSV to stdout.
+ *
+ * The benchmark names give the number of entities, with one effect
+ * applied each frame per thousand entities. An optional argument
+ * restricts the run to benchmarks whose name contains it.
+ */
+int main(int argc, char** argv)
+{
+	const harness::report report((argc > 1) ? argv[1] : nullptr);
+
+	const struct
+	{
+		const char* name;
+		std::int32_t entities;
+		std::int32_t applied;
+	} runs[] =
+	{
+		{ "expire_10000", 10000, 10 },
+		{ "expire_100000", 100000, 100 },
+		{ "expire_1000000", 1000000, 1000 }
+	} ;
+
+	for (const auto& run : runs)
+	{
+		if (report.enabled(run.name) && !compare(report, run.name, run.entities, run.applied))
+		{
+			std::fprintf(stderr, "%s: polling and timed_flag_manager disagree\n", run.name);
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * \file compressed_bitmap_example.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/flags.hpp>
+#include <iostream>
+#include <vector>
+
+int main()
+{
+	rtl::compressed_bitmap bitmap;
+
+	// Sparse values land in array containers, dense ranges in bitmaps
+	for (std::uint32_t i = 0; i < 100; ++i)
+		bitmap.add(i * 1000);
+
+	for (std::uint32_t i = 0; i < 10000; ++i)
+		bitmap.add(200000 + i);
+
+	bitmap.optimize();
+
+	// Round trip through the serialized form
+	std::vector<std::uint8_t> buffer(bitmap.serialized_size());
+	bitmap.serialize(buffer.data(), buffer.size());
+
+	rtl::compressed_bitmap loaded;
+	const bool valid = loaded.deserialize(buffer.data(), buffer.size());
+
+	std::cout << "round trip " << ((valid && (loaded == bitmap)) ? "matches" : "differs") << std::endl;
+
+	// Truncated input is rejected
+	const bool truncated = loaded.deserialize(buffer.data(), buffer.size() - 1);
+
+	std::cout << "truncated input " << (truncated ? "accepted" : "rejected") << std::endl;
+
+	// Trailing bytes are rejected
+	std::vector<std::uint8_t> padded(buffer);
+	padded.push_back(0);
+
+	const bool trailing = loaded.deserialize(padded.data(), padded.size());
+
+	std::cout << "trailing bytes " << (trailing ? "accepted" : "rejected") << std::endl;
+
+	// A header claiming more containers than the input can hold is rejected without allocating them
+	const std::uint8_t oversized[] = { 'R', 'T', 'L', 'B', 1, 0, 0, 0, 0xff, 0xff, 0xff, 0x7f };
+	const bool inflated = loaded.deserialize(oversized, sizeof(oversized));
+
+	std::cout << "oversized container count " << (inflated ? "accepted" : "rejected") << std::endl;
+}
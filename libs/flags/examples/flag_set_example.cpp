@@ -1,4 +1,5 @@
 #include <rtl/flags.hpp>
+#include <iostream>
 
 namespace Test
 {
@@ -18,6 +19,17 @@ namespace Test
 	} ;
 } ;
 
+namespace
+{
+	typedef rtl::flag_set<Test::Type, Test::Size, Test::Names> test_set;
+
+	// Built at compile time
+	constexpr test_set mask = { Test::Test1, Test::Test3 };
+
+	constexpr const char* test_names[] = { "Test1", "Test2", "Test3" };
+	constexpr rtl::flag_name_table<Test::Size> test_table(test_names);
+}
+
 int main()
 {
 	std::uint8_t testing = 2;
@@ -27,4 +39,17 @@ int main()
 	flags.set(Test::Test3);
 
 	std::uint8_t value = flags;
+
+	bool matches = (flags & mask) == mask;
+
+	std::cout << "flags " << (matches ? "match" : "do not match") << " the mask" << std::endl;
+
+	// Round trip through text
+	char text[64];
+	rtl::to_string(flags, test_table, text, sizeof(text));
+
+	test_set parsed;
+	bool valid = rtl::parse(text, test_table, parsed);
+
+	std::cout << text << " " << ((valid && (parsed == flags)) ? "round trips" : "does not round trip") << std::endl;
 }
@@ -1 +0,0 @@
-premake4 vs2010
\ No newline at end of file
@@ -13,6 +13,10 @@ solution "rtl.flags"
 		defines { "NDEBUG" }
 		flags { "Optimize" }
 
+	-- Every action but Visual Studio takes the language level from the compiler flags
+	configuration "not vs*"
+		buildoptions { "-std=c++14" }
+
 	-- Example showing usage of the flag_set
 	project "flag_set_example"
 		kind "ConsoleApp"
@@ -24,3 +28,237 @@ solution "rtl.flags"
 			"../../rtl/flags/detail/*.hpp",
 			"examples/flag_set_example.cpp"
 		}
+
+	-- Example showing a serialization round trip of the compressed_bitmap
+	project "compressed_bitmap_example"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"examples/compressed_bitmap_example.cpp"
+		}
+
+	-- Benchmark comparing the word based bit_set to the old byte based storage
+	project "bit_set_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/bit_set_benchmark.cpp"
+		}
+
+	-- Benchmark comparing atomic_flag_set to a mutex guarded flag_set
+	project "atomic_flag_set_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/atomic_flag_set_benchmark.cpp"
+		}
+
+		configuration "gmake"
+			links { "pthread" }
+
+	-- Benchmark comparing flag_column queries to an array of flag_set
+	project "flag_column_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/flag_column_benchmark.cpp"
+		}
+
+	-- Benchmark comparing batched flag deltas to sending the full state
+	project "flag_delta_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/flag_delta_benchmark.cpp"
+		}
+
+	-- Benchmark comparing a mapped flag table to reading element by element
+	project "flag_table_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/flag_table_benchmark.cpp"
+		}
+
+	-- Benchmark comparing hierarchical_bit_set searches to a linear scan
+	project "hierarchical_bit_set_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/hierarchical_bit_set_benchmark.cpp"
+		}
+
+	-- Benchmarks comparing flag_set to raw integers, std::bitset and
+	-- std::vector<bool>. Writes CSV to stdout for tracking regressions.
+	project "flags_benchmarks"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flags_benchmarks.cpp"
+		}
+
+	-- Benchmark comparing flag_name_table parsing to string compares
+	project "flag_names_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flag_names_benchmark.cpp"
+		}
+
+	-- Benchmark comparing batched flag operations to per element loops
+	project "flag_batch_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flag_batch_benchmark.cpp"
+		}
+
+	-- Benchmark comparing folded flag predicates to chains of is_set calls
+	project "flag_query_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flag_query_benchmark.cpp"
+		}
+
+	-- Benchmark comparing rank and select to scanning loops
+	project "rank_select_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/rank_select_benchmark.cpp"
+		}
+
+	-- Benchmark measuring the scaling of parallel flag queries
+	project "parallel_query_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/parallel_query_benchmark.cpp"
+		}
+
+		configuration "gmake"
+			links { "pthread" }
+
+	-- Benchmark comparing the snapshot ring to copying the whole table each tick
+	project "flag_snapshot_ring_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flag_snapshot_ring_benchmark.cpp"
+		}
+
+	-- Benchmark comparing blocked Bloom filter lookups to std::unordered_set
+	project "bloom_filter_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/bloom_filter_benchmark.cpp"
+		}
+
+	-- Benchmark comparing signature index queries to scanning every entity
+	project "flag_signature_index_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/flag_signature_index_benchmark.cpp"
+		}
+
+	-- Benchmark comparing the timer wheel to polling expiry ticks each frame
+	project "timed_flag_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/timed_flag_benchmark.cpp"
+		}
+
+	-- Benchmark comparing batched change notification to immediate callbacks
+	project "observable_flag_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"../../rtl/flags.hpp",
+			"../../rtl/flags/*.hpp",
+			"../../rtl/flags/detail/*.hpp",
+			"benchmarks/benchmark_harness.hpp",
+			"benchmarks/observable_flag_benchmark.cpp"
+		}
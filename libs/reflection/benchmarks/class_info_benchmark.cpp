@@ -0,0 +1,152 @@
+/**
+ * \file class_info_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/reflection/class_info.hpp>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+using namespace rtl;
+
+namespace
+{
+	const std::int32_t Chains = 8;
+	const std::int32_t Queries = 1 << 20;
+	const std::int32_t Repeats = 20;
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	/**
+	 * Determines if a class derives from another by walking the chain of
+	 * base classes, as is_derived did before the classes were numbered.
+	 */
+	bool walk_hierarchy(const class_info* search, const class_info& type)
+	{
+		while (search)
+		{
+			if (search == &type)
+				return true;
+
+			search = search->base();
+		}
+
+		return false;
+	}
+
+	double nanoseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(Queries) * Repeats);
+	}
+
+	/**
+	 * Compares walking the chain of base classes to the numbered hierarchy.
+	 *
+	 * The hierarchy is a root with a number of chains of classes below
+	 * it. Each query tests a random class against a random class of the
+	 * same chain, or the root, so most queries succeed and the walk
+	 * covers part of the depth.
+	 *
+	 * \param depth The number of classes in each chain.
+	 */
+	void compare(std::int32_t depth)
+	{
+		std::vector<std::unique_ptr<class_info> > classes;
+		classes.emplace_back(new class_info("Root", 0));
+
+		for (std::int32_t chain = 0; chain < Chains; ++chain)
+		{
+			const class_info* base = classes[0].get();
+
+			for (std::int32_t level = 0; level < depth; ++level)
+			{
+				classes.emplace_back(new class_info("Derived", base));
+				base = classes.back().get();
+			}
+		}
+
+		class_info::finalize();
+
+		std::mt19937 random(depth);
+		std::vector<const class_info*> objects(Queries);
+		std::vector<const class_info*> types(Queries);
+
+		for (std::int32_t i = 0; i < Queries; ++i)
+		{
+			const std::int32_t chain = static_cast<std::int32_t>(random() % Chains);
+
+			objects[i] = classes[1 + chain * depth + random() % depth].get();
+			types[i] = classes[(random() % (depth + 1) == 0) ? 0 : 1 + chain * depth + random() % depth].get();
+		}
+
+		// Chain walk
+		std::int32_t walked = 0;
+		clock_type::time_point start = clock_type::now();
+
+		for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+		{
+			for (std::int32_t i = 0; i < Queries; ++i)
+				walked += walk_hierarchy(objects[i], *types[i]) ? 1 : 0;
+		}
+
+		const double walkTime = nanoseconds(start, clock_type::now());
+
+		// Numbered hierarchy
+		std::int32_t numbered = 0;
+		start = clock_type::now();
+
+		for (std::int32_t repeat = 0; repeat < Repeats; ++repeat)
+		{
+			for (std::int32_t i = 0; i < Queries; ++i)
+				numbered += objects[i]->is_derived(*types[i]) ? 1 : 0;
+		}
+
+		const double numberedTime = nanoseconds(start, clock_type::now());
+
+		std::printf("%6d %10.2f %12.2f %9.2fx %s\n", depth, walkTime, numberedTime, walkTime / numberedTime, (walked == numbered) ? "" : "DISAGREE");
+	}
+
+}
+
+int main()
+{
+	std::printf("%d chains, ns per query\n", Chains);
+	std::printf("%6s %10s %12s %10s\n", "depth", "walk ns", "interval ns", "speedup");
+
+	for (std::int32_t depth = 1; depth <= 16; depth *= 2)
+		compare(depth);
+}
@@ -0,0 +1,156 @@
+/**
+ * \file class_registry_benchmark.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/reflection.hpp>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+using namespace rtl;
+
+namespace
+{
+	const std::int32_t Queries = 1 << 20;
+
+	typedef std::chrono::high_resolution_clock clock_type;
+
+	double nanoseconds(clock_type::time_point start, clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::nano>(end - start).count() / Queries;
+	}
+
+	/**
+	 * Compares looking up classes in a std::map to the registry.
+	 *
+	 * The names are looked up as the null terminated strings a
+	 * deserializer reads from a file.
+	 *
+	 * \param count The number of classes.
+	 */
+	void compare(std::int32_t count)
+	{
+		std::vector<std::string> names(count);
+		std::vector<std::unique_ptr<class_info> > classes;
+		std::map<std::string, const class_info*> byName;
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			names[i] = "Gameplay::Entity" + std::to_string(i);
+			classes.emplace_back(new class_info(names[i].c_str(), 0));
+			byName[names[i]] = classes.back().get();
+		}
+
+		class_registry::build();
+
+		std::mt19937 random(count);
+		std::vector<const char*> queries(Queries);
+		std::vector<std::uint64_t> ids(Queries);
+
+		for (std::int32_t i = 0; i < Queries; ++i)
+		{
+			const std::int32_t index = static_cast<std::int32_t>(random() % count);
+
+			queries[i] = names[index].c_str();
+			ids[i] = classes[index]->id();
+		}
+
+		// std::map
+		std::size_t mapFound = 0;
+		clock_type::time_point start = clock_type::now();
+
+		for (std::int32_t i = 0; i < Queries; ++i)
+		{
+			std::map<std::string, const class_info*>::const_iterator found = byName.find(queries[i]);
+
+			if (found != byName.end())
+				mapFound += reinterpret_cast<std::size_t>(found->second) & 1 ? 2 : 1;
+		}
+
+		const double mapTime = nanoseconds(start, clock_type::now());
+
+		// Registry by name
+		std::size_t nameFound = 0;
+		start = clock_type::now();
+
+		for (std::int32_t i = 0; i < Queries; ++i)
+		{
+			const class_info* found = class_registry::find(queries[i]);
+
+			if (found)
+				nameFound += reinterpret_cast<std::size_t>(found) & 1 ? 2 : 1;
+		}
+
+		const double nameTime = nanoseconds(start, clock_type::now());
+
+		// Registry by identifier
+		std::size_t idFound = 0;
+		start = clock_type::now();
+
+		for (std::int32_t i = 0; i < Queries; ++i)
+		{
+			const class_info* found = class_registry::find(ids[i]);
+
+			if (found)
+				idFound += reinterpret_cast<std::size_t>(found) & 1 ? 2 : 1;
+		}
+
+		const double idTime = nanoseconds(start, clock_type::now());
+
+		const bool agree = (mapFound == nameFound) && (mapFound == idFound);
+
+		// Destroy the classes newest first as static destruction would
+		while (!classes.empty())
+			classes.pop_back();
+
+		std::printf("%8d %9.2f %9.2f %9.2f %9.2fx %9.2fx %s\n", count, mapTime, nameTime, idTime, mapTime / nameTime, mapTime / idTime, agree ? "" : "DISAGREE");
+	}
+
+}
+
+int main()
+{
+	std::printf("ns per lookup\n");
+	std::printf("%8s %9s %9s %9s %10s %10s\n", "classes", "map", "name", "id", "name gain", "id gain");
+
+	compare(100);
+	compare(1000);
+	compare(10000);
+	compare(100000);
+}
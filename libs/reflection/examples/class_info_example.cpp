@@ -65,6 +65,8 @@ namespace
 
 int main()
 {
+	class_info::finalize();
+
 	is_exactly(A, A);
 	is_exactly(B, A);
 	is_exactly(C, A);
@@ -13,6 +13,9 @@ solution "rtl.reflection"
 		defines { "NDEBUG" }
 		flags { "Optimize" }
 
+	-- Every action but Visual Studio takes the language level from the compiler flags
+	configuration "not vs*"
+		buildoptions { "-std=c++14" }
 
 	-- Implementation of the library
 	project "rtl.reflection"
@@ -37,3 +40,29 @@ solution "rtl.reflection"
 		{
 			"rtl.reflection"
 		}
+
+	-- Benchmark comparing is_derived to walking the chain of base classes
+	project "class_info_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"benchmarks/class_info_benchmark.cpp"
+		}
+		links
+		{
+			"rtl.reflection"
+		}
+
+	-- Benchmark comparing registry lookups to a std::map keyed on names
+	project "class_registry_benchmark"
+		kind "ConsoleApp"
+		language "C++"
+		files
+		{
+			"benchmarks/class_registry_benchmark.cpp"
+		}
+		links
+		{
+			"rtl.reflection"
+		}
@@ -36,18 +36,101 @@
  */
 
 #include <rtl/reflection/class_info.hpp>
+#include <rtl/reflection/class_registry.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 using namespace rtl;
 
+class_info* class_info::_head = 0;
+
 //---------------------------------------------------------------------
 
 class_info::class_info(const char* name, const class_info* base)
 : _name(name)
 , _base(base)
-{ }
+, _id(make_id(name))
+, _preorder(0)
+, _descendants(0)
+, _ordered(false)
+, _next(_head)
+{
+	_head = this;
+}
+
+//---------------------------------------------------------------------
+
+class_info::~class_info()
+{
+	class_info** link = &_head;
+
+	while (*link != this)
+		link = &(*link)->_next;
+
+	*link = _next;
+
+	class_registry::remove(*this);
+}
+
+//---------------------------------------------------------------------
+
+void class_info::finalize()
+{
+	// Gather the classes derived directly from each class
+	std::unordered_map<const class_info*, std::vector<class_info*> > children;
+	std::vector<class_info*> classes;
+	std::vector<class_info*> roots;
+
+	for (class_info* search = _head; search; search = search->_next)
+	{
+		children[search];
+		classes.push_back(search);
+	}
+
+	// The list is newest first so walk it in reverse to keep the order of creation
+	for (std::size_t i = classes.size(); i-- > 0;)
+	{
+		class_info* type = classes[i];
+
+		if (type->_base && (children.find(type->_base) != children.end()))
+			children[type->_base].push_back(type);
+		else
+			roots.push_back(type);
+	}
+
+	// Number the classes in preorder, counting descendants on the way out
+	std::vector<std::pair<class_info*, std::size_t> > stack;
+	std::int32_t preorder = 0;
+
+	for (std::size_t i = 0; i < roots.size(); ++i)
+	{
+		roots[i]->_preorder = preorder++;
+		stack.push_back(std::make_pair(roots[i], std::size_t(0)));
+
+		while (!stack.empty())
+		{
+			class_info* type = stack.back().first;
+			const std::vector<class_info*>& derived = children[type];
+			const std::size_t next = stack.back().second++;
+
+			if (next < derived.size())
+			{
+				derived[next]->_preorder = preorder++;
+				stack.push_back(std::make_pair(derived[next], std::size_t(0)));
+			}
+			else
+			{
+				type->_descendants = static_cast<std::uint32_t>(preorder - type->_preorder - 1);
+				type->_ordered = true;
+				stack.pop_back();
+			}
+		}
+	}
+}
 
 //---------------------------------------------------------------------
 
-bool class_info::is_derived(const class_info& type) const
+bool class_info::walk_hierarchy(const class_info& type) const
 {
 	const class_info* search = this;
 
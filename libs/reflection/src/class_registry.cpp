@@ -0,0 +1,219 @@
+/**
+ * \file class_registry.cpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <rtl/reflection/class_registry.hpp>
+#include <algorithm>
+#include <vector>
+using namespace rtl;
+
+namespace
+{
+	/// The slot looked up before the registry is built
+	const class_info* empty_slot = 0;
+	/// The seed looked up before the registry is built
+	std::uint64_t empty_seed = 0;
+
+	/// The number of seeds tried for a bucket before growing the table
+	const std::uint64_t max_seed = 1 << 16;
+
+	/**
+	 * Rounds a value up to a power of two.
+	 */
+	std::size_t next_power_of_two(std::size_t value)
+	{
+		std::size_t power = 1;
+
+		while (power < value)
+			power <<= 1;
+
+		return power;
+	}
+}
+
+const class_info** class_registry::_classes = 0;
+std::size_t class_registry::_count = 0;
+std::uint64_t* class_registry::_seeds = &empty_seed;
+const class_info** class_registry::_slots = &empty_slot;
+std::uint64_t class_registry::_bucketMask = 0;
+std::uint64_t class_registry::_slotMask = 0;
+
+//---------------------------------------------------------------------
+
+bool class_registry::build()
+{
+	class_info::finalize();
+
+	// The list is newest first so walk it in reverse to keep the order of creation
+	std::vector<const class_info*> classes;
+
+	for (const class_info* search = class_info::_head; search; search = search->_next)
+		classes.push_back(search);
+
+	std::reverse(classes.begin(), classes.end());
+
+	const std::size_t count = classes.size();
+
+	// Classes sharing an identifier can never be separated
+	std::vector<std::uint64_t> ids(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+		ids[i] = classes[i]->_id;
+
+	std::sort(ids.begin(), ids.end());
+
+	if (std::adjacent_find(ids.begin(), ids.end()) != ids.end())
+		return false;
+
+	// Aim for two classes per bucket and a table at most half full
+	const std::size_t bucketCount = next_power_of_two(std::max<std::size_t>(count / 2, 1));
+	std::size_t slotCount = next_power_of_two(std::max<std::size_t>(count * 2, 1));
+
+	std::vector<std::vector<std::uint32_t> > buckets(bucketCount);
+
+	for (std::size_t i = 0; i < count; ++i)
+		buckets[mix(classes[i]->_id) & (bucketCount - 1)].push_back(static_cast<std::uint32_t>(i));
+
+	// Place the largest buckets first while the table is emptiest
+	std::vector<std::uint32_t> order(bucketCount);
+
+	for (std::size_t i = 0; i < bucketCount; ++i)
+		order[i] = static_cast<std::uint32_t>(i);
+
+	std::stable_sort(order.begin(), order.end(), [&buckets] (std::uint32_t lhs, std::uint32_t rhs)
+	{
+		return buckets[lhs].size() > buckets[rhs].size();
+	});
+
+	std::vector<std::uint64_t> seeds;
+	std::vector<const class_info*> slots;
+	std::vector<std::size_t> placed;
+	bool complete = false;
+
+	while (!complete)
+	{
+		seeds.assign(bucketCount, 0);
+		slots.assign(slotCount, 0);
+		complete = true;
+
+		for (std::size_t i = 0; (i < bucketCount) && complete; ++i)
+		{
+			const std::vector<std::uint32_t>& bucket = buckets[order[i]];
+
+			if (bucket.empty())
+				break;
+
+			std::uint64_t seed = 0;
+
+			for (; seed < max_seed; ++seed)
+			{
+				placed.clear();
+
+				for (std::size_t j = 0; j < bucket.size(); ++j)
+				{
+					const std::size_t slot = mix(mix(classes[bucket[j]]->_id) + seed) & (slotCount - 1);
+
+					if ((slots[slot] != 0) || (std::find(placed.begin(), placed.end(), slot) != placed.end()))
+						break;
+
+					placed.push_back(slot);
+				}
+
+				if (placed.size() == bucket.size())
+					break;
+			}
+
+			if (seed == max_seed)
+			{
+				// Try again with a larger table
+				slotCount <<= 1;
+				complete = false;
+			}
+			else
+			{
+				seeds[order[i]] = seed;
+
+				for (std::size_t j = 0; j < bucket.size(); ++j)
+					slots[placed[j]] = classes[bucket[j]];
+			}
+		}
+	}
+
+	// Replace the tables
+	delete[] _classes;
+
+	if (_seeds != &empty_seed)
+		delete[] _seeds;
+
+	if (_slots != &empty_slot)
+		delete[] _slots;
+
+	_classes = new const class_info*[count];
+	_seeds = new std::uint64_t[bucketCount];
+	_slots = new const class_info*[slotCount];
+
+	std::copy(classes.begin(), classes.end(), _classes);
+	std::copy(seeds.begin(), seeds.end(), _seeds);
+	std::copy(slots.begin(), slots.end(), _slots);
+
+	_count = count;
+	_bucketMask = bucketCount - 1;
+	_slotMask = slotCount - 1;
+
+	return true;
+}
+
+//---------------------------------------------------------------------
+
+void class_registry::remove(const class_info& type)
+{
+	const std::uint64_t hash = mix(type._id);
+	const class_info** slot = &_slots[mix(hash + _seeds[hash & _bucketMask]) & _slotMask];
+
+	if (*slot != &type)
+		return;
+
+	*slot = 0;
+
+	// Classes are usually destroyed newest first so search from the end
+	std::size_t index = _count;
+
+	while (_classes[--index] != &type)
+		;
+
+	std::copy(_classes + index + 1, _classes + _count, _classes + index);
+	--_count;
+}
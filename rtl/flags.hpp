@@ -38,6 +38,30 @@
 #ifndef RECHARGEABLE_FLAGS_HPP_INCLUDED
 #define RECHARGEABLE_FLAGS_HPP_INCLUDED
 
+// Only the flag value types and containers are included here. Headers
+// that depend on the operating system, threads or hashed containers are
+// included explicitly:
+//
+//   rtl/flags/flag_table.hpp            Memory mapped flag tables
+//   rtl/flags/flag_thread_pool.hpp      Work stealing thread pool
+//   rtl/flags/parallel_query.hpp        Parallel flag queries
+//   rtl/flags/flag_signature_index.hpp  Superset and subset queries
+//   rtl/flags/timed_flag_manager.hpp    Flags that expire
+//   rtl/flags/observable_flag_table.hpp Batched change notification
+
 #include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/atomic_flag_set.hpp>
+#include <rtl/flags/flag_column.hpp>
+#include <rtl/flags/dynamic_bit_set.hpp>
+#include <rtl/flags/compressed_bitmap.hpp>
+#include <rtl/flags/flag_delta.hpp>
+#include <rtl/flags/hierarchical_bit_set.hpp>
+#include <rtl/flags/flag_names.hpp>
+#include <rtl/flags/flag_batch.hpp>
+#include <rtl/flags/flag_query.hpp>
+#include <rtl/flags/packed_fields.hpp>
+#include <rtl/flags/rank_select_index.hpp>
+#include <rtl/flags/flag_snapshot_ring.hpp>
+#include <rtl/flags/bloom_filter.hpp>
 
 #endif // end RECHARGEABLE_FLAGS_HPP_INCLUDED
@@ -0,0 +1,354 @@
+/**
+ * \file atomic_flag_set.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_ATOMIC_FLAG_SET_HPP_INCLUDED
+#define RECHARGEABLE_ATOMIC_FLAG_SET_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <atomic>
+
+namespace rtl
+{
+	/**
+	 * A flag_set that can be modified concurrently.
+	 *
+	 * The flags are held in an array of std::atomic words matching the
+	 * layout of the flag_set container.
+	 *
+	 * \section GUARANTEES
+	 *
+	 * Every word is an independent atomic object. Operations on a single
+	 * flag touch exactly one word and are atomic. Operations taking a
+	 * whole flag_set (fetch_or, fetch_and, fetch_xor, load, store) are
+	 * atomic for each word but not across words. When the flags fit in a
+	 * single word (64 flags or less) every operation is atomic; above that
+	 * another thread can observe some words of a mask operation applied
+	 * and others not yet applied.
+	 *
+	 * \tparam Enum The enumeration holding the flags.
+	 * \tparam Size The number of flags.
+	 * \tparam Names The debug names.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	class atomic_flag_set
+	{
+		public:
+
+			typedef flag_set<Enum, Size, Names> value_type;
+			typedef typename value_type::container_type container_type;
+			typedef typename container_type::word_type word_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = container_type::word_bits;
+			/// The number of atomic words
+			static const std::int32_t word_count = container_type::word_count;
+
+			/**
+			 * Creates an instance of the atomic_flag_set class.
+			 *
+			 * All flags are initially cleared.
+			 */
+			atomic_flag_set()
+			{
+				for (std::int32_t i = 0; i < word_count; ++i)
+					_words[i].store(0, std::memory_order_relaxed);
+			}
+
+			/**
+			 * Creates an instance of the atomic_flag_set class.
+			 *
+			 * \param value The initial flags.
+			 */
+			explicit atomic_flag_set(const value_type& value)
+			{
+				store(value, std::memory_order_relaxed);
+			}
+
+			atomic_flag_set(const atomic_flag_set&) = delete;
+			atomic_flag_set& operator= (const atomic_flag_set&) = delete;
+
+			//----------------------------------------------------------------------
+			// Single flag operations
+			//----------------------------------------------------------------------
+
+			void set(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				fetch_set(flag, order);
+			}
+
+			void clear(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				fetch_clear(flag, order);
+			}
+
+			void toggle(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				fetch_toggle(flag, order);
+			}
+
+			bool is_set(Enum flag, std::memory_order order = std::memory_order_seq_cst) const
+			{
+				return (_words[word_index(flag)].load(order) & bit_mask(flag)) != 0;
+			}
+
+			/**
+			 * Sets a flag.
+			 *
+			 * \param flag The flag to set.
+			 * \param order The memory ordering of the operation.
+			 * \returns The previous state of the flag.
+			 */
+			bool fetch_set(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type mask = bit_mask(flag);
+
+				return (_words[word_index(flag)].fetch_or(mask, order) & mask) != 0;
+			}
+
+			/**
+			 * Clears a flag.
+			 *
+			 * \param flag The flag to clear.
+			 * \param order The memory ordering of the operation.
+			 * \returns The previous state of the flag.
+			 */
+			bool fetch_clear(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type mask = bit_mask(flag);
+
+				return (_words[word_index(flag)].fetch_and(static_cast<word_type>(~mask), order) & mask) != 0;
+			}
+
+			/**
+			 * Toggles a flag.
+			 *
+			 * \param flag The flag to toggle.
+			 * \param order The memory ordering of the operation.
+			 * \returns The previous state of the flag.
+			 */
+			bool fetch_toggle(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type mask = bit_mask(flag);
+
+				return (_words[word_index(flag)].fetch_xor(mask, order) & mask) != 0;
+			}
+
+			/**
+			 * Sets a flag and reports whether it was already set.
+			 *
+			 * Only one of several threads racing to set the same flag sees
+			 * \b false \b returned.
+			 *
+			 * \param flag The flag to set.
+			 * \param order The memory ordering of the operation.
+			 * \returns The previous state of the flag.
+			 */
+			bool test_and_set(Enum flag, std::memory_order order = std::memory_order_seq_cst)
+			{
+				return fetch_set(flag, order);
+			}
+
+			//----------------------------------------------------------------------
+			// Mask operations
+			//
+			// Words of the mask that would leave the value unchanged are
+			// read rather than modified to avoid contending on them.
+			//----------------------------------------------------------------------
+
+			/**
+			 * Sets the flags within a mask.
+			 *
+			 * \param mask The flags to set.
+			 * \param order The memory ordering of each word operation.
+			 * \returns The flags prior to the operation.
+			 */
+			value_type fetch_or(const value_type& mask, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type* source = detail::word_data(mask.container());
+
+				value_type previous;
+				word_type* result = detail::word_data(previous.container());
+
+				for (std::int32_t i = 0; i < word_count; ++i)
+				{
+					if (source[i] != 0)
+						result[i] = _words[i].fetch_or(source[i], order);
+					else
+						result[i] = _words[i].load(load_order(order));
+				}
+
+				return previous;
+			}
+
+			/**
+			 * Keeps only the flags within a mask.
+			 *
+			 * \param mask The flags to keep.
+			 * \param order The memory ordering of each word operation.
+			 * \returns The flags prior to the operation.
+			 */
+			value_type fetch_and(const value_type& mask, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type* source = detail::word_data(mask.container());
+
+				value_type previous;
+				word_type* result = detail::word_data(previous.container());
+
+				for (std::int32_t i = 0; i < word_count; ++i)
+				{
+					if (source[i] != static_cast<word_type>(~word_type(0)))
+						result[i] = _words[i].fetch_and(source[i], order);
+					else
+						result[i] = _words[i].load(load_order(order));
+				}
+
+				return previous;
+			}
+
+			/**
+			 * Toggles the flags within a mask.
+			 *
+			 * \param mask The flags to toggle.
+			 * \param order The memory ordering of each word operation.
+			 * \returns The flags prior to the operation.
+			 */
+			value_type fetch_xor(const value_type& mask, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type* source = detail::word_data(mask.container());
+
+				value_type previous;
+				word_type* result = detail::word_data(previous.container());
+
+				for (std::int32_t i = 0; i < word_count; ++i)
+				{
+					if (source[i] != 0)
+						result[i] = _words[i].fetch_xor(source[i], order);
+					else
+						result[i] = _words[i].load(load_order(order));
+				}
+
+				return previous;
+			}
+
+			//----------------------------------------------------------------------
+			// Whole set operations
+			//----------------------------------------------------------------------
+
+			/**
+			 * Reads the flags.
+			 *
+			 * \param order The memory ordering of each word load.
+			 * \returns The current flags.
+			 */
+			value_type load(std::memory_order order = std::memory_order_seq_cst) const
+			{
+				value_type value;
+				word_type* result = detail::word_data(value.container());
+
+				for (std::int32_t i = 0; i < word_count; ++i)
+					result[i] = _words[i].load(order);
+
+				return value;
+			}
+
+			/**
+			 * Replaces the flags.
+			 *
+			 * \param value The flags to store.
+			 * \param order The memory ordering of each word store.
+			 */
+			void store(const value_type& value, std::memory_order order = std::memory_order_seq_cst)
+			{
+				const word_type* source = detail::word_data(value.container());
+
+				for (std::int32_t i = 0; i < word_count; ++i)
+					_words[i].store(source[i], order);
+			}
+
+			operator value_type() const
+			{
+				return load();
+			}
+
+			/**
+			 * Determines whether the operations are lock free.
+			 *
+			 * \returns \b true \b if the words are lock free; \b false \b otherwise.
+			 */
+			bool is_lock_free() const
+			{
+				return _words[0].is_lock_free();
+			}
+
+		private:
+
+			static std::int32_t word_index(Enum flag)
+			{
+				RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+				return static_cast<std::int32_t>(flag) / word_bits;
+			}
+
+			static word_type bit_mask(Enum flag)
+			{
+				return static_cast<word_type>(word_type(1) << (static_cast<std::int32_t>(flag) % word_bits));
+			}
+
+			/**
+			 * Converts the memory ordering of a read-modify-write into one valid for a load.
+			 */
+			static std::memory_order load_order(std::memory_order order)
+			{
+				if (order == std::memory_order_release)
+					return std::memory_order_relaxed;
+				if (order == std::memory_order_acq_rel)
+					return std::memory_order_acquire;
+
+				return order;
+			}
+
+			/// The words holding the flags
+			std::atomic<word_type> _words[word_count];
+
+	} ; // end class atomic_flag_set<Enum, Size, Names>
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_ATOMIC_FLAG_SET_HPP_INCLUDED
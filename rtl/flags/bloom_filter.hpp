@@ -0,0 +1,683 @@
+/**
+ * \file bloom_filter.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_BLOOM_FILTER_HPP_INCLUDED
+#define RECHARGEABLE_BLOOM_FILTER_HPP_INCLUDED
+
+#include <rtl/flags/detail/bit_set.hpp>
+#include <rtl/flags/detail/hash.hpp>
+#include <rtl/flags/detail/word_ops.hpp>
+#include <algorithm>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(RECHARGEABLE_USE_SSE2)
+#include <xmmintrin.h>
+#endif
+
+namespace rtl
+{
+	namespace detail
+	{
+		//----------------------------------------------------------------------
+		// Block layout
+		//
+		// A block is a cache line of eight 64-bit words. A key selects one
+		// block from the high half of its hash and then one bit, or one
+		// 4-bit counter, within each word of the block by multiplying the
+		// low half of its hash by a per word odd constant. Every lookup
+		// touches a single cache line and the eight words are independent
+		// so the work maps directly onto SIMD lanes.
+		//----------------------------------------------------------------------
+
+		/// The number of words within a block
+		const std::int32_t bloom_block_words = 8;
+
+		/// The constant multiplied with the hash for each word of a block
+		const std::uint32_t bloom_salts[bloom_block_words] =
+		{
+			0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+			0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+		};
+
+		/**
+		 * Selects the block of a hash.
+		 *
+		 * The block is chosen by a multiply and shift so the number of
+		 * blocks need not be a power of two.
+		 */
+		inline std::int32_t bloom_block(std::uint64_t hash, std::int32_t blockCount)
+		{
+			return static_cast<std::int32_t>(((hash >> 32) * static_cast<std::uint64_t>(blockCount)) >> 32);
+		}
+
+		/**
+		 * Requests a block be brought into the cache.
+		 */
+		inline void bloom_prefetch(const std::uint64_t* block)
+		{
+		#if defined(__GNUC__)
+			__builtin_prefetch(block);
+		#elif defined(_MSC_VER) && defined(RECHARGEABLE_USE_SSE2)
+			_mm_prefetch(reinterpret_cast<const char*>(block), _MM_HINT_T0);
+		#else
+			(void)block;
+		#endif
+		}
+
+	#if defined(RECHARGEABLE_USE_AVX2)
+		/**
+		 * Computes the bit of each word selected by a hash.
+		 */
+		inline void bloom_masks(std::uint32_t hash, __m256i& low, __m256i& high)
+		{
+			const __m256i salts = _mm256_setr_epi32(
+				0x47b6137b, 0x44974d91, static_cast<int>(0x8824ad5b), static_cast<int>(0xa2b7289d),
+				0x705495c7, 0x2df1424b, static_cast<int>(0x9efc4947), 0x5c6bfb31
+			);
+
+			const __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts), 26);
+			const __m256i one = _mm256_set1_epi64x(1);
+
+			low = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+			high = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+		}
+	#endif
+
+		/**
+		 * Sets the bits of a hash within a block.
+		 */
+		inline void bloom_insert(std::uint64_t* block, std::uint32_t hash)
+		{
+		#if defined(RECHARGEABLE_USE_AVX2)
+			__m256i low;
+			__m256i high;
+			bloom_masks(hash, low, high);
+
+			__m256i* words = reinterpret_cast<__m256i*>(block);
+			_mm256_storeu_si256(words, _mm256_or_si256(_mm256_loadu_si256(words), low));
+			_mm256_storeu_si256(words + 1, _mm256_or_si256(_mm256_loadu_si256(words + 1), high));
+		#else
+			for (std::int32_t i = 0; i < bloom_block_words; ++i)
+				block[i] |= std::uint64_t(1) << ((hash * bloom_salts[i]) >> 26);
+		#endif
+		}
+
+		/**
+		 * Determines whether the bits of a hash are set within a block.
+		 */
+		inline bool bloom_contains(const std::uint64_t* block, std::uint32_t hash)
+		{
+		#if defined(RECHARGEABLE_USE_AVX2)
+			__m256i low;
+			__m256i high;
+			bloom_masks(hash, low, high);
+
+			const __m256i* words = reinterpret_cast<const __m256i*>(block);
+
+			return (_mm256_testc_si256(_mm256_loadu_si256(words), low) & _mm256_testc_si256(_mm256_loadu_si256(words + 1), high)) != 0;
+		#else
+			std::uint64_t present = 1;
+
+			for (std::int32_t i = 0; i < bloom_block_words; ++i)
+				present &= block[i] >> ((hash * bloom_salts[i]) >> 26);
+
+			return present != 0;
+		#endif
+		}
+
+		/**
+		 * Computes the shift of the counter of a hash within each word.
+		 */
+		inline std::int32_t bloom_counter_shift(std::uint32_t hash, std::int32_t word)
+		{
+			return static_cast<std::int32_t>((hash * bloom_salts[word]) >> 28) * 4;
+		}
+
+		/**
+		 * Holds the blocks of a filter sized at compile time.
+		 */
+		template <std::int32_t Blocks>
+		class bloom_storage
+		{
+			public:
+
+				explicit bloom_storage(std::int32_t)
+				: _blocks()
+				{ }
+
+				std::uint64_t* data()
+				{
+					return word_data(_blocks[0]);
+				}
+
+				const std::uint64_t* data() const
+				{
+					return word_data(_blocks[0]);
+				}
+
+				std::int32_t block_count() const
+				{
+					return Blocks;
+				}
+
+			private:
+
+				static_assert(sizeof(bit_set<512>) == bloom_block_words * sizeof(std::uint64_t), "Blocks must be contiguous");
+
+				/// The blocks
+				alignas(64) bit_set<512> _blocks[Blocks];
+
+		} ; // end class bloom_storage<Blocks>
+
+		/**
+		 * Holds the blocks of a filter sized at runtime.
+		 *
+		 * The words are offset within their allocation so each block
+		 * starts on a cache line.
+		 */
+		template <>
+		class bloom_storage<0>
+		{
+			public:
+
+				explicit bloom_storage(std::int32_t blockCount)
+				: _words(static_cast<std::size_t>(blockCount) * bloom_block_words + 7, 0)
+				, _offset(0)
+				, _blockCount(blockCount)
+				{
+					align();
+				}
+
+				bloom_storage(const bloom_storage& other)
+				: _words(other._words.size(), 0)
+				, _offset(0)
+				, _blockCount(other._blockCount)
+				{
+					align();
+					std::copy_n(other.data(), static_cast<std::size_t>(_blockCount) * bloom_block_words, data());
+				}
+
+				bloom_storage(bloom_storage&&) = default;
+
+				bloom_storage& operator= (const bloom_storage& other)
+				{
+					bloom_storage copy(other);
+					*this = std::move(copy);
+					return *this;
+				}
+
+				bloom_storage& operator= (bloom_storage&&) = default;
+
+				std::uint64_t* data()
+				{
+					return _words.data() + _offset;
+				}
+
+				const std::uint64_t* data() const
+				{
+					return _words.data() + _offset;
+				}
+
+				std::int32_t block_count() const
+				{
+					return _blockCount;
+				}
+
+			private:
+
+				void align()
+				{
+					const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(_words.data());
+
+					_offset = static_cast<std::size_t>((64 - (address & 63)) & 63) / sizeof(std::uint64_t);
+				}
+
+				/// The words including the alignment padding
+				std::vector<std::uint64_t> _words;
+				/// The offset of the first block
+				std::size_t _offset;
+				/// The number of blocks
+				std::int32_t _blockCount;
+
+		} ; // end class bloom_storage<0>
+
+		/// The number of keys hashed ahead of a batch lookup
+		const std::size_t bloom_batch = 16;
+
+		/**
+		 * Runs a function over keys after prefetching their blocks.
+		 */
+		template <typename Storage, typename Function>
+		inline void bloom_for_each(Storage& storage, const std::uint64_t* keys, std::size_t count, Function function)
+		{
+			std::uint64_t hashes[bloom_batch];
+			decltype(storage.data()) blocks[bloom_batch];
+
+			for (std::size_t first = 0; first < count; first += bloom_batch)
+			{
+				const std::size_t size = std::min(bloom_batch, count - first);
+
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					hashes[i] = mix_hash(keys[first + i]);
+					blocks[i] = storage.data() + static_cast<std::size_t>(bloom_block(hashes[i], storage.block_count())) * bloom_block_words;
+					bloom_prefetch(blocks[i]);
+				}
+
+				for (std::size_t i = 0; i < size; ++i)
+					function(first + i, blocks[i], static_cast<std::uint32_t>(hashes[i]));
+			}
+		}
+
+	} // end namespace detail
+
+	/**
+	 * Computes the number of blocks for a filter.
+	 *
+	 * Twelve bits per key gives a false positive rate of about half a
+	 * percent. Each additional four bits per key divides it by about four.
+	 *
+	 * \param expectedCount The number of keys expected to be inserted.
+	 * \param bitsPerKey The number of bits per key.
+	 * \returns The number of blocks.
+	 */
+	constexpr std::int32_t bloom_filter_blocks(std::size_t expectedCount, std::int32_t bitsPerKey = 12)
+	{
+		return (expectedCount * bitsPerKey + 511) / 512 > 0
+			? static_cast<std::int32_t>((expectedCount * bitsPerKey + 511) / 512)
+			: 1;
+	}
+
+	/**
+	 * A Bloom filter where each key lives within a single cache line.
+	 *
+	 * Keys are 64-bit values such as asset identifiers, node indices or
+	 * the hash of a larger key. A key sets one bit in each of the eight
+	 * words of its 64 byte block so a lookup is a single cache miss, and
+	 * with AVX2 the block is tested with two vector compares. Batch
+	 * inserts and lookups hash a group of keys and prefetch their blocks
+	 * before touching any of them.
+	 *
+	 * \tparam Blocks The number of 512 bit blocks, or 0 to size the filter at runtime.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <std::int32_t Blocks = 0>
+	class blocked_bloom_filter
+	{
+		public:
+
+			static_assert(Blocks >= 0, "Invalid block count");
+
+			/**
+			 * Creates an instance of the blocked_bloom_filter class.
+			 *
+			 * A filter sized at runtime holds a single block.
+			 */
+			blocked_bloom_filter()
+			: _storage(Blocks > 0 ? Blocks : 1)
+			{ }
+
+			/**
+			 * Creates an instance of the blocked_bloom_filter class sized for a number of keys.
+			 *
+			 * \param expectedCount The number of keys expected to be inserted.
+			 * \param bitsPerKey The number of bits per key.
+			 */
+			explicit blocked_bloom_filter(std::size_t expectedCount, std::int32_t bitsPerKey = 12)
+			: _storage(bloom_filter_blocks(expectedCount, bitsPerKey))
+			{
+				static_assert(Blocks == 0, "Only filters sized at runtime can be sized for a number of keys");
+			}
+
+			/**
+			 * Inserts a key.
+			 *
+			 * \param key The key to insert.
+			 */
+			void insert(std::uint64_t key)
+			{
+				const std::uint64_t hash = detail::mix_hash(key);
+
+				detail::bloom_insert(block(hash), static_cast<std::uint32_t>(hash));
+			}
+
+			/**
+			 * Inserts an array of keys.
+			 *
+			 * \param keys The keys to insert.
+			 * \param count The number of keys.
+			 */
+			void insert(const std::uint64_t* keys, std::size_t count)
+			{
+				detail::bloom_for_each(_storage, keys, count, [] (std::size_t, std::uint64_t* block, std::uint32_t hash)
+				{
+					detail::bloom_insert(block, hash);
+				});
+			}
+
+			/**
+			 * Determines whether a key may have been inserted.
+			 *
+			 * \param key The key to test.
+			 * \returns \b false \b if the key was definitely not inserted; \b true \b if it may have been.
+			 */
+			bool contains(std::uint64_t key) const
+			{
+				const std::uint64_t hash = detail::mix_hash(key);
+
+				return detail::bloom_contains(block(hash), static_cast<std::uint32_t>(hash));
+			}
+
+			/**
+			 * Determines whether each of an array of keys may have been inserted.
+			 *
+			 * \param keys The keys to test.
+			 * \param count The number of keys.
+			 * \param results Receives 1 for each key that may have been inserted and 0 otherwise.
+			 * \returns The number of keys that may have been inserted.
+			 */
+			std::size_t contains(const std::uint64_t* keys, std::size_t count, std::uint8_t* results) const
+			{
+				// Results are captured by value as byte stores could alias a captured count
+				detail::bloom_for_each(_storage, keys, count, [results] (std::size_t index, const std::uint64_t* block, std::uint32_t hash)
+				{
+					results[index] = detail::bloom_contains(block, hash) ? 1 : 0;
+				});
+
+				std::size_t found = 0;
+
+				for (std::size_t i = 0; i < count; ++i)
+					found += results[i];
+
+				return found;
+			}
+
+			/**
+			 * Removes all keys.
+			 */
+			void clear()
+			{
+				std::fill_n(_storage.data(), word_count(), std::uint64_t(0));
+			}
+
+			/**
+			 * Gets the number of bits set.
+			 *
+			 * The fraction of bits set estimates the false positive rate,
+			 * which is roughly that fraction raised to the eighth power.
+			 */
+			std::int32_t count() const
+			{
+				return detail::count_words(_storage.data(), static_cast<std::int32_t>(word_count()));
+			}
+
+			/**
+			 * Gets the number of 512 bit blocks.
+			 */
+			std::int32_t block_count() const
+			{
+				return _storage.block_count();
+			}
+
+			/**
+			 * Gets the number of bytes used by the blocks.
+			 */
+			std::size_t memory_usage() const
+			{
+				return word_count() * sizeof(std::uint64_t);
+			}
+
+		private:
+
+			std::size_t word_count() const
+			{
+				return static_cast<std::size_t>(_storage.block_count()) * detail::bloom_block_words;
+			}
+
+			std::uint64_t* block(std::uint64_t hash)
+			{
+				return _storage.data() + static_cast<std::size_t>(detail::bloom_block(hash, _storage.block_count())) * detail::bloom_block_words;
+			}
+
+			const std::uint64_t* block(std::uint64_t hash) const
+			{
+				return _storage.data() + static_cast<std::size_t>(detail::bloom_block(hash, _storage.block_count())) * detail::bloom_block_words;
+			}
+
+			/// The blocks of the filter
+			detail::bloom_storage<Blocks> _storage;
+
+	} ; // end class blocked_bloom_filter
+
+	/**
+	 * A blocked Bloom filter of 4-bit counters that supports removal.
+	 *
+	 * Blocks have the same layout as blocked_bloom_filter with each word
+	 * holding sixteen counters in place of sixty four bits. A key bumps
+	 * one counter in each word of its block. Counters saturate at 15 and
+	 * a saturated counter is never decremented, so removals can leave
+	 * false positives but never false negatives. Only keys that were
+	 * inserted may be removed.
+	 *
+	 * \tparam Blocks The number of 512 bit blocks, or 0 to size the filter at runtime.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <std::int32_t Blocks = 0>
+	class counting_bloom_filter
+	{
+		public:
+
+			static_assert(Blocks >= 0, "Invalid block count");
+
+			/**
+			 * Creates an instance of the counting_bloom_filter class.
+			 *
+			 * A filter sized at runtime holds a single block.
+			 */
+			counting_bloom_filter()
+			: _storage(Blocks > 0 ? Blocks : 1)
+			{ }
+
+			/**
+			 * Creates an instance of the counting_bloom_filter class sized for a number of keys.
+			 *
+			 * Counters take four times the space of bits so bitsPerKey
+			 * should be four times that of an equivalent blocked_bloom_filter.
+			 *
+			 * \param expectedCount The number of keys expected to be inserted.
+			 * \param bitsPerKey The number of bits per key.
+			 */
+			explicit counting_bloom_filter(std::size_t expectedCount, std::int32_t bitsPerKey = 48)
+			: _storage(bloom_filter_blocks(expectedCount, bitsPerKey))
+			{
+				static_assert(Blocks == 0, "Only filters sized at runtime can be sized for a number of keys");
+			}
+
+			/**
+			 * Inserts a key.
+			 *
+			 * \param key The key to insert.
+			 */
+			void insert(std::uint64_t key)
+			{
+				const std::uint64_t hash = detail::mix_hash(key);
+
+				increment(block(hash), static_cast<std::uint32_t>(hash));
+			}
+
+			/**
+			 * Inserts an array of keys.
+			 *
+			 * \param keys The keys to insert.
+			 * \param count The number of keys.
+			 */
+			void insert(const std::uint64_t* keys, std::size_t count)
+			{
+				detail::bloom_for_each(_storage, keys, count, [] (std::size_t, std::uint64_t* block, std::uint32_t hash)
+				{
+					increment(block, hash);
+				});
+			}
+
+			/**
+			 * Removes a key that was inserted.
+			 *
+			 * \param key The key to remove.
+			 */
+			void remove(std::uint64_t key)
+			{
+				const std::uint64_t hash = detail::mix_hash(key);
+				std::uint64_t* words = block(hash);
+
+				RECHARGEABLE_ASSERT(present(words, static_cast<std::uint32_t>(hash)), "Key was not inserted");
+
+				for (std::int32_t i = 0; i < detail::bloom_block_words; ++i)
+				{
+					const std::int32_t shift = detail::bloom_counter_shift(static_cast<std::uint32_t>(hash), i);
+					const std::uint64_t counter = (words[i] >> shift) & 0xf;
+
+					if ((counter != 0) && (counter != 0xf))
+						words[i] -= std::uint64_t(1) << shift;
+				}
+			}
+
+			/**
+			 * Determines whether a key may have been inserted.
+			 *
+			 * \param key The key to test.
+			 * \returns \b false \b if the key is definitely not present; \b true \b if it may be.
+			 */
+			bool contains(std::uint64_t key) const
+			{
+				const std::uint64_t hash = detail::mix_hash(key);
+
+				return present(block(hash), static_cast<std::uint32_t>(hash));
+			}
+
+			/**
+			 * Determines whether each of an array of keys may have been inserted.
+			 *
+			 * \param keys The keys to test.
+			 * \param count The number of keys.
+			 * \param results Receives 1 for each key that may be present and 0 otherwise.
+			 * \returns The number of keys that may be present.
+			 */
+			std::size_t contains(const std::uint64_t* keys, std::size_t count, std::uint8_t* results) const
+			{
+				// Results are captured by value as byte stores could alias a captured count
+				detail::bloom_for_each(_storage, keys, count, [results] (std::size_t index, const std::uint64_t* block, std::uint32_t hash)
+				{
+					results[index] = present(block, hash) ? 1 : 0;
+				});
+
+				std::size_t found = 0;
+
+				for (std::size_t i = 0; i < count; ++i)
+					found += results[i];
+
+				return found;
+			}
+
+			/**
+			 * Removes all keys.
+			 */
+			void clear()
+			{
+				std::fill_n(_storage.data(), static_cast<std::size_t>(_storage.block_count()) * detail::bloom_block_words, std::uint64_t(0));
+			}
+
+			/**
+			 * Gets the number of 512 bit blocks.
+			 */
+			std::int32_t block_count() const
+			{
+				return _storage.block_count();
+			}
+
+			/**
+			 * Gets the number of bytes used by the blocks.
+			 */
+			std::size_t memory_usage() const
+			{
+				return static_cast<std::size_t>(_storage.block_count()) * detail::bloom_block_words * sizeof(std::uint64_t);
+			}
+
+		private:
+
+			static void increment(std::uint64_t* words, std::uint32_t hash)
+			{
+				for (std::int32_t i = 0; i < detail::bloom_block_words; ++i)
+				{
+					const std::int32_t shift = detail::bloom_counter_shift(hash, i);
+
+					if (((words[i] >> shift) & 0xf) != 0xf)
+						words[i] += std::uint64_t(1) << shift;
+				}
+			}
+
+			static bool present(const std::uint64_t* words, std::uint32_t hash)
+			{
+				bool result = true;
+
+				for (std::int32_t i = 0; i < detail::bloom_block_words; ++i)
+					result &= ((words[i] >> detail::bloom_counter_shift(hash, i)) & 0xf) != 0;
+
+				return result;
+			}
+
+			std::uint64_t* block(std::uint64_t hash)
+			{
+				return _storage.data() + static_cast<std::size_t>(detail::bloom_block(hash, _storage.block_count())) * detail::bloom_block_words;
+			}
+
+			const std::uint64_t* block(std::uint64_t hash) const
+			{
+				return _storage.data() + static_cast<std::size_t>(detail::bloom_block(hash, _storage.block_count())) * detail::bloom_block_words;
+			}
+
+			/// The counters of the filter
+			detail::bloom_storage<Blocks> _storage;
+
+	} ; // end class counting_bloom_filter
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_BLOOM_FILTER_HPP_INCLUDED
@@ -0,0 +1,656 @@
+/**
+ * \file compressed_bitmap.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_COMPRESSED_BITMAP_HPP_INCLUDED
+#define RECHARGEABLE_COMPRESSED_BITMAP_HPP_INCLUDED
+
+#include <rtl/flags/detail/roaring_container.hpp>
+#include <cstddef>
+
+namespace rtl
+{
+	/**
+	 * A compressed set of 32-bit values.
+	 *
+	 * Values are partitioned into chunks of 65536 by their upper 16 bits.
+	 * Each chunk is held in a container stored as a sorted array, a
+	 * bitmap or a list of runs, whichever suits the values in it. Sparse
+	 * chunks cost two bytes a value and dense chunks one bit a value.
+	 *
+	 * Modifying a run container converts it into an array or bitmap.
+	 * Call optimize() once a bitmap has been built to convert containers
+	 * to runs where that is smaller.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	class compressed_bitmap
+	{
+		public:
+
+			/**
+			 * Creates an empty instance of the compressed_bitmap class.
+			 */
+			compressed_bitmap()
+			{ }
+
+			//----------------------------------------------------------------------
+			// Values
+			//----------------------------------------------------------------------
+
+			/**
+			 * Adds a value.
+			 *
+			 * \param value The value to add.
+			 * \returns \b true \b if the value was added; \b false \b if already present.
+			 */
+			bool add(std::uint32_t value)
+			{
+				const std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+				std::vector<detail::roaring_container>::iterator position = find_container(key);
+
+				if ((position == _containers.end()) || (position->key != key))
+				{
+					position = _containers.insert(position, detail::roaring_container());
+					position->key = key;
+				}
+
+				return detail::roaring_add(*position, static_cast<std::uint16_t>(value));
+			}
+
+			/**
+			 * Removes a value.
+			 *
+			 * \param value The value to remove.
+			 * \returns \b true \b if the value was removed; \b false \b if not present.
+			 */
+			bool remove(std::uint32_t value)
+			{
+				const std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+				std::vector<detail::roaring_container>::iterator position = find_container(key);
+
+				if ((position == _containers.end()) || (position->key != key))
+					return false;
+
+				if (!detail::roaring_remove(*position, static_cast<std::uint16_t>(value)))
+					return false;
+
+				if (position->cardinality == 0)
+					_containers.erase(position);
+
+				return true;
+			}
+
+			/**
+			 * Determines whether a value is held.
+			 *
+			 * \param value The value to query.
+			 * \returns \b true \b if the value is held; \b false \b otherwise.
+			 */
+			bool contains(std::uint32_t value) const
+			{
+				const std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+				std::vector<detail::roaring_container>::const_iterator position = find_container(key);
+
+				if ((position == _containers.end()) || (position->key != key))
+					return false;
+
+				return detail::roaring_contains(*position, static_cast<std::uint16_t>(value));
+			}
+
+			/**
+			 * Gets the number of values held.
+			 *
+			 * \returns The number of values held.
+			 */
+			std::uint64_t cardinality() const
+			{
+				std::uint64_t total = 0;
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+					total += _containers[i].cardinality;
+
+				return total;
+			}
+
+			/**
+			 * Determines whether no values are held.
+			 *
+			 * \returns \b true \b if the bitmap is empty; \b false \b otherwise.
+			 */
+			bool empty() const
+			{
+				return _containers.empty();
+			}
+
+			/**
+			 * Removes all values.
+			 */
+			void clear()
+			{
+				_containers.clear();
+			}
+
+			/**
+			 * Converts each container into its smallest representation.
+			 */
+			void optimize()
+			{
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+					detail::roaring_optimize(_containers[i]);
+			}
+
+			/**
+			 * Gets the number of bytes used to hold the values.
+			 *
+			 * \returns The approximate memory used by the containers.
+			 */
+			std::size_t memory_usage() const
+			{
+				std::size_t total = _containers.capacity() * sizeof(detail::roaring_container);
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					total += _containers[i].values.capacity() * sizeof(std::uint16_t);
+					total += _containers[i].words.capacity() * sizeof(std::uint64_t);
+				}
+
+				return total;
+			}
+
+			/**
+			 * Invokes a function for each value in ascending order.
+			 *
+			 * \tparam Function The type of function. Called with a std::uint32_t.
+			 * \param function The function to invoke.
+			 */
+			template <typename Function>
+			void for_each(Function function) const
+			{
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					const std::uint32_t high = static_cast<std::uint32_t>(_containers[i].key) << 16;
+
+					detail::for_each_roaring(_containers[i], [&](std::int32_t low)
+					{
+						function(high | static_cast<std::uint32_t>(low));
+					});
+				}
+			}
+
+			//----------------------------------------------------------------------
+			// Set operations
+			//----------------------------------------------------------------------
+
+			compressed_bitmap& operator|= (const compressed_bitmap& rhs)
+			{
+				*this = *this | rhs;
+				return *this;
+			}
+
+			compressed_bitmap& operator&= (const compressed_bitmap& rhs)
+			{
+				*this = *this & rhs;
+				return *this;
+			}
+
+			compressed_bitmap& operator-= (const compressed_bitmap& rhs)
+			{
+				*this = *this - rhs;
+				return *this;
+			}
+
+			/**
+			 * Computes the union of two bitmaps.
+			 *
+			 * \param rhs The right hand side of the operation.
+			 * \returns The values held in either bitmap.
+			 */
+			compressed_bitmap operator| (const compressed_bitmap& rhs) const
+			{
+				compressed_bitmap result;
+				result._containers.reserve(_containers.size() + rhs._containers.size());
+
+				std::size_t i = 0;
+				std::size_t j = 0;
+
+				while ((i < _containers.size()) && (j < rhs._containers.size()))
+				{
+					const detail::roaring_container& lhsContainer = _containers[i];
+					const detail::roaring_container& rhsContainer = rhs._containers[j];
+
+					if (lhsContainer.key < rhsContainer.key)
+					{
+						result._containers.push_back(lhsContainer);
+						++i;
+					}
+					else if (rhsContainer.key < lhsContainer.key)
+					{
+						result._containers.push_back(rhsContainer);
+						++j;
+					}
+					else
+					{
+						result._containers.push_back(detail::roaring_container());
+						detail::roaring_union(lhsContainer, rhsContainer, result._containers.back());
+						++i;
+						++j;
+					}
+				}
+
+				result._containers.insert(result._containers.end(), _containers.begin() + i, _containers.end());
+				result._containers.insert(result._containers.end(), rhs._containers.begin() + j, rhs._containers.end());
+
+				return result;
+			}
+
+			/**
+			 * Computes the intersection of two bitmaps.
+			 *
+			 * \param rhs The right hand side of the operation.
+			 * \returns The values held in both bitmaps.
+			 */
+			compressed_bitmap operator& (const compressed_bitmap& rhs) const
+			{
+				compressed_bitmap result;
+
+				std::size_t i = 0;
+				std::size_t j = 0;
+
+				while ((i < _containers.size()) && (j < rhs._containers.size()))
+				{
+					const detail::roaring_container& lhsContainer = _containers[i];
+					const detail::roaring_container& rhsContainer = rhs._containers[j];
+
+					if (lhsContainer.key < rhsContainer.key)
+					{
+						++i;
+					}
+					else if (rhsContainer.key < lhsContainer.key)
+					{
+						++j;
+					}
+					else
+					{
+						detail::roaring_container container;
+						detail::roaring_intersection(lhsContainer, rhsContainer, container);
+
+						if (container.cardinality > 0)
+							result._containers.push_back(std::move(container));
+
+						++i;
+						++j;
+					}
+				}
+
+				return result;
+			}
+
+			/**
+			 * Computes the difference of two bitmaps.
+			 *
+			 * \param rhs The values to remove.
+			 * \returns The values held in the instance and not in rhs.
+			 */
+			compressed_bitmap operator- (const compressed_bitmap& rhs) const
+			{
+				compressed_bitmap result;
+				result._containers.reserve(_containers.size());
+
+				std::size_t j = 0;
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					const detail::roaring_container& lhsContainer = _containers[i];
+
+					while ((j < rhs._containers.size()) && (rhs._containers[j].key < lhsContainer.key))
+						++j;
+
+					if ((j == rhs._containers.size()) || (rhs._containers[j].key != lhsContainer.key))
+					{
+						result._containers.push_back(lhsContainer);
+						continue;
+					}
+
+					detail::roaring_container container;
+					detail::roaring_difference(lhsContainer, rhs._containers[j], container);
+
+					if (container.cardinality > 0)
+						result._containers.push_back(std::move(container));
+				}
+
+				return result;
+			}
+
+			bool operator== (const compressed_bitmap& rhs) const
+			{
+				if (_containers.size() != rhs._containers.size())
+					return false;
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					const detail::roaring_container& lhsContainer = _containers[i];
+					const detail::roaring_container& rhsContainer = rhs._containers[i];
+
+					if ((lhsContainer.key != rhsContainer.key) || (lhsContainer.cardinality != rhsContainer.cardinality))
+						return false;
+
+					detail::roaring_container difference;
+					detail::roaring_difference(lhsContainer, rhsContainer, difference);
+
+					if (difference.cardinality != 0)
+						return false;
+				}
+
+				return true;
+			}
+
+			bool operator!= (const compressed_bitmap& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+			//----------------------------------------------------------------------
+			// Serialization
+			//
+			// The serialized form is little endian regardless of the host:
+			//
+			//   u32 magic 'RTLB', u16 version, u16 reserved, u32 container count
+			//   per container:
+			//     u16 key, u8 type, u8 reserved, u32 element count
+			//     array:  count u16 values
+			//     bitmap: 1024 u64 words
+			//     run:    count (u16 start, u16 length - 1) pairs
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the number of bytes required to serialize the bitmap.
+			 *
+			 * \returns The size of the serialized form.
+			 */
+			std::size_t serialized_size() const
+			{
+				std::size_t total = header_size;
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					const detail::roaring_container& container = _containers[i];
+
+					total += container_header_size;
+
+					if (container.type == detail::roaring_container::bitmap_type)
+						total += detail::roaring_bitmap_words * 8;
+					else
+						total += container.values.size() * 2;
+				}
+
+				return total;
+			}
+
+			/**
+			 * Writes the bitmap into a buffer.
+			 *
+			 * \param buffer The buffer to write to.
+			 * \param size The size of the buffer.
+			 * \returns The number of bytes written, or 0 if the buffer is too small.
+			 */
+			std::size_t serialize(std::uint8_t* buffer, std::size_t size) const
+			{
+				const std::size_t required = serialized_size();
+
+				if (size < required)
+					return 0;
+
+				std::uint8_t* out = buffer;
+
+				out = write(out, magic, 4);
+				out = write(out, version, 2);
+				out = write(out, 0, 2);
+				out = write(out, _containers.size(), 4);
+
+				for (std::size_t i = 0; i < _containers.size(); ++i)
+				{
+					const detail::roaring_container& container = _containers[i];
+
+					out = write(out, container.key, 2);
+					out = write(out, container.type, 1);
+					out = write(out, 0, 1);
+
+					if (container.type == detail::roaring_container::bitmap_type)
+					{
+						out = write(out, detail::roaring_bitmap_words, 4);
+
+						for (std::int32_t w = 0; w < detail::roaring_bitmap_words; ++w)
+							out = write(out, container.words[w], 8);
+					}
+					else
+					{
+						const std::size_t count = (container.type == detail::roaring_container::run_type)
+							? container.values.size() / 2
+							: container.values.size();
+
+						out = write(out, count, 4);
+
+						for (std::size_t v = 0; v < container.values.size(); ++v)
+							out = write(out, container.values[v], 2);
+					}
+				}
+
+				return required;
+			}
+
+			/**
+			 * Reads a bitmap written by serialize.
+			 *
+			 * The contents are validated and must fill the buffer exactly. On
+			 * failure the bitmap is left empty.
+			 *
+			 * \param buffer The buffer to read from.
+			 * \param size The size of the serialized bitmap.
+			 * \returns \b true \b if the buffer held a valid bitmap; \b false \b otherwise.
+			 */
+			bool deserialize(const std::uint8_t* buffer, std::size_t size)
+			{
+				clear();
+
+				if (!read_containers(buffer, size))
+				{
+					clear();
+					return false;
+				}
+
+				return true;
+			}
+
+		private:
+
+			/// Magic number identifying the serialized form
+			static const std::uint32_t magic = 0x424c5452;
+			/// Version of the serialized form
+			static const std::uint16_t version = 1;
+			/// Size of the serialized header
+			static const std::size_t header_size = 12;
+			/// Size of the serialized container header
+			static const std::size_t container_header_size = 8;
+
+			std::vector<detail::roaring_container>::iterator find_container(std::uint16_t key)
+			{
+				return std::lower_bound(_containers.begin(), _containers.end(), key, key_less());
+			}
+
+			std::vector<detail::roaring_container>::const_iterator find_container(std::uint16_t key) const
+			{
+				return std::lower_bound(_containers.begin(), _containers.end(), key, key_less());
+			}
+
+			struct key_less
+			{
+				bool operator() (const detail::roaring_container& container, std::uint16_t key) const
+				{
+					return container.key < key;
+				}
+			} ;
+
+			static std::uint8_t* write(std::uint8_t* out, std::uint64_t value, std::int32_t bytes)
+			{
+				for (std::int32_t i = 0; i < bytes; ++i)
+					*out++ = static_cast<std::uint8_t>(value >> (i * 8));
+
+				return out;
+			}
+
+			static std::uint64_t read(const std::uint8_t* in, std::int32_t bytes)
+			{
+				std::uint64_t value = 0;
+
+				for (std::int32_t i = 0; i < bytes; ++i)
+					value |= static_cast<std::uint64_t>(in[i]) << (i * 8);
+
+				return value;
+			}
+
+			bool read_containers(const std::uint8_t* buffer, std::size_t size)
+			{
+				if ((size < header_size) || (read(buffer, 4) != magic) || (read(buffer + 4, 2) != version))
+					return false;
+
+				const std::size_t count = static_cast<std::size_t>(read(buffer + 8, 4));
+				std::size_t offset = header_size;
+
+				// Every container needs at least its header so bound the count before allocating
+				if (count > (size - header_size) / container_header_size)
+					return false;
+
+				_containers.resize(count);
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					if (size - offset < container_header_size)
+						return false;
+
+					detail::roaring_container& container = _containers[i];
+
+					container.key = static_cast<std::uint16_t>(read(buffer + offset, 2));
+					container.type = static_cast<std::uint8_t>(read(buffer + offset + 2, 1));
+
+					const std::size_t elements = static_cast<std::size_t>(read(buffer + offset + 4, 4));
+					offset += container_header_size;
+
+					// Keys must be strictly increasing
+					if ((i > 0) && (container.key <= _containers[i - 1].key))
+						return false;
+
+					if (container.type == detail::roaring_container::bitmap_type)
+					{
+						if ((elements != static_cast<std::size_t>(detail::roaring_bitmap_words)) || (size - offset < elements * 8))
+							return false;
+
+						container.words.resize(elements);
+
+						for (std::size_t w = 0; w < elements; ++w)
+							container.words[w] = read(buffer + offset + (w * 8), 8);
+
+						offset += elements * 8;
+						container.cardinality = detail::count_words(&container.words[0], detail::roaring_bitmap_words);
+
+						if (container.cardinality <= detail::roaring_array_limit)
+							return false;
+					}
+					else if (container.type == detail::roaring_container::array_type)
+					{
+						if ((elements == 0) || (elements > static_cast<std::size_t>(detail::roaring_array_limit)) || (size - offset < elements * 2))
+							return false;
+
+						container.values.resize(elements);
+
+						for (std::size_t v = 0; v < elements; ++v)
+						{
+							container.values[v] = static_cast<std::uint16_t>(read(buffer + offset + (v * 2), 2));
+
+							if ((v > 0) && (container.values[v] <= container.values[v - 1]))
+								return false;
+						}
+
+						offset += elements * 2;
+						container.cardinality = static_cast<std::int32_t>(elements);
+					}
+					else if (container.type == detail::roaring_container::run_type)
+					{
+						if ((elements == 0) || (elements > 32768) || (size - offset < elements * 4))
+							return false;
+
+						container.values.resize(elements * 2);
+						container.cardinality = 0;
+
+						std::int32_t previousLast = -2;
+
+						for (std::size_t r = 0; r < elements * 2; r += 2)
+						{
+							container.values[r] = static_cast<std::uint16_t>(read(buffer + offset + (r * 2), 2));
+							container.values[r + 1] = static_cast<std::uint16_t>(read(buffer + offset + (r * 2) + 2, 2));
+
+							const std::int32_t start = container.values[r];
+							const std::int32_t last = start + container.values[r + 1];
+
+							// Runs must be in order, separated and within the chunk
+							if ((start <= previousLast + 1) || (last > 65535))
+								return false;
+
+							container.cardinality += last - start + 1;
+							previousLast = last;
+						}
+
+						offset += elements * 4;
+					}
+					else
+					{
+						return false;
+					}
+				}
+
+				// Trailing bytes mean the size does not describe this bitmap
+				return offset == size;
+			}
+
+			/// The containers ordered by key
+			std::vector<detail::roaring_container> _containers;
+
+	} ; // end class compressed_bitmap
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_COMPRESSED_BITMAP_HPP_INCLUDED
@@ -0,0 +1,167 @@
+/**
+ * \file bit_iterator.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_BIT_ITERATOR_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_BIT_ITERATOR_HPP_INCLUDED
+
+#include <rtl/flags/detail/intrinsics.hpp>
+#include <iterator>
+
+namespace rtl { namespace detail
+{
+	/**
+	 * Iterates over the bits set in an array of words.
+	 *
+	 * The current word is cached and the lowest bit is cleared on each
+	 * increment, so only the bits that are set are visited.
+	 *
+	 * \tparam Word The type of word.
+	 * \tparam Value The type to convert the location of a bit to.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Word, typename Value = std::int32_t>
+	class set_bit_iterator
+	{
+		public:
+
+			typedef std::forward_iterator_tag iterator_category;
+			typedef Value value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const Value* pointer;
+			typedef Value reference;
+
+			/**
+			 * Creates an iterator pointing to the first bit set.
+			 *
+			 * \param words The array of words.
+			 * \param count The number of words.
+			 */
+			set_bit_iterator(const Word* words, std::int32_t count)
+			: _words(words)
+			, _count(count)
+			, _index(0)
+			, _current(count > 0 ? words[0] : 0)
+			{
+				skip_empty();
+			}
+
+			/**
+			 * Creates an iterator pointing past the last bit.
+			 *
+			 * \param words The array of words.
+			 * \param count The number of words.
+			 * \param end Tag denoting the end iterator.
+			 */
+			set_bit_iterator(const Word* words, std::int32_t count, bool)
+			: _words(words)
+			, _count(count)
+			, _index(count)
+			, _current(0)
+			{ }
+
+			/**
+			 * Gets the location of the current bit.
+			 *
+			 * \returns The location of the current bit.
+			 */
+			inline Value operator* () const
+			{
+				return static_cast<Value>((_index * static_cast<std::int32_t>(sizeof(Word) * 8)) + count_trailing_zeros(_current));
+			}
+
+			inline set_bit_iterator& operator++ ()
+			{
+				// Clear the lowest bit set
+				_current &= _current - 1;
+
+				skip_empty();
+
+				return *this;
+			}
+
+			inline set_bit_iterator operator++ (int)
+			{
+				set_bit_iterator copy(*this);
+				++(*this);
+				return copy;
+			}
+
+			inline bool operator== (const set_bit_iterator& rhs) const
+			{
+				return (_index == rhs._index) && (_current == rhs._current);
+			}
+
+			inline bool operator!= (const set_bit_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		private:
+
+			/**
+			 * Moves to the next word containing a bit.
+			 */
+			inline void skip_empty()
+			{
+				while (_current == 0)
+				{
+					if (++_index >= _count)
+					{
+						_index = _count;
+						return;
+					}
+
+					_current = _words[_index];
+				}
+			}
+
+			/// The array of words
+			const Word* _words;
+			/// The number of words
+			std::int32_t _count;
+			/// The index of the current word
+			std::int32_t _index;
+			/// The bits remaining in the current word
+			std::uint64_t _current;
+
+	} ; // end class set_bit_iterator<Word, Value>
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_BIT_ITERATOR_HPP_INCLUDED
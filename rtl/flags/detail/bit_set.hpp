@@ -42,6 +42,31 @@
 
 namespace rtl { namespace detail
 {
+	//----------------------------------------------------------------------
+	// Container selection
+	//----------------------------------------------------------------------
+
+	/**
+	 * Selects the number of bits required to hold a number of flags.
+	 *
+	 * Up to 64 flags the smallest built in type that can hold the flags
+	 * is chosen. Above that the flags are rounded up to a multiple of a
+	 * 64-bit word.
+	 *
+	 * \tparam Size The number of flags to hold.
+	 */
+	template <std::int32_t Size>
+	struct select_bits
+	{
+		/// The number of bits in the container
+		static const std::int32_t value =
+			(Size <= 8)  ? 8  :
+			(Size <= 16) ? 16 :
+			(Size <= 32) ? 32 :
+			((Size + 63) & ~63);
+
+	} ; // end struct select_bits<Size>
+
 	//----------------------------------------------------------------------
 	// Generic collection
 	//----------------------------------------------------------------------
@@ -49,31 +74,43 @@ namespace rtl { namespace detail
 	/**
 	 * Stores a collection of bits.
 	 *
+	 * The generic implementation holds the bits in an array of 64-bit
+	 * words. Bits that are beyond the requested size are kept cleared.
+	 *
 	 * \author Don Olmstead
 	 * \version 0.1
 	 */
 	template <std::int32_t Bits>
 	struct bit_set
 	{
-		private:
+		public:
 
-			/// The size of the underlying array
-			static const std::int32_t __arraySize = ((Bits + 7) & ~7) >> 3;
+			/// The type holding the bits
+			typedef std::uint64_t word_type;
 
-		public:
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 64;
+
+			/// The number of words in the underlying array
+			static const std::int32_t word_count = (Bits + 63) >> 6;
+
+			/// The bits of the last word that are within the collection
+			static const word_type last_word_mask = ((Bits & 63) == 0)
+				? ~word_type(0)
+				: (word_type(1) << (Bits & 63)) - 1;
 
 			/**
 			 * Gets the size of the underlying array.
 			 *
-			 * \returns The size of the underlying array.
+			 * \returns The number of words in the underlying array.
 			 */
-			static std::int32_t size()
+			static constexpr std::int32_t size()
 			{
-				return __arraySize;
+				return word_count;
 			}
 
 			/// The container holding the bits
-			std::uint8_t _bit_array[__arraySize];
+			word_type _bit_array[word_count];
 
 	} ; // end struct bit_set<Bits>
 
@@ -84,7 +121,7 @@ namespace rtl { namespace detail
 	 * \param set The collection of bits.
 	 */
 	template <std::int32_t Bits>
-	inline void clear_bit_set(bit_set<Bits>& set)
+	constexpr void clear_bit_set(bit_set<Bits>& set)
 	{
 		const std::int32_t size = bit_set<Bits>::size();
 
@@ -100,15 +137,15 @@ namespace rtl { namespace detail
 	 * \param location The bit to set.
 	 */
 	template <std::int32_t Bits>
-	inline void set_bit(bit_set<Bits>& set, std::int32_t location)
+	constexpr void set_bit(bit_set<Bits>& set, std::int32_t location)
 	{
 		RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
 
-		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
-		const std::int32_t bit = location - (8 * index);
+		const std::int32_t index = location >> 6;
+		const std::int32_t bit = location & 63;
 
 		// Set the bit
-		set._bit_array[index] |= (1 << bit);
+		set._bit_array[index] |= (std::uint64_t(1) << bit);
 	}
 
 	/**
@@ -119,15 +156,15 @@ namespace rtl { namespace detail
 	 * \param location The bit to clear.
 	 */
 	template <std::int32_t Bits>
-	inline void clear_bit(bit_set<Bits>& set, std::int32_t location)
+	constexpr void clear_bit(bit_set<Bits>& set, std::int32_t location)
 	{
 		RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
 
-		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
-		const std::int32_t bit = location - (8 * index);
+		const std::int32_t index = location >> 6;
+		const std::int32_t bit = location & 63;
 
 		// Clear the bit
-		set._bit_array[index] &= ~(1 << bit);
+		set._bit_array[index] &= ~(std::uint64_t(1) << bit);
 	}
 
 	/**
@@ -138,15 +175,15 @@ namespace rtl { namespace detail
 	 * \param location The bit to clear.
 	 */
 	template <std::int32_t Bits>
-	inline void toggle_bit(bit_set<Bits>& set, std::int32_t location)
+	constexpr void toggle_bit(bit_set<Bits>& set, std::int32_t location)
 	{
 		RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
 
-		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
-		const std::int32_t bit = location - (8 * index);
+		const std::int32_t index = location >> 6;
+		const std::int32_t bit = location & 63;
 
-		// Clear the bit
-		set._bit_array[index] ^= (1 << bit);
+		// Toggle the bit
+		set._bit_array[index] ^= (std::uint64_t(1) << bit);
 	}
 
 	/**
@@ -157,23 +194,77 @@ namespace rtl { namespace detail
 	 * \param location The bit to query.
 	 */
 	template <std::int32_t Bits>
-	inline bool is_bit_set(const bit_set<Bits>& set, std::int32_t location)
+	constexpr bool is_bit_set(const bit_set<Bits>& set, std::int32_t location)
 	{
 		RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
 
-		const std::int32_t index = (((location + 8) & ~7) >> 3) - 1;
-		const std::int32_t bit = location - (8 * index);
+		const std::int32_t index = location >> 6;
+		const std::int32_t bit = location & 63;
 
 		// Check the bit
-		const std::int32_t mask = (1 << bit);
-		return (set._bit_array[index] & mask) == mask;
+		return ((set._bit_array[index] >> bit) & 1) != 0;
+	}
+
+	/**
+	 * Gets the words holding the bits.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param set The collection of bits.
+	 * \returns A pointer to the first of bit_set<Bits>::word_count words.
+	 */
+	template <std::int32_t Bits>
+	constexpr typename bit_set<Bits>::word_type* word_data(bit_set<Bits>& set)
+	{
+		return set._bit_array;
+	}
+
+	/**
+	 * Gets the words holding the bits.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param set The collection of bits.
+	 * \returns A pointer to the first of bit_set<Bits>::word_count words.
+	 */
+	template <std::int32_t Bits>
+	constexpr const typename bit_set<Bits>::word_type* word_data(const bit_set<Bits>& set)
+	{
+		return set._bit_array;
+	}
+
+	/**
+	 * Gets the bit container.
+	 *
+	 * Provides the same access as the bit_union overload so code can be
+	 * written against either representation.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param set The collection of bits.
+	 * \returns The collection of bits.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits>& bit_container(bit_set<Bits>& set)
+	{
+		return set;
+	}
+
+	/**
+	 * Gets the bit container.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param set The collection of bits.
+	 * \returns The collection of bits.
+	 */
+	template <std::int32_t Bits>
+	constexpr const bit_set<Bits>& bit_container(const bit_set<Bits>& set)
+	{
+		return set;
 	}
 
 	//----------------------------------------------------------------------
 	// Function macros
 	//
 	// The specializations of the bit_set class use built in types
-	// rather than a byte array. The code for all these specializations
+	// rather than a word array. The code for all these specializations
 	// is the same so macros are used to create the implementations.
 	//----------------------------------------------------------------------
 
@@ -184,7 +275,7 @@ namespace rtl { namespace detail
 	 */
 	#define RECHARGEABLE_CLEAR_BIT_SET(N) \
 	template <> \
-	inline void clear_bit_set(bit_set<N>& set) \
+	constexpr void clear_bit_set(bit_set<N>& set) \
 	{ \
 		set._bit_array = 0; \
 	}
@@ -196,11 +287,11 @@ namespace rtl { namespace detail
 	 */
 	#define RECHARGEABLE_SET_BIT(N) \
 	template <> \
-	inline void set_bit(bit_set<N>& set, std::int32_t location) \
+	constexpr void set_bit(bit_set<N>& set, std::int32_t location) \
 	{ \
 		RECHARGEABLE_ASSERT((location >= 0) && (location < N), "Invalid location"); \
 		\
-		set._bit_array |= (1 << location); \
+		set._bit_array |= (bit_set<N>::word_type(1) << location); \
 	}
 
 	/**
@@ -210,11 +301,11 @@ namespace rtl { namespace detail
 	 */
 	#define RECHARGEABLE_CLEAR_BIT(N) \
 	template <> \
-	inline void clear_bit(bit_set<N>& set, std::int32_t location) \
+	constexpr void clear_bit(bit_set<N>& set, std::int32_t location) \
 	{ \
 		RECHARGEABLE_ASSERT((location >= 0) && (location < N), "Invalid location"); \
 		\
-		set._bit_array &= ~(1 << location); \
+		set._bit_array &= ~(bit_set<N>::word_type(1) << location); \
 	}
 
 	/**
@@ -224,11 +315,11 @@ namespace rtl { namespace detail
 	 */
 	#define RECHARGEABLE_TOGGLE_BIT(N) \
 	template <> \
-	inline void toggle_bit(bit_set<N>& set, std::int32_t location) \
+	constexpr void toggle_bit(bit_set<N>& set, std::int32_t location) \
 	{ \
 		RECHARGEABLE_ASSERT((location >= 0) && (location < N), "Invalid location"); \
 		\
-		set._bit_array ^= (1 << location); \
+		set._bit_array ^= (bit_set<N>::word_type(1) << location); \
 	}
 
 	/**
@@ -238,26 +329,43 @@ namespace rtl { namespace detail
 	 */
 	#define RECHARGEABLE_IS_BIT_SET(N) \
 	template <> \
-	inline bool is_bit_set(const bit_set<N>& set, std::int32_t location) \
+	constexpr bool is_bit_set(const bit_set<N>& set, std::int32_t location) \
 	{ \
 		RECHARGEABLE_ASSERT((location >= 0) && (location < N), "Invalid location"); \
 		\
-		const std::int32_t mask = (1 << location); \
-		return (set._bit_array & mask) == mask; \
+		return ((set._bit_array >> location) & 1) != 0; \
 	}
 
 	#define RECHARGEABLE_SET_VALUE(N, Type) \
-	inline void set_bit_values(bit_set<N>& set, Type value) \
+	constexpr void set_bit_values(bit_set<N>& set, Type value) \
 	{ \
 		set._bit_array = value; \
 	}
 
 	#define RECHARGEABLE_GET_VALUE(N, Type) \
-	inline Type get_bit_values(const bit_set<N>& set) \
+	constexpr Type get_bit_values(const bit_set<N>& set) \
 	{ \
 		return set._bit_array; \
 	}
 
+	/**
+	 * Creates the word_data functions for a template specialization.
+	 *
+	 * \param N The number of bits.
+	 */
+	#define RECHARGEABLE_WORD_DATA(N) \
+	template <> \
+	constexpr bit_set<N>::word_type* word_data(bit_set<N>& set) \
+	{ \
+		return &set._bit_array; \
+	} \
+	\
+	template <> \
+	constexpr const bit_set<N>::word_type* word_data(const bit_set<N>& set) \
+	{ \
+		return &set._bit_array; \
+	}
+
 	//----------------------------------------------------------------------
 	// 8-bit implementation
 	//----------------------------------------------------------------------
@@ -267,14 +375,26 @@ namespace rtl { namespace detail
 	{
 		public:
 
+			/// The type holding the bits
+			typedef std::uint8_t word_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 8;
+
+			/// The number of words in the underlying container
+			static const std::int32_t word_count = 1;
+
+			/// The bits of the last word that are within the collection
+			static const word_type last_word_mask = static_cast<word_type>(~word_type(0));
+
 			/**
-			 * Gets the size of the underlying array.
+			 * Gets the size of the underlying container.
 			 *
-			 * \returns The size of the underlying array.
+			 * \returns The number of words in the underlying container.
 			 */
-			static std::int32_t size()
+			static constexpr std::int32_t size()
 			{
-				return 1;
+				return word_count;
 			}
 
 			/// The container holding the bits
@@ -289,6 +409,7 @@ namespace rtl { namespace detail
 	RECHARGEABLE_IS_BIT_SET(8)
 	RECHARGEABLE_SET_VALUE(8, std::uint8_t)
 	RECHARGEABLE_GET_VALUE(8, std::uint8_t)
+	RECHARGEABLE_WORD_DATA(8)
 
 	//----------------------------------------------------------------------
 	// 16-bit implementation
@@ -299,14 +420,26 @@ namespace rtl { namespace detail
 	{
 		public:
 
+			/// The type holding the bits
+			typedef std::uint16_t word_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 16;
+
+			/// The number of words in the underlying container
+			static const std::int32_t word_count = 1;
+
+			/// The bits of the last word that are within the collection
+			static const word_type last_word_mask = static_cast<word_type>(~word_type(0));
+
 			/**
-			 * Gets the size of the underlying array.
+			 * Gets the size of the underlying container.
 			 *
-			 * \returns The size of the underlying array.
+			 * \returns The number of words in the underlying container.
 			 */
-			static std::int32_t size()
+			static constexpr std::int32_t size()
 			{
-				return 2;
+				return word_count;
 			}
 
 			/// The container holding the bits
@@ -321,6 +454,7 @@ namespace rtl { namespace detail
 	RECHARGEABLE_IS_BIT_SET(16)
 	RECHARGEABLE_SET_VALUE(16, std::uint16_t)
 	RECHARGEABLE_GET_VALUE(16, std::uint16_t)
+	RECHARGEABLE_WORD_DATA(16)
 
 	//----------------------------------------------------------------------
 	// 32-bit implementation
@@ -331,14 +465,26 @@ namespace rtl { namespace detail
 	{
 		public:
 
+			/// The type holding the bits
+			typedef std::uint32_t word_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 32;
+
+			/// The number of words in the underlying container
+			static const std::int32_t word_count = 1;
+
+			/// The bits of the last word that are within the collection
+			static const word_type last_word_mask = static_cast<word_type>(~word_type(0));
+
 			/**
-			 * Gets the size of the underlying array.
+			 * Gets the size of the underlying container.
 			 *
-			 * \returns The size of the underlying array.
+			 * \returns The number of words in the underlying container.
 			 */
-			static std::int32_t size()
+			static constexpr std::int32_t size()
 			{
-				return 4;
+				return word_count;
 			}
 
 			/// The container holding the bits
@@ -353,6 +499,52 @@ namespace rtl { namespace detail
 	RECHARGEABLE_IS_BIT_SET(32)
 	RECHARGEABLE_SET_VALUE(32, std::uint32_t)
 	RECHARGEABLE_GET_VALUE(32, std::uint32_t)
+	RECHARGEABLE_WORD_DATA(32)
+
+	//----------------------------------------------------------------------
+	// 64-bit implementation
+	//----------------------------------------------------------------------
+
+	template <>
+	struct bit_set<64>
+	{
+		public:
+
+			/// The type holding the bits
+			typedef std::uint64_t word_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 64;
+
+			/// The number of words in the underlying container
+			static const std::int32_t word_count = 1;
+
+			/// The bits of the last word that are within the collection
+			static const word_type last_word_mask = static_cast<word_type>(~word_type(0));
+
+			/**
+			 * Gets the size of the underlying container.
+			 *
+			 * \returns The number of words in the underlying container.
+			 */
+			static constexpr std::int32_t size()
+			{
+				return word_count;
+			}
+
+			/// The container holding the bits
+			std::uint64_t _bit_array;
+
+	} ; // end struct bit_set<64>
+
+	RECHARGEABLE_CLEAR_BIT_SET(64)
+	RECHARGEABLE_SET_BIT(64)
+	RECHARGEABLE_CLEAR_BIT(64)
+	RECHARGEABLE_TOGGLE_BIT(64)
+	RECHARGEABLE_IS_BIT_SET(64)
+	RECHARGEABLE_SET_VALUE(64, std::uint64_t)
+	RECHARGEABLE_GET_VALUE(64, std::uint64_t)
+	RECHARGEABLE_WORD_DATA(64)
 
 } } // end namespace rtl::detail
 
@@ -0,0 +1,409 @@
+/**
+ * \file bit_set_ops.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_BIT_SET_OPS_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_BIT_SET_OPS_HPP_INCLUDED
+
+#include <rtl/flags/detail/bit_set.hpp>
+#include <rtl/flags/detail/word_ops.hpp>
+
+namespace rtl { namespace detail
+{
+	//----------------------------------------------------------------------
+	// Set algebra
+	//
+	// The operations work on the words of the bit_set. Collections of
+	// 128 bits and up are held in arrays of 64-bit words which are
+	// processed with SIMD instructions when available.
+	//----------------------------------------------------------------------
+
+	/**
+	 * Sets the first count bits and clears the rest.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param set The collection of bits.
+	 * \param count The number of bits to set.
+	 */
+	template <std::int32_t Bits>
+	constexpr void fill_bit_set(bit_set<Bits>& set, std::int32_t count)
+	{
+		RECHARGEABLE_ASSERT((count >= 0) && (count <= Bits), "Invalid count");
+
+		typedef typename bit_set<Bits>::word_type word_type;
+		const std::int32_t word_bits = bit_set<Bits>::word_bits;
+
+		word_type* words = word_data(set);
+
+		for (std::int32_t i = 0; i < bit_set<Bits>::word_count; ++i)
+		{
+			const std::int32_t start = i * word_bits;
+
+			if (count >= start + word_bits)
+				words[i] = static_cast<word_type>(~word_type(0));
+			else if (count > start)
+				words[i] = static_cast<word_type>((word_type(1) << (count - start)) - 1);
+			else
+				words[i] = 0;
+		}
+	}
+
+	/**
+	 * Computes the intersection of two collections.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \returns The bits set in both collections.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits> operator& (const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		bit_set<Bits> result = { };
+		transform_words<and_op>(word_data(result), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return result;
+	}
+
+	/**
+	 * Computes the union of two collections.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \returns The bits set in either collection.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits> operator| (const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		bit_set<Bits> result = { };
+		transform_words<or_op>(word_data(result), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return result;
+	}
+
+	/**
+	 * Computes the symmetric difference of two collections.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \returns The bits set in only one of the collections.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits> operator^ (const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		bit_set<Bits> result = { };
+		transform_words<xor_op>(word_data(result), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return result;
+	}
+
+	/**
+	 * Computes the difference of two collections.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \returns The bits set in lhs that are not set in rhs.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits> andnot(const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		bit_set<Bits> result = { };
+		transform_words<andnot_op>(word_data(result), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return result;
+	}
+
+	/**
+	 * Computes the complement of a collection.
+	 *
+	 * Bits beyond the size of the collection remain cleared.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns The bits not set in the collection.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits> operator~ (const bit_set<Bits>& value)
+	{
+		const std::int32_t count = bit_set<Bits>::word_count;
+
+		bit_set<Bits> result = { };
+		typename bit_set<Bits>::word_type* words = word_data(result);
+
+		not_words(words, word_data(value), count);
+		words[count - 1] &= bit_set<Bits>::last_word_mask;
+
+		return result;
+	}
+
+	/**
+	 * Intersects a collection with another.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The collection to modify.
+	 * \param rhs The collection to intersect with.
+	 * \returns The modified collection.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits>& operator&= (bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		transform_words<and_op>(word_data(lhs), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return lhs;
+	}
+
+	/**
+	 * Unions a collection with another.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The collection to modify.
+	 * \param rhs The collection to union with.
+	 * \returns The modified collection.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits>& operator|= (bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		transform_words<or_op>(word_data(lhs), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return lhs;
+	}
+
+	/**
+	 * Toggles the bits of a collection that are set in another.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The collection to modify.
+	 * \param rhs The bits to toggle.
+	 * \returns The modified collection.
+	 */
+	template <std::int32_t Bits>
+	constexpr bit_set<Bits>& operator^= (bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		transform_words<xor_op>(word_data(lhs), word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+		return lhs;
+	}
+
+	/**
+	 * Determines whether two collections hold the same bits.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the comparison.
+	 * \param rhs The right hand side of the comparison.
+	 * \returns \b true \b if the collections are the same; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool operator== (const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		return !any_words<xor_op>(word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Determines whether two collections hold different bits.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the comparison.
+	 * \param rhs The right hand side of the comparison.
+	 * \returns \b true \b if the collections differ; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool operator!= (const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		return any_words<xor_op>(word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Determines whether two collections have any bits in common.
+	 *
+	 * Equivalent to any(lhs & rhs) without creating the intersection.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \returns \b true \b if the collections intersect; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool intersects(const bit_set<Bits>& lhs, const bit_set<Bits>& rhs)
+	{
+		return any_words<and_op>(word_data(lhs), word_data(rhs), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Determines whether any bits are set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns \b true \b if any bits are set; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool any(const bit_set<Bits>& value)
+	{
+		return any_words(word_data(value), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Determines whether no bits are set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns \b true \b if no bits are set; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool none(const bit_set<Bits>& value)
+	{
+		return !any_words(word_data(value), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Determines whether all bits are set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns \b true \b if all bits are set; \b false \b otherwise.
+	 */
+	template <std::int32_t Bits>
+	constexpr bool all(const bit_set<Bits>& value)
+	{
+		const std::int32_t count = bit_set<Bits>::word_count;
+		const typename bit_set<Bits>::word_type* words = word_data(value);
+
+		return all_words(words, count - 1) && (words[count - 1] == bit_set<Bits>::last_word_mask);
+	}
+
+	/**
+	 * Counts the number of bits set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns The number of bits set.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t count(const bit_set<Bits>& value)
+	{
+		return count_words(word_data(value), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Counts the number of bits set before a location.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \param location The location to count up to. May be Bits.
+	 * \returns The number of bits set before the location.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t rank(const bit_set<Bits>& value, std::int32_t location)
+	{
+		RECHARGEABLE_ASSERT((location >= 0) && (location <= Bits), "Invalid location");
+
+		return rank_words(word_data(value), bit_set<Bits>::word_count, location);
+	}
+
+	/**
+	 * Finds the location of the nth bit set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \param n The zero based index of the set bit.
+	 * \returns The location of the nth bit set, or -1 if fewer bits are set.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t select(const bit_set<Bits>& value, std::int32_t n)
+	{
+		RECHARGEABLE_ASSERT(n >= 0, "Invalid index");
+
+		return select_words(word_data(value), bit_set<Bits>::word_count, n);
+	}
+
+	//----------------------------------------------------------------------
+	// Scanning
+	//----------------------------------------------------------------------
+
+	/**
+	 * Finds the first bit set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns The location of the first bit set, or -1 if no bits are set.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t find_first(const bit_set<Bits>& value)
+	{
+		return find_first_word(word_data(value), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Finds the next bit set after the given location.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \param location The location to search after.
+	 * \returns The location of the next bit set, or -1 if no more bits are set.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t find_next(const bit_set<Bits>& value, std::int32_t location)
+	{
+		RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+		return find_next_word(word_data(value), bit_set<Bits>::word_count, location);
+	}
+
+	/**
+	 * Finds the last bit set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \param value The collection of bits.
+	 * \returns The location of the last bit set, or -1 if no bits are set.
+	 */
+	template <std::int32_t Bits>
+	constexpr std::int32_t find_last(const bit_set<Bits>& value)
+	{
+		return find_last_word(word_data(value), bit_set<Bits>::word_count);
+	}
+
+	/**
+	 * Invokes a function with the location of each bit set.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \tparam Function The type of function to invoke.
+	 * \param value The collection of bits.
+	 * \param function The function to invoke.
+	 */
+	template <std::int32_t Bits, typename Function>
+	inline void for_each_set(const bit_set<Bits>& value, Function function)
+	{
+		for_each_word_bit(word_data(value), bit_set<Bits>::word_count, function);
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_BIT_SET_OPS_HPP_INCLUDED
@@ -66,7 +66,7 @@ namespace rtl { namespace detail
 	 * \param set The collection of bits.
 	 */
 	template <std::int32_t Bits, typename Names>
-	inline void clear_bit_set(bit_union<Bits, Names>& set)
+	constexpr void clear_bit_set(bit_union<Bits, Names>& set)
 	{
 		clear_bit_set(set._rep);
 	}
@@ -80,7 +80,7 @@ namespace rtl { namespace detail
 	 * \param location The bit to set.
 	 */
 	template <std::int32_t Bits, typename Names>
-	inline void set_bit(bit_union<Bits, Names>& set, std::int32_t location)
+	constexpr void set_bit(bit_union<Bits, Names>& set, std::int32_t location)
 	{
 		set_bit(set._rep, location);
 	}
@@ -94,7 +94,7 @@ namespace rtl { namespace detail
 	 * \param location The bit to clear.
 	 */
 	template <std::int32_t Bits, typename Names>
-	inline void clear_bit(bit_union<Bits, Names>& set, std::int32_t location)
+	constexpr void clear_bit(bit_union<Bits, Names>& set, std::int32_t location)
 	{
 		clear_bit(set._rep, location);
 	}
@@ -108,7 +108,7 @@ namespace rtl { namespace detail
 	 * \param location The bit to clear.
 	 */
 	template <std::int32_t Bits, typename Names>
-	inline void toggle_bit(bit_union<Bits, Names>& set, std::int32_t location)
+	constexpr void toggle_bit(bit_union<Bits, Names>& set, std::int32_t location)
 	{
 		toggle_bit(set._rep, location);
 	}
@@ -122,23 +122,51 @@ namespace rtl { namespace detail
 	 * \param location The bit to query.
 	 */
 	template <std::int32_t Bits, typename Names>
-	inline bool is_bit_set(const bit_union<Bits, Names>& set, std::int32_t location)
+	constexpr bool is_bit_set(const bit_union<Bits, Names>& set, std::int32_t location)
 	{
 		return is_bit_set(set._rep, location);
 	}
 
+	/**
+	 * Gets the bit container.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \tparam Names The debug names.
+	 * \param set The collection of bits.
+	 * \returns The underlying collection of bits.
+	 */
+	template <std::int32_t Bits, typename Names>
+	constexpr bit_set<Bits>& bit_container(bit_union<Bits, Names>& set)
+	{
+		return set._rep;
+	}
+
+	/**
+	 * Gets the bit container.
+	 *
+	 * \tparam Bits The number of bits in the container.
+	 * \tparam Names The debug names.
+	 * \param set The collection of bits.
+	 * \returns The underlying collection of bits.
+	 */
+	template <std::int32_t Bits, typename Names>
+	constexpr const bit_set<Bits>& bit_container(const bit_union<Bits, Names>& set)
+	{
+		return set._rep;
+	}
+
 	//----------------------------------------------------------------------
 	// 8-bit implementation
 	//----------------------------------------------------------------------
 
 	template <typename Names>
-	inline void set_bit_values(bit_union<8, Names>& set, std::uint8_t value)
+	constexpr void set_bit_values(bit_union<8, Names>& set, std::uint8_t value)
 	{
 		set_bit_values(set._rep, value);
 	}
 
 	template <typename Names>
-	inline std::uint8_t get_bit_values(const bit_union<8, Names>& set)
+	constexpr std::uint8_t get_bit_values(const bit_union<8, Names>& set)
 	{
 		return get_bit_values(set._rep);
 	}
@@ -148,13 +176,45 @@ namespace rtl { namespace detail
 	//----------------------------------------------------------------------
 
 	template <typename Names>
-	inline void set_bit_values(bit_union<16, Names>& set, std::uint16_t value)
+	constexpr void set_bit_values(bit_union<16, Names>& set, std::uint16_t value)
+	{
+		set_bit_values(set._rep, value);
+	}
+
+	template <typename Names>
+	constexpr std::uint16_t get_bit_values(const bit_union<16, Names>& set)
+	{
+		return get_bit_values(set._rep);
+	}
+
+	//----------------------------------------------------------------------
+	// 32-bit implementation
+	//----------------------------------------------------------------------
+
+	template <typename Names>
+	constexpr void set_bit_values(bit_union<32, Names>& set, std::uint32_t value)
+	{
+		set_bit_values(set._rep, value);
+	}
+
+	template <typename Names>
+	constexpr std::uint32_t get_bit_values(const bit_union<32, Names>& set)
+	{
+		return get_bit_values(set._rep);
+	}
+
+	//----------------------------------------------------------------------
+	// 64-bit implementation
+	//----------------------------------------------------------------------
+
+	template <typename Names>
+	constexpr void set_bit_values(bit_union<64, Names>& set, std::uint64_t value)
 	{
 		set_bit_values(set._rep, value);
 	}
 
 	template <typename Names>
-	inline std::uint16_t get_bit_values(const bit_union<16, Names>& set)
+	constexpr std::uint64_t get_bit_values(const bit_union<64, Names>& set)
 	{
 		return get_bit_values(set._rep);
 	}
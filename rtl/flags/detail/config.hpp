@@ -61,4 +61,56 @@
 
 #endif
 
+//----------------------------------------------------------------------
+// Constant evaluation
+//
+// The bit operations are constexpr. When the compiler can report that
+// a function is being evaluated at compile time the SIMD paths are
+// skipped during constant evaluation.
+//----------------------------------------------------------------------
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define RECHARGEABLE_HAS_IS_CONSTANT_EVALUATED
+#endif
+#endif
+
+#if !defined(RECHARGEABLE_HAS_IS_CONSTANT_EVALUATED)
+#if (defined(__GNUC__) && (__GNUC__ >= 9)) || (defined(_MSC_VER) && (_MSC_VER >= 1925))
+#define RECHARGEABLE_HAS_IS_CONSTANT_EVALUATED
+#endif
+#endif
+
+#ifdef RECHARGEABLE_HAS_IS_CONSTANT_EVALUATED
+#define RECHARGEABLE_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define RECHARGEABLE_IS_CONSTANT_EVALUATED() true
+#endif
+
+//----------------------------------------------------------------------
+// SIMD configuration
+//
+// The instruction sets are chosen at compile time from the flags the
+// compiler was invoked with. Defining RECHARGEABLE_NO_SIMD forces the
+// scalar implementations, as does a compiler that cannot detect
+// constant evaluation.
+//----------------------------------------------------------------------
+
+#if !defined(RECHARGEABLE_NO_SIMD) && defined(RECHARGEABLE_HAS_IS_CONSTANT_EVALUATED)
+
+#if defined(__AVX2__)
+#define RECHARGEABLE_USE_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RECHARGEABLE_USE_SSE2
+#endif
+
+// MSVC does not report BMI2 but every AVX2 target supports it
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define RECHARGEABLE_USE_BMI2
+#endif
+
+#endif
+
 #endif // end RECHARGEABLE_FLAGS_DETAIL_CONFIG_HPP_INCLUDED
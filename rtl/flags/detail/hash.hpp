@@ -0,0 +1,127 @@
+/**
+ * \file hash.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_HASH_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_HASH_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rtl { namespace detail
+{
+	/// The FNV-1a 64-bit offset basis
+	const std::uint64_t fnv1a_basis = 0xcbf29ce484222325ull;
+	/// The FNV-1a 64-bit prime
+	const std::uint64_t fnv1a_prime = 0x100000001b3ull;
+
+	/**
+	 * Hashes a string using 64-bit FNV-1a.
+	 *
+	 * \param text The null terminated string to hash.
+	 * \param hash The hash to continue from.
+	 * \returns The hash of the string.
+	 */
+	constexpr std::uint64_t fnv1a(const char* text, std::uint64_t hash = fnv1a_basis)
+	{
+		while (*text != '\0')
+		{
+			hash ^= static_cast<std::uint8_t>(*text++);
+			hash *= fnv1a_prime;
+		}
+
+		return hash;
+	}
+
+	/**
+	 * Hashes a range of characters using 64-bit FNV-1a.
+	 *
+	 * \param text The characters to hash.
+	 * \param length The number of characters.
+	 * \param hash The hash to continue from.
+	 * \returns The hash of the characters.
+	 */
+	constexpr std::uint64_t fnv1a(const char* text, std::size_t length, std::uint64_t hash)
+	{
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			hash ^= static_cast<std::uint8_t>(text[i]);
+			hash *= fnv1a_prime;
+		}
+
+		return hash;
+	}
+
+	/**
+	 * Mixes the bits of a hash so every output bit depends on every input bit.
+	 *
+	 * \param hash The hash to mix.
+	 * \returns The mixed hash.
+	 */
+	constexpr std::uint64_t mix_hash(std::uint64_t hash)
+	{
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ull;
+		hash ^= hash >> 33;
+
+		return hash;
+	}
+
+	/**
+	 * Hashes the bytes of an integer using 64-bit FNV-1a.
+	 *
+	 * The bytes are hashed in little endian order regardless of the host.
+	 *
+	 * \param value The value to hash.
+	 * \param hash The hash to continue from.
+	 * \returns The hash of the value.
+	 */
+	constexpr std::uint64_t fnv1a_value(std::uint64_t value, std::uint64_t hash = fnv1a_basis)
+	{
+		for (std::int32_t i = 0; i < 8; ++i)
+		{
+			hash ^= static_cast<std::uint8_t>(value >> (i * 8));
+			hash *= fnv1a_prime;
+		}
+
+		return hash;
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_HASH_HPP_INCLUDED
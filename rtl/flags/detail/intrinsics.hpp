@@ -0,0 +1,201 @@
+/**
+ * \file intrinsics.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_INTRINSICS_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_INTRINSICS_HPP_INCLUDED
+
+#include <rtl/flags/detail/config.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(RECHARGEABLE_USE_BMI2)
+#include <immintrin.h>
+#endif
+
+namespace rtl { namespace detail
+{
+	//----------------------------------------------------------------------
+	// Population count
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the number of bits set within a word.
+	 *
+	 * \param value The word to count.
+	 * \returns The number of bits set.
+	 */
+	constexpr std::int32_t popcount(std::uint64_t value)
+	{
+	#if defined(__GNUC__)
+		return __builtin_popcountll(value);
+	#else
+	#if defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+			return static_cast<std::int32_t>(__popcnt64(value));
+	#endif
+
+		value = value - ((value >> 1) & 0x5555555555555555ull);
+		value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+		value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+		return static_cast<std::int32_t>((value * 0x0101010101010101ull) >> 56);
+	#endif
+	}
+
+	//----------------------------------------------------------------------
+	// Bit scanning
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the number of trailing zero bits within a word.
+	 *
+	 * \param value The word to scan. Must not be zero.
+	 * \returns The index of the lowest set bit.
+	 */
+	constexpr std::int32_t count_trailing_zeros(std::uint64_t value)
+	{
+		RECHARGEABLE_ASSERT(value != 0, "Value must not be zero");
+
+	#if defined(__GNUC__)
+		return __builtin_ctzll(value);
+	#else
+	#if defined(_MSC_VER) && defined(_M_X64)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+		{
+			unsigned long index = 0;
+			_BitScanForward64(&index, value);
+			return static_cast<std::int32_t>(index);
+		}
+	#endif
+
+		std::int32_t count = 0;
+
+		while ((value & 1) == 0)
+		{
+			value >>= 1;
+			++count;
+		}
+
+		return count;
+	#endif
+	}
+
+	/**
+	 * Counts the number of leading zero bits within a word.
+	 *
+	 * \param value The word to scan. Must not be zero.
+	 * \returns The number of zero bits above the highest set bit.
+	 */
+	constexpr std::int32_t count_leading_zeros(std::uint64_t value)
+	{
+		RECHARGEABLE_ASSERT(value != 0, "Value must not be zero");
+
+	#if defined(__GNUC__)
+		return __builtin_clzll(value);
+	#else
+	#if defined(_MSC_VER) && defined(_M_X64)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+		{
+			unsigned long index = 0;
+			_BitScanReverse64(&index, value);
+			return 63 - static_cast<std::int32_t>(index);
+		}
+	#endif
+
+		std::int32_t count = 0;
+
+		while ((value & 0x8000000000000000ull) == 0)
+		{
+			value <<= 1;
+			++count;
+		}
+
+		return count;
+	#endif
+	}
+
+	//----------------------------------------------------------------------
+	// Selection
+	//----------------------------------------------------------------------
+
+	/**
+	 * Finds the location of the nth bit set within a word.
+	 *
+	 * With BMI2 the bit is deposited into place with pdep. Otherwise the
+	 * byte holding the bit is found from the running byte counts of a
+	 * population count and the bit is found within that byte.
+	 *
+	 * \param value The word to search.
+	 * \param n The zero based index of the set bit. Must be less than popcount(value).
+	 * \returns The location of the nth bit set.
+	 */
+	constexpr std::int32_t select_bit(std::uint64_t value, std::int32_t n)
+	{
+		RECHARGEABLE_ASSERT((n >= 0) && (n < popcount(value)), "Invalid index");
+
+	#if defined(RECHARGEABLE_USE_BMI2)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+			return count_trailing_zeros(_pdep_u64(std::uint64_t(1) << n, value));
+	#endif
+
+		std::uint64_t counts = value - ((value >> 1) & 0x5555555555555555ull);
+		counts = (counts & 0x3333333333333333ull) + ((counts >> 2) & 0x3333333333333333ull);
+		counts = (counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+		// Byte i holds the number of bits set in bytes 0 through i
+		counts *= 0x0101010101010101ull;
+
+		std::int32_t shift = 0;
+		std::int32_t before = 0;
+
+		while (static_cast<std::int32_t>((counts >> shift) & 0xff) <= n)
+		{
+			before = static_cast<std::int32_t>((counts >> shift) & 0xff);
+			shift += 8;
+		}
+
+		std::uint32_t byte = static_cast<std::uint32_t>(value >> shift) & 0xff;
+
+		for (n -= before; n > 0; --n)
+			byte &= byte - 1;
+
+		return shift + count_trailing_zeros(byte);
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_INTRINSICS_HPP_INCLUDED
@@ -0,0 +1,788 @@
+/**
+ * \file roaring_container.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_ROARING_CONTAINER_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_ROARING_CONTAINER_HPP_INCLUDED
+
+#include <rtl/flags/detail/word_ops.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace rtl { namespace detail
+{
+	//----------------------------------------------------------------------
+	// Container
+	//----------------------------------------------------------------------
+
+	/// The largest number of values held in an array container
+	const std::int32_t roaring_array_limit = 4096;
+	/// The number of words in a bitmap container
+	const std::int32_t roaring_bitmap_words = 1024;
+
+	/**
+	 * Holds the values of a compressed_bitmap that share the upper 16 bits.
+	 *
+	 * A container is stored in one of three ways depending on what is
+	 * smallest for the values it holds.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	struct roaring_container
+	{
+		/// The representation of the container
+		enum type_id
+		{
+			/// Sorted array of the lower 16 bits
+			array_type,
+			/// Bitmap of 65536 bits
+			bitmap_type,
+			/// Sorted (start, length - 1) pairs
+			run_type
+		} ;
+
+		roaring_container()
+		: key(0)
+		, type(array_type)
+		, cardinality(0)
+		{ }
+
+		/// The upper 16 bits of the values
+		std::uint16_t key;
+		/// The representation of the container
+		std::uint8_t type;
+		/// The number of values held
+		std::int32_t cardinality;
+		/// Values for array containers or pairs for run containers
+		std::vector<std::uint16_t> values;
+		/// Words for bitmap containers
+		std::vector<std::uint64_t> words;
+
+	} ; // end struct roaring_container
+
+	//----------------------------------------------------------------------
+	// Bitmap helpers
+	//----------------------------------------------------------------------
+
+	/**
+	 * Sets the bits within an inclusive range.
+	 *
+	 * \param words The bitmap.
+	 * \param first The first bit to set.
+	 * \param last The last bit to set.
+	 */
+	inline void set_bitmap_range(std::uint64_t* words, std::int32_t first, std::int32_t last)
+	{
+		const std::int32_t firstWord = first >> 6;
+		const std::int32_t lastWord = last >> 6;
+
+		const std::uint64_t firstMask = ~std::uint64_t(0) << (first & 63);
+		const std::uint64_t lastMask = ~std::uint64_t(0) >> (63 - (last & 63));
+
+		if (firstWord == lastWord)
+		{
+			words[firstWord] |= firstMask & lastMask;
+			return;
+		}
+
+		words[firstWord] |= firstMask;
+
+		for (std::int32_t i = firstWord + 1; i < lastWord; ++i)
+			words[i] = ~std::uint64_t(0);
+
+		words[lastWord] |= lastMask;
+	}
+
+	/**
+	 * Clears the bits within an inclusive range.
+	 *
+	 * \param words The bitmap.
+	 * \param first The first bit to clear.
+	 * \param last The last bit to clear.
+	 */
+	inline void clear_bitmap_range(std::uint64_t* words, std::int32_t first, std::int32_t last)
+	{
+		const std::int32_t firstWord = first >> 6;
+		const std::int32_t lastWord = last >> 6;
+
+		const std::uint64_t firstMask = ~std::uint64_t(0) << (first & 63);
+		const std::uint64_t lastMask = ~std::uint64_t(0) >> (63 - (last & 63));
+
+		if (firstWord == lastWord)
+		{
+			words[firstWord] &= ~(firstMask & lastMask);
+			return;
+		}
+
+		words[firstWord] &= ~firstMask;
+
+		for (std::int32_t i = firstWord + 1; i < lastWord; ++i)
+			words[i] = 0;
+
+		words[lastWord] &= ~lastMask;
+	}
+
+	//----------------------------------------------------------------------
+	// Conversion
+	//----------------------------------------------------------------------
+
+	/**
+	 * Writes the values of a container into a bitmap.
+	 *
+	 * \param container The container.
+	 * \param words The bitmap of roaring_bitmap_words words to write to.
+	 */
+	inline void roaring_to_bitmap(const roaring_container& container, std::uint64_t* words)
+	{
+		if (container.type == roaring_container::bitmap_type)
+		{
+			std::copy(container.words.begin(), container.words.end(), words);
+			return;
+		}
+
+		std::fill(words, words + roaring_bitmap_words, std::uint64_t(0));
+
+		if (container.type == roaring_container::array_type)
+		{
+			for (std::size_t i = 0; i < container.values.size(); ++i)
+				words[container.values[i] >> 6] |= std::uint64_t(1) << (container.values[i] & 63);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < container.values.size(); i += 2)
+				set_bitmap_range(words, container.values[i], container.values[i] + container.values[i + 1]);
+		}
+	}
+
+	/**
+	 * Fills a container from a bitmap.
+	 *
+	 * An array is used when the values fit, otherwise a bitmap.
+	 *
+	 * \param container The container to fill.
+	 * \param words The bitmap of roaring_bitmap_words words.
+	 */
+	inline void roaring_from_bitmap(roaring_container& container, const std::uint64_t* words)
+	{
+		container.cardinality = count_words(words, roaring_bitmap_words);
+		container.values.clear();
+		std::vector<std::uint64_t>().swap(container.words);
+
+		if (container.cardinality <= roaring_array_limit)
+		{
+			container.type = roaring_container::array_type;
+			container.values.reserve(container.cardinality);
+
+			for (std::int32_t i = 0; i < roaring_bitmap_words; ++i)
+			{
+				std::uint64_t word = words[i];
+
+				while (word != 0)
+				{
+					container.values.push_back(static_cast<std::uint16_t>((i << 6) + count_trailing_zeros(word)));
+					word &= word - 1;
+				}
+			}
+		}
+		else
+		{
+			container.type = roaring_container::bitmap_type;
+			container.words.assign(words, words + roaring_bitmap_words);
+		}
+	}
+
+	/**
+	 * Converts a run container into an array or bitmap container.
+	 *
+	 * \param container The container to convert.
+	 */
+	inline void roaring_expand(roaring_container& container)
+	{
+		if (container.type != roaring_container::run_type)
+			return;
+
+		std::uint64_t words[roaring_bitmap_words];
+
+		roaring_to_bitmap(container, words);
+		roaring_from_bitmap(container, words);
+	}
+
+	/**
+	 * Counts the runs of consecutive values in a container.
+	 *
+	 * \param container The container.
+	 * \returns The number of runs.
+	 */
+	inline std::int32_t roaring_run_count(const roaring_container& container)
+	{
+		if (container.type == roaring_container::run_type)
+			return static_cast<std::int32_t>(container.values.size() / 2);
+
+		std::int32_t runs = 0;
+
+		if (container.type == roaring_container::array_type)
+		{
+			for (std::size_t i = 0; i < container.values.size(); ++i)
+			{
+				if ((i == 0) || (container.values[i] != container.values[i - 1] + 1))
+					++runs;
+			}
+		}
+		else
+		{
+			// A run starts at each set bit whose predecessor is clear
+			std::uint64_t carry = 0;
+
+			for (std::int32_t i = 0; i < roaring_bitmap_words; ++i)
+			{
+				const std::uint64_t word = container.words[i];
+
+				runs += popcount(word & ~((word << 1) | carry));
+				carry = word >> 63;
+			}
+		}
+
+		return runs;
+	}
+
+	//----------------------------------------------------------------------
+	// Queries
+	//----------------------------------------------------------------------
+
+	/**
+	 * Determines whether a container holds a value.
+	 *
+	 * \param container The container.
+	 * \param value The lower 16 bits of the value.
+	 * \returns \b true \b if the value is held; \b false \b otherwise.
+	 */
+	inline bool roaring_contains(const roaring_container& container, std::uint16_t value)
+	{
+		switch (container.type)
+		{
+			case roaring_container::array_type:
+				return std::binary_search(container.values.begin(), container.values.end(), value);
+
+			case roaring_container::bitmap_type:
+				return ((container.words[value >> 6] >> (value & 63)) & 1) != 0;
+
+			default:
+			{
+				// Find the last run starting at or before the value
+				std::int32_t low = 0;
+				std::int32_t high = static_cast<std::int32_t>(container.values.size() / 2);
+
+				while (low < high)
+				{
+					const std::int32_t middle = (low + high) / 2;
+
+					if (container.values[middle * 2] <= value)
+						low = middle + 1;
+					else
+						high = middle;
+				}
+
+				if (low == 0)
+					return false;
+
+				const std::int32_t start = container.values[(low - 1) * 2];
+				const std::int32_t length = container.values[(low - 1) * 2 + 1];
+
+				return value <= start + length;
+			}
+		}
+	}
+
+	/**
+	 * Invokes a function for each value in a container.
+	 *
+	 * \tparam Function The type of function. Called with the lower 16 bits as an int32.
+	 * \param container The container.
+	 * \param function The function to invoke.
+	 */
+	template <typename Function>
+	inline void for_each_roaring(const roaring_container& container, Function function)
+	{
+		switch (container.type)
+		{
+			case roaring_container::array_type:
+				for (std::size_t i = 0; i < container.values.size(); ++i)
+					function(static_cast<std::int32_t>(container.values[i]));
+				break;
+
+			case roaring_container::bitmap_type:
+				for_each_word_bit(&container.words[0], roaring_bitmap_words, function);
+				break;
+
+			default:
+				for (std::size_t i = 0; i < container.values.size(); i += 2)
+				{
+					const std::int32_t start = container.values[i];
+					const std::int32_t last = start + container.values[i + 1];
+
+					for (std::int32_t value = start; value <= last; ++value)
+						function(value);
+				}
+				break;
+		}
+	}
+
+	//----------------------------------------------------------------------
+	// Representation
+	//----------------------------------------------------------------------
+
+	/**
+	 * Chooses the smallest representation for a container.
+	 *
+	 * \param container The container to convert.
+	 */
+	inline void roaring_optimize(roaring_container& container)
+	{
+		const std::int32_t runs = roaring_run_count(container);
+
+		const std::int32_t runBytes = runs * 4;
+		const std::int32_t otherBytes = (container.cardinality <= roaring_array_limit)
+			? container.cardinality * 2
+			: roaring_bitmap_words * 8;
+
+		if (runBytes < otherBytes)
+		{
+			if (container.type == roaring_container::run_type)
+				return;
+
+			std::vector<std::uint16_t> pairs;
+			pairs.reserve(runs * 2);
+
+			std::int32_t start = -1;
+			std::int32_t previous = -2;
+
+			for_each_roaring(container, [&](std::int32_t value)
+			{
+				if (value != previous + 1)
+				{
+					if (start >= 0)
+					{
+						pairs.push_back(static_cast<std::uint16_t>(start));
+						pairs.push_back(static_cast<std::uint16_t>(previous - start));
+					}
+
+					start = value;
+				}
+
+				previous = value;
+			});
+
+			pairs.push_back(static_cast<std::uint16_t>(start));
+			pairs.push_back(static_cast<std::uint16_t>(previous - start));
+
+			container.type = roaring_container::run_type;
+			container.values.swap(pairs);
+			std::vector<std::uint64_t>().swap(container.words);
+		}
+		else
+		{
+			roaring_expand(container);
+		}
+	}
+
+	//----------------------------------------------------------------------
+	// Modification
+	//----------------------------------------------------------------------
+
+	/**
+	 * Adds a value to a container.
+	 *
+	 * Run containers are expanded before being modified.
+	 *
+	 * \param container The container.
+	 * \param value The lower 16 bits of the value.
+	 * \returns \b true \b if the value was added; \b false \b if already present.
+	 */
+	inline bool roaring_add(roaring_container& container, std::uint16_t value)
+	{
+		roaring_expand(container);
+
+		if (container.type == roaring_container::array_type)
+		{
+			std::vector<std::uint16_t>::iterator position = std::lower_bound(container.values.begin(), container.values.end(), value);
+
+			if ((position != container.values.end()) && (*position == value))
+				return false;
+
+			if (container.cardinality == roaring_array_limit)
+			{
+				std::uint64_t words[roaring_bitmap_words];
+
+				roaring_to_bitmap(container, words);
+				words[value >> 6] |= std::uint64_t(1) << (value & 63);
+				roaring_from_bitmap(container, words);
+
+				return true;
+			}
+
+			container.values.insert(position, value);
+		}
+		else
+		{
+			std::uint64_t& word = container.words[value >> 6];
+			const std::uint64_t mask = std::uint64_t(1) << (value & 63);
+
+			if (word & mask)
+				return false;
+
+			word |= mask;
+		}
+
+		++container.cardinality;
+
+		return true;
+	}
+
+	/**
+	 * Removes a value from a container.
+	 *
+	 * \param container The container.
+	 * \param value The lower 16 bits of the value.
+	 * \returns \b true \b if the value was removed; \b false \b if not present.
+	 */
+	inline bool roaring_remove(roaring_container& container, std::uint16_t value)
+	{
+		if (!roaring_contains(container, value))
+			return false;
+
+		roaring_expand(container);
+
+		if (container.type == roaring_container::array_type)
+		{
+			container.values.erase(std::lower_bound(container.values.begin(), container.values.end(), value));
+			--container.cardinality;
+		}
+		else
+		{
+			container.words[value >> 6] &= ~(std::uint64_t(1) << (value & 63));
+
+			if (--container.cardinality <= roaring_array_limit)
+			{
+				std::uint64_t words[roaring_bitmap_words];
+
+				roaring_to_bitmap(container, words);
+				roaring_from_bitmap(container, words);
+			}
+		}
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------
+	// Set operations
+	//----------------------------------------------------------------------
+
+	/**
+	 * Merges the runs of two run containers.
+	 *
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param intersect Whether to intersect rather than unite the runs.
+	 * \param result The container to write to.
+	 */
+	inline void roaring_merge_runs(const roaring_container& lhs, const roaring_container& rhs, bool intersect, roaring_container& result)
+	{
+		std::vector<std::uint16_t> pairs;
+		std::int32_t cardinality = 0;
+
+		std::size_t i = 0;
+		std::size_t j = 0;
+
+		std::int32_t currentStart = -1;
+		std::int32_t currentLast = -1;
+
+		while ((i < lhs.values.size()) && (j < rhs.values.size()))
+		{
+			const std::int32_t lhsStart = lhs.values[i];
+			const std::int32_t lhsLast = lhsStart + lhs.values[i + 1];
+			const std::int32_t rhsStart = rhs.values[j];
+			const std::int32_t rhsLast = rhsStart + rhs.values[j + 1];
+
+			std::int32_t start;
+			std::int32_t last;
+
+			if (intersect)
+			{
+				start = std::max(lhsStart, rhsStart);
+				last = std::min(lhsLast, rhsLast);
+
+				if (lhsLast < rhsLast)
+					i += 2;
+				else
+					j += 2;
+
+				if (start > last)
+					continue;
+			}
+			else if (lhsStart <= rhsStart)
+			{
+				start = lhsStart;
+				last = lhsLast;
+				i += 2;
+			}
+			else
+			{
+				start = rhsStart;
+				last = rhsLast;
+				j += 2;
+			}
+
+			if ((currentStart >= 0) && (start <= currentLast + 1))
+			{
+				currentLast = std::max(currentLast, last);
+				continue;
+			}
+
+			if (currentStart >= 0)
+			{
+				pairs.push_back(static_cast<std::uint16_t>(currentStart));
+				pairs.push_back(static_cast<std::uint16_t>(currentLast - currentStart));
+				cardinality += currentLast - currentStart + 1;
+			}
+
+			currentStart = start;
+			currentLast = last;
+		}
+
+		if (!intersect)
+		{
+			// Append the remaining runs of whichever side is left
+			const roaring_container& rest = (i < lhs.values.size()) ? lhs : rhs;
+			std::size_t k = (i < lhs.values.size()) ? i : j;
+
+			for (; k < rest.values.size(); k += 2)
+			{
+				const std::int32_t start = rest.values[k];
+				const std::int32_t last = start + rest.values[k + 1];
+
+				if ((currentStart >= 0) && (start <= currentLast + 1))
+				{
+					currentLast = std::max(currentLast, last);
+					continue;
+				}
+
+				if (currentStart >= 0)
+				{
+					pairs.push_back(static_cast<std::uint16_t>(currentStart));
+					pairs.push_back(static_cast<std::uint16_t>(currentLast - currentStart));
+					cardinality += currentLast - currentStart + 1;
+				}
+
+				currentStart = start;
+				currentLast = last;
+			}
+		}
+
+		if (currentStart >= 0)
+		{
+			pairs.push_back(static_cast<std::uint16_t>(currentStart));
+			pairs.push_back(static_cast<std::uint16_t>(currentLast - currentStart));
+			cardinality += currentLast - currentStart + 1;
+		}
+
+		result.type = roaring_container::run_type;
+		result.cardinality = cardinality;
+		result.values.swap(pairs);
+		std::vector<std::uint64_t>().swap(result.words);
+	}
+
+	/**
+	 * Computes the union of two containers.
+	 *
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param result The container to write to.
+	 */
+	inline void roaring_union(const roaring_container& lhs, const roaring_container& rhs, roaring_container& result)
+	{
+		result.key = lhs.key;
+
+		if ((lhs.type == roaring_container::run_type) && (rhs.type == roaring_container::run_type))
+		{
+			roaring_merge_runs(lhs, rhs, false, result);
+			return;
+		}
+
+		if ((lhs.type == roaring_container::array_type) && (rhs.type == roaring_container::array_type) && (lhs.cardinality + rhs.cardinality <= roaring_array_limit))
+		{
+			std::vector<std::uint16_t> values;
+			values.reserve(lhs.values.size() + rhs.values.size());
+
+			std::set_union(lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end(), std::back_inserter(values));
+
+			result.type = roaring_container::array_type;
+			result.cardinality = static_cast<std::int32_t>(values.size());
+			result.values.swap(values);
+			std::vector<std::uint64_t>().swap(result.words);
+			return;
+		}
+
+		std::uint64_t words[roaring_bitmap_words];
+		roaring_to_bitmap(lhs, words);
+
+		if (rhs.type == roaring_container::bitmap_type)
+		{
+			transform_words<or_op>(words, words, &rhs.words[0], roaring_bitmap_words);
+		}
+		else if (rhs.type == roaring_container::array_type)
+		{
+			for (std::size_t i = 0; i < rhs.values.size(); ++i)
+				words[rhs.values[i] >> 6] |= std::uint64_t(1) << (rhs.values[i] & 63);
+		}
+		else
+		{
+			for (std::size_t i = 0; i < rhs.values.size(); i += 2)
+				set_bitmap_range(words, rhs.values[i], rhs.values[i] + rhs.values[i + 1]);
+		}
+
+		roaring_from_bitmap(result, words);
+	}
+
+	/**
+	 * Computes the intersection of two containers.
+	 *
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param result The container to write to. Its cardinality may be zero.
+	 */
+	inline void roaring_intersection(const roaring_container& lhs, const roaring_container& rhs, roaring_container& result)
+	{
+		result.key = lhs.key;
+
+		if ((lhs.type == roaring_container::run_type) && (rhs.type == roaring_container::run_type))
+		{
+			roaring_merge_runs(lhs, rhs, true, result);
+			return;
+		}
+
+		if ((lhs.type == roaring_container::array_type) || (rhs.type == roaring_container::array_type))
+		{
+			std::vector<std::uint16_t> values;
+
+			if ((lhs.type == roaring_container::array_type) && (rhs.type == roaring_container::array_type))
+			{
+				std::set_intersection(lhs.values.begin(), lhs.values.end(), rhs.values.begin(), rhs.values.end(), std::back_inserter(values));
+			}
+			else
+			{
+				// Filter the array by the other container
+				const roaring_container& array = (lhs.type == roaring_container::array_type) ? lhs : rhs;
+				const roaring_container& other = (lhs.type == roaring_container::array_type) ? rhs : lhs;
+
+				for (std::size_t i = 0; i < array.values.size(); ++i)
+				{
+					if (roaring_contains(other, array.values[i]))
+						values.push_back(array.values[i]);
+				}
+			}
+
+			result.type = roaring_container::array_type;
+			result.cardinality = static_cast<std::int32_t>(values.size());
+			result.values.swap(values);
+			std::vector<std::uint64_t>().swap(result.words);
+			return;
+		}
+
+		std::uint64_t lhsWords[roaring_bitmap_words];
+		std::uint64_t rhsWords[roaring_bitmap_words];
+
+		roaring_to_bitmap(lhs, lhsWords);
+		roaring_to_bitmap(rhs, rhsWords);
+
+		transform_words<and_op>(lhsWords, lhsWords, rhsWords, roaring_bitmap_words);
+
+		roaring_from_bitmap(result, lhsWords);
+	}
+
+	/**
+	 * Computes the values in one container that are not in another.
+	 *
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The values to remove.
+	 * \param result The container to write to. Its cardinality may be zero.
+	 */
+	inline void roaring_difference(const roaring_container& lhs, const roaring_container& rhs, roaring_container& result)
+	{
+		result.key = lhs.key;
+
+		if (lhs.type == roaring_container::array_type)
+		{
+			std::vector<std::uint16_t> values;
+
+			for (std::size_t i = 0; i < lhs.values.size(); ++i)
+			{
+				if (!roaring_contains(rhs, lhs.values[i]))
+					values.push_back(lhs.values[i]);
+			}
+
+			result.type = roaring_container::array_type;
+			result.cardinality = static_cast<std::int32_t>(values.size());
+			result.values.swap(values);
+			std::vector<std::uint64_t>().swap(result.words);
+			return;
+		}
+
+		std::uint64_t words[roaring_bitmap_words];
+		roaring_to_bitmap(lhs, words);
+
+		if (rhs.type == roaring_container::bitmap_type)
+		{
+			transform_words<andnot_op>(words, words, &rhs.words[0], roaring_bitmap_words);
+		}
+		else if (rhs.type == roaring_container::array_type)
+		{
+			for (std::size_t i = 0; i < rhs.values.size(); ++i)
+				words[rhs.values[i] >> 6] &= ~(std::uint64_t(1) << (rhs.values[i] & 63));
+		}
+		else
+		{
+			for (std::size_t i = 0; i < rhs.values.size(); i += 2)
+				clear_bitmap_range(words, rhs.values[i], rhs.values[i] + rhs.values[i + 1]);
+		}
+
+		roaring_from_bitmap(result, words);
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_ROARING_CONTAINER_HPP_INCLUDED
@@ -0,0 +1,107 @@
+/**
+ * \file varint.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_VARINT_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_VARINT_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rtl { namespace detail
+{
+	/// The largest number of bytes used to encode a 64-bit varint
+	const std::size_t max_varint_size = 10;
+
+	/**
+	 * Gets the number of bytes used to encode a varint.
+	 *
+	 * \param value The value to encode.
+	 * \returns The encoded size.
+	 */
+	constexpr std::size_t varint_size(std::uint64_t value)
+	{
+		return (value < 0x80) ? 1 : 1 + varint_size(value >> 7);
+	}
+
+	/**
+	 * Writes a value as a little endian base 128 varint.
+	 *
+	 * \param out The buffer to write to.
+	 * \param value The value to write.
+	 * \returns The position after the written bytes.
+	 */
+	inline std::uint8_t* write_varint(std::uint8_t* out, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			*out++ = static_cast<std::uint8_t>(value | 0x80);
+			value >>= 7;
+		}
+
+		*out++ = static_cast<std::uint8_t>(value);
+
+		return out;
+	}
+
+	/**
+	 * Reads a little endian base 128 varint.
+	 *
+	 * \param in The buffer to read from.
+	 * \param end The end of the buffer.
+	 * \param value The value read.
+	 * \returns The position after the read bytes, or nullptr if the varint is malformed.
+	 */
+	inline const std::uint8_t* read_varint(const std::uint8_t* in, const std::uint8_t* end, std::uint64_t& value)
+	{
+		value = 0;
+
+		for (std::int32_t shift = 0; (in != end) && (shift < 64); shift += 7)
+		{
+			const std::uint8_t byte = *in++;
+
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+			if ((byte & 0x80) == 0)
+				return in;
+		}
+
+		return nullptr;
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_VARINT_HPP_INCLUDED
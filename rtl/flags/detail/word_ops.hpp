@@ -0,0 +1,539 @@
+/**
+ * \file word_ops.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DETAIL_WORD_OPS_HPP_INCLUDED
+#define RECHARGEABLE_DETAIL_WORD_OPS_HPP_INCLUDED
+
+#include <rtl/flags/detail/intrinsics.hpp>
+
+#if defined(RECHARGEABLE_USE_AVX2)
+#include <immintrin.h>
+#elif defined(RECHARGEABLE_USE_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace rtl { namespace detail
+{
+	//----------------------------------------------------------------------
+	// Word operations
+	//
+	// Each operation provides a scalar implementation along with SSE2
+	// and AVX2 implementations which are used on arrays of 64-bit words
+	// when the instruction set is available.
+	//----------------------------------------------------------------------
+
+	/// Computes lhs & rhs
+	struct and_op
+	{
+		template <typename Word>
+		static constexpr Word apply(Word lhs, Word rhs) { return lhs & rhs; }
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		static __m128i apply(__m128i lhs, __m128i rhs) { return _mm_and_si128(lhs, rhs); }
+	#endif
+	#if defined(RECHARGEABLE_USE_AVX2)
+		static __m256i apply(__m256i lhs, __m256i rhs) { return _mm256_and_si256(lhs, rhs); }
+	#endif
+	} ;
+
+	/// Computes lhs | rhs
+	struct or_op
+	{
+		template <typename Word>
+		static constexpr Word apply(Word lhs, Word rhs) { return lhs | rhs; }
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		static __m128i apply(__m128i lhs, __m128i rhs) { return _mm_or_si128(lhs, rhs); }
+	#endif
+	#if defined(RECHARGEABLE_USE_AVX2)
+		static __m256i apply(__m256i lhs, __m256i rhs) { return _mm256_or_si256(lhs, rhs); }
+	#endif
+	} ;
+
+	/// Computes lhs ^ rhs
+	struct xor_op
+	{
+		template <typename Word>
+		static constexpr Word apply(Word lhs, Word rhs) { return lhs ^ rhs; }
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		static __m128i apply(__m128i lhs, __m128i rhs) { return _mm_xor_si128(lhs, rhs); }
+	#endif
+	#if defined(RECHARGEABLE_USE_AVX2)
+		static __m256i apply(__m256i lhs, __m256i rhs) { return _mm256_xor_si256(lhs, rhs); }
+	#endif
+	} ;
+
+	/// Computes lhs & ~rhs
+	struct andnot_op
+	{
+		template <typename Word>
+		static constexpr Word apply(Word lhs, Word rhs) { return lhs & ~rhs; }
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		static __m128i apply(__m128i lhs, __m128i rhs) { return _mm_andnot_si128(rhs, lhs); }
+	#endif
+	#if defined(RECHARGEABLE_USE_AVX2)
+		static __m256i apply(__m256i lhs, __m256i rhs) { return _mm256_andnot_si256(rhs, lhs); }
+	#endif
+	} ;
+
+	//----------------------------------------------------------------------
+	// Transforms
+	//----------------------------------------------------------------------
+
+	/**
+	 * Combines two arrays of words.
+	 *
+	 * The result can be the same array as either of the inputs.
+	 *
+	 * \tparam Op The operation to apply.
+	 * \tparam Word The type of word.
+	 * \param result The array to write to.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param count The number of words.
+	 */
+	template <typename Op, typename Word>
+	constexpr void transform_words(Word* result, const Word* lhs, const Word* rhs, std::int32_t count)
+	{
+		for (std::int32_t i = 0; i < count; ++i)
+			result[i] = static_cast<Word>(Op::apply(lhs[i], rhs[i]));
+	}
+
+	/**
+	 * Combines two arrays of 64-bit words.
+	 *
+	 * SIMD instructions are used outside of constant evaluation.
+	 *
+	 * \tparam Op The operation to apply.
+	 * \param result The array to write to.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param count The number of words.
+	 */
+	template <typename Op>
+	constexpr void transform_words(std::uint64_t* result, const std::uint64_t* lhs, const std::uint64_t* rhs, std::int32_t count)
+	{
+		std::int32_t i = 0;
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+		{
+		#if defined(RECHARGEABLE_USE_AVX2)
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), Op::apply(a, b));
+			}
+		#endif
+
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), Op::apply(a, b));
+			}
+		}
+	#endif
+
+		for (; i < count; ++i)
+			result[i] = Op::apply(lhs[i], rhs[i]);
+	}
+
+	/**
+	 * Inverts an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param result The array to write to.
+	 * \param value The array to invert.
+	 * \param count The number of words.
+	 */
+	template <typename Word>
+	constexpr void not_words(Word* result, const Word* value, std::int32_t count)
+	{
+		for (std::int32_t i = 0; i < count; ++i)
+			result[i] = static_cast<Word>(~value[i]);
+	}
+
+	/**
+	 * Inverts an array of 64-bit words.
+	 *
+	 * \param result The array to write to.
+	 * \param value The array to invert.
+	 * \param count The number of words.
+	 */
+	constexpr void not_words(std::uint64_t* result, const std::uint64_t* value, std::int32_t count)
+	{
+		std::int32_t i = 0;
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+		{
+		#if defined(RECHARGEABLE_USE_AVX2)
+			const __m256i ones256 = _mm256_set1_epi32(-1);
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(value + i));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_xor_si256(a, ones256));
+			}
+		#endif
+
+			const __m128i ones128 = _mm_set1_epi32(-1);
+
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_xor_si128(a, ones128));
+			}
+		}
+	#endif
+
+		for (; i < count; ++i)
+			result[i] = ~value[i];
+	}
+
+	//----------------------------------------------------------------------
+	// Reductions
+	//----------------------------------------------------------------------
+
+	/**
+	 * Determines whether the result of combining two arrays of words has any bits set.
+	 *
+	 * Used to implement equality and intersection tests without writing
+	 * out the combined words.
+	 *
+	 * \tparam Op The operation to apply.
+	 * \tparam Word The type of word.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param count The number of words.
+	 * \returns \b true \b if any bits are set; \b false \b otherwise.
+	 */
+	template <typename Op, typename Word>
+	constexpr bool any_words(const Word* lhs, const Word* rhs, std::int32_t count)
+	{
+		Word accumulate = 0;
+
+		for (std::int32_t i = 0; i < count; ++i)
+			accumulate |= Op::apply(lhs[i], rhs[i]);
+
+		return accumulate != 0;
+	}
+
+	/**
+	 * Determines whether the result of combining two arrays of 64-bit words has any bits set.
+	 *
+	 * \tparam Op The operation to apply.
+	 * \param lhs The left hand side of the operation.
+	 * \param rhs The right hand side of the operation.
+	 * \param count The number of words.
+	 * \returns \b true \b if any bits are set; \b false \b otherwise.
+	 */
+	template <typename Op>
+	constexpr bool any_words(const std::uint64_t* lhs, const std::uint64_t* rhs, std::int32_t count)
+	{
+		std::int32_t i = 0;
+		std::uint64_t accumulate = 0;
+
+	#if defined(RECHARGEABLE_USE_SSE2)
+		if (!RECHARGEABLE_IS_CONSTANT_EVALUATED())
+		{
+		#if defined(RECHARGEABLE_USE_AVX2)
+			__m256i accumulate256 = _mm256_setzero_si256();
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+
+				accumulate256 = _mm256_or_si256(accumulate256, Op::apply(a, b));
+			}
+
+			if (!_mm256_testz_si256(accumulate256, accumulate256))
+				return true;
+		#endif
+
+			__m128i accumulate128 = _mm_setzero_si128();
+
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+
+				accumulate128 = _mm_or_si128(accumulate128, Op::apply(a, b));
+			}
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(accumulate128, _mm_setzero_si128())) != 0xffff)
+				return true;
+		}
+	#endif
+
+		for (; i < count; ++i)
+			accumulate |= Op::apply(lhs[i], rhs[i]);
+
+		return accumulate != 0;
+	}
+
+	/**
+	 * Determines whether any bits are set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \returns \b true \b if any bits are set; \b false \b otherwise.
+	 */
+	template <typename Word>
+	constexpr bool any_words(const Word* value, std::int32_t count)
+	{
+		return any_words<or_op>(value, value, count);
+	}
+
+	/**
+	 * Determines whether all bits are set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \returns \b true \b if all bits are set; \b false \b otherwise.
+	 */
+	template <typename Word>
+	constexpr bool all_words(const Word* value, std::int32_t count)
+	{
+		Word accumulate = static_cast<Word>(~Word(0));
+
+		for (std::int32_t i = 0; i < count; ++i)
+			accumulate &= value[i];
+
+		return accumulate == static_cast<Word>(~Word(0));
+	}
+
+	/**
+	 * Counts the bits set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \returns The number of bits set.
+	 */
+	template <typename Word>
+	constexpr std::int32_t count_words(const Word* value, std::int32_t count)
+	{
+		std::int32_t total = 0;
+
+		for (std::int32_t i = 0; i < count; ++i)
+			total += popcount(value[i]);
+
+		return total;
+	}
+
+	/**
+	 * Counts the bits set before a location in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \param location The location to count up to. May be one past the last bit.
+	 * \returns The number of bits set before the location.
+	 */
+	template <typename Word>
+	constexpr std::int32_t rank_words(const Word* value, std::int32_t count, std::int32_t location)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+		const std::int32_t index = location / word_bits;
+		const std::int32_t bit = location % word_bits;
+
+		RECHARGEABLE_ASSERT((location >= 0) && (location <= count * word_bits), "Invalid location");
+
+		std::int32_t total = count_words(value, index);
+
+		if ((bit != 0) && (index < count))
+			total += popcount(static_cast<std::uint64_t>(value[index]) & ((std::uint64_t(1) << bit) - 1));
+
+		return total;
+	}
+
+	/**
+	 * Finds the location of the nth bit set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \param n The zero based index of the set bit.
+	 * \returns The location of the nth bit set, or -1 if fewer bits are set.
+	 */
+	template <typename Word>
+	constexpr std::int32_t select_words(const Word* value, std::int32_t count, std::int32_t n)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			const std::int32_t bits = popcount(value[i]);
+
+			if (n < bits)
+				return (i * word_bits) + select_bit(value[i], n);
+
+			n -= bits;
+		}
+
+		return -1;
+	}
+
+	//----------------------------------------------------------------------
+	// Scanning
+	//----------------------------------------------------------------------
+
+	/**
+	 * Finds the first bit set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \returns The location of the first bit set, or -1 if no bits are set.
+	 */
+	template <typename Word>
+	constexpr std::int32_t find_first_word(const Word* value, std::int32_t count)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			if (value[i] != 0)
+				return (i * word_bits) + count_trailing_zeros(value[i]);
+		}
+
+		return -1;
+	}
+
+	/**
+	 * Finds the next bit set in an array of words after the given location.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \param location The location to search after.
+	 * \returns The location of the next bit set, or -1 if no more bits are set.
+	 */
+	template <typename Word>
+	constexpr std::int32_t find_next_word(const Word* value, std::int32_t count, std::int32_t location)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+
+		++location;
+
+		std::int32_t index = location / word_bits;
+
+		if (index >= count)
+			return -1;
+
+		// Mask off the bits at and before the location
+		const std::int32_t bit = location % word_bits;
+		std::uint64_t word = static_cast<std::uint64_t>(value[index]) & (~std::uint64_t(0) << bit);
+
+		while (word == 0)
+		{
+			if (++index >= count)
+				return -1;
+
+			word = value[index];
+		}
+
+		return (index * word_bits) + count_trailing_zeros(word);
+	}
+
+	/**
+	 * Finds the last bit set in an array of words.
+	 *
+	 * \tparam Word The type of word.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \returns The location of the last bit set, or -1 if no bits are set.
+	 */
+	template <typename Word>
+	constexpr std::int32_t find_last_word(const Word* value, std::int32_t count)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+
+		for (std::int32_t i = count - 1; i >= 0; --i)
+		{
+			if (value[i] != 0)
+				return (i * word_bits) + 63 - count_leading_zeros(value[i]);
+		}
+
+		return -1;
+	}
+
+	/**
+	 * Invokes a function for each bit set in an array of words.
+	 *
+	 * Only the bits that are set are visited.
+	 *
+	 * \tparam Word The type of word.
+	 * \tparam Function The type of function to invoke.
+	 * \param value The array of words.
+	 * \param count The number of words.
+	 * \param function The function to invoke with the location of each bit.
+	 */
+	template <typename Word, typename Function>
+	inline void for_each_word_bit(const Word* value, std::int32_t count, Function function)
+	{
+		const std::int32_t word_bits = sizeof(Word) * 8;
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			std::uint64_t word = value[i];
+
+			while (word != 0)
+			{
+				function((i * word_bits) + count_trailing_zeros(word));
+
+				// Clear the lowest bit set
+				word &= word - 1;
+			}
+		}
+	}
+
+} } // end namespace rtl::detail
+
+#endif // end RECHARGEABLE_DETAIL_WORD_OPS_HPP_INCLUDED
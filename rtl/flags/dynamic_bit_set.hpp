@@ -0,0 +1,599 @@
+/**
+ * \file dynamic_bit_set.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_DYNAMIC_BIT_SET_HPP_INCLUDED
+#define RECHARGEABLE_DYNAMIC_BIT_SET_HPP_INCLUDED
+
+#include <rtl/flags/detail/word_ops.hpp>
+#include <rtl/flags/detail/bit_iterator.hpp>
+#include <memory>
+#include <type_traits>
+
+namespace rtl
+{
+	/**
+	 * A collection of bits whose size is set at runtime.
+	 *
+	 * Up to 128 bits are held within the instance. Larger collections
+	 * are allocated through the allocator. The word operations and
+	 * iteration are shared with detail::bit_set.
+	 *
+	 * Bits beyond the size of the collection are kept cleared.
+	 *
+	 * \tparam Allocator The allocator used when the bits do not fit inline.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Allocator = std::allocator<std::uint64_t> >
+	class basic_dynamic_bit_set
+	{
+		public:
+
+			typedef std::uint64_t word_type;
+			typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> allocator_type;
+			typedef detail::set_bit_iterator<word_type> iterator;
+			typedef iterator const_iterator;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 64;
+			/// The number of words held within the instance
+			static const std::int32_t inline_words = 2;
+
+			/**
+			 * Creates an empty instance of the basic_dynamic_bit_set class.
+			 *
+			 * \param allocator The allocator to use.
+			 */
+			explicit basic_dynamic_bit_set(const allocator_type& allocator = allocator_type())
+			: _allocator(allocator)
+			, _words(_inline)
+			, _bits(0)
+			, _capacity(inline_words)
+			{
+				_inline[0] = 0;
+				_inline[1] = 0;
+			}
+
+			/**
+			 * Creates an instance of the basic_dynamic_bit_set class.
+			 *
+			 * All bits are initially cleared.
+			 *
+			 * \param bits The number of bits.
+			 * \param allocator The allocator to use.
+			 */
+			explicit basic_dynamic_bit_set(std::int32_t bits, const allocator_type& allocator = allocator_type())
+			: _allocator(allocator)
+			, _words(_inline)
+			, _bits(0)
+			, _capacity(inline_words)
+			{
+				_inline[0] = 0;
+				_inline[1] = 0;
+
+				resize(bits);
+			}
+
+			basic_dynamic_bit_set(const basic_dynamic_bit_set& copy)
+			: _allocator(std::allocator_traits<allocator_type>::select_on_container_copy_construction(copy._allocator))
+			, _words(_inline)
+			, _bits(0)
+			, _capacity(inline_words)
+			{
+				assign(copy);
+			}
+
+			basic_dynamic_bit_set(basic_dynamic_bit_set&& move) noexcept
+			: _allocator(std::move(move._allocator))
+			, _words(_inline)
+			, _bits(0)
+			, _capacity(inline_words)
+			{
+				steal(move);
+			}
+
+			~basic_dynamic_bit_set()
+			{
+				deallocate();
+			}
+
+			/**
+			 * Copies the bits of another instance.
+			 *
+			 * The allocator of the instance is kept.
+			 */
+			basic_dynamic_bit_set& operator= (const basic_dynamic_bit_set& copy)
+			{
+				if (this != &copy)
+					assign(copy);
+
+				return *this;
+			}
+
+			/**
+			 * Takes the bits of another instance.
+			 *
+			 * Heap storage is taken when the allocator propagates on move
+			 * assignment or the allocators compare equal. Otherwise the bits
+			 * are copied through the allocator of the instance, which may
+			 * throw, so the operator is only noexcept when the allocator
+			 * propagates or is stateless.
+			 */
+			basic_dynamic_bit_set& operator= (basic_dynamic_bit_set&& move) noexcept(std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value || std::is_empty<allocator_type>::value)
+			{
+				if (this != &move)
+				{
+					if (std::allocator_traits<allocator_type>::propagate_on_container_move_assignment::value)
+					{
+						deallocate();
+						_allocator = std::move(move._allocator);
+						steal(move);
+					}
+					else if (_allocator == move._allocator)
+					{
+						deallocate();
+						steal(move);
+					}
+					else
+					{
+						assign(move);
+					}
+				}
+
+				return *this;
+			}
+
+			/**
+			 * Changes the number of bits.
+			 *
+			 * Added bits are cleared.
+			 *
+			 * \param bits The number of bits.
+			 */
+			void resize(std::int32_t bits)
+			{
+				RECHARGEABLE_ASSERT(bits >= 0, "Invalid size");
+
+				const std::int32_t count = (bits + 63) >> 6;
+
+				if (count > _capacity)
+					reserve_words(count);
+
+				const std::int32_t current = word_count();
+
+				// Clear the added words
+				for (std::int32_t i = current; i < count; ++i)
+					_words[i] = 0;
+
+				// Clear the bits past the end when shrinking
+				if ((bits < _bits) && (count > 0))
+				{
+					for (std::int32_t i = count; i < current; ++i)
+						_words[i] = 0;
+
+					if ((bits & 63) != 0)
+						_words[count - 1] &= (word_type(1) << (bits & 63)) - 1;
+				}
+
+				_bits = bits;
+			}
+
+			/**
+			 * Gets the number of bits.
+			 *
+			 * \returns The number of bits.
+			 */
+			std::int32_t size() const
+			{
+				return _bits;
+			}
+
+			/**
+			 * Gets the number of words holding the bits.
+			 *
+			 * \returns The number of words.
+			 */
+			std::int32_t word_count() const
+			{
+				return (_bits + 63) >> 6;
+			}
+
+			word_type* data()
+			{
+				return _words;
+			}
+
+			const word_type* data() const
+			{
+				return _words;
+			}
+
+			allocator_type get_allocator() const
+			{
+				return _allocator;
+			}
+
+			//----------------------------------------------------------------------
+			// Single bit operations
+			//----------------------------------------------------------------------
+
+			void set(std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < _bits), "Invalid location");
+
+				_words[location >> 6] |= (word_type(1) << (location & 63));
+			}
+
+			void clear(std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < _bits), "Invalid location");
+
+				_words[location >> 6] &= ~(word_type(1) << (location & 63));
+			}
+
+			void toggle(std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < _bits), "Invalid location");
+
+				_words[location >> 6] ^= (word_type(1) << (location & 63));
+			}
+
+			bool is_set(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < _bits), "Invalid location");
+
+				return ((_words[location >> 6] >> (location & 63)) & 1) != 0;
+			}
+
+			/**
+			 * Clears all the bits.
+			 */
+			void reset()
+			{
+				for (std::int32_t i = 0; i < word_count(); ++i)
+					_words[i] = 0;
+			}
+
+			//----------------------------------------------------------------------
+			// Set algebra
+			//
+			// Both collections must be the same size.
+			//----------------------------------------------------------------------
+
+			basic_dynamic_bit_set& operator&= (const basic_dynamic_bit_set& rhs)
+			{
+				RECHARGEABLE_ASSERT(_bits == rhs._bits, "Sizes do not match");
+
+				detail::transform_words<detail::and_op>(_words, _words, rhs._words, word_count());
+				return *this;
+			}
+
+			basic_dynamic_bit_set& operator|= (const basic_dynamic_bit_set& rhs)
+			{
+				RECHARGEABLE_ASSERT(_bits == rhs._bits, "Sizes do not match");
+
+				detail::transform_words<detail::or_op>(_words, _words, rhs._words, word_count());
+				return *this;
+			}
+
+			basic_dynamic_bit_set& operator^= (const basic_dynamic_bit_set& rhs)
+			{
+				RECHARGEABLE_ASSERT(_bits == rhs._bits, "Sizes do not match");
+
+				detail::transform_words<detail::xor_op>(_words, _words, rhs._words, word_count());
+				return *this;
+			}
+
+			/**
+			 * Removes the bits that are set in another collection.
+			 *
+			 * \param rhs The bits to remove.
+			 * \returns The modified collection.
+			 */
+			basic_dynamic_bit_set& andnot_assign(const basic_dynamic_bit_set& rhs)
+			{
+				RECHARGEABLE_ASSERT(_bits == rhs._bits, "Sizes do not match");
+
+				detail::transform_words<detail::andnot_op>(_words, _words, rhs._words, word_count());
+				return *this;
+			}
+
+			basic_dynamic_bit_set operator& (const basic_dynamic_bit_set& rhs) const
+			{
+				basic_dynamic_bit_set result(*this);
+				return result &= rhs;
+			}
+
+			basic_dynamic_bit_set operator| (const basic_dynamic_bit_set& rhs) const
+			{
+				basic_dynamic_bit_set result(*this);
+				return result |= rhs;
+			}
+
+			basic_dynamic_bit_set operator^ (const basic_dynamic_bit_set& rhs) const
+			{
+				basic_dynamic_bit_set result(*this);
+				return result ^= rhs;
+			}
+
+			basic_dynamic_bit_set andnot(const basic_dynamic_bit_set& rhs) const
+			{
+				basic_dynamic_bit_set result(*this);
+				return result.andnot_assign(rhs);
+			}
+
+			/**
+			 * Computes the complement of the collection.
+			 *
+			 * \returns The bits that are not set.
+			 */
+			basic_dynamic_bit_set operator~ () const
+			{
+				basic_dynamic_bit_set result(*this);
+				const std::int32_t count = word_count();
+
+				detail::not_words(result._words, _words, count);
+
+				if ((_bits & 63) != 0)
+					result._words[count - 1] &= (word_type(1) << (_bits & 63)) - 1;
+
+				return result;
+			}
+
+			bool operator== (const basic_dynamic_bit_set& rhs) const
+			{
+				return (_bits == rhs._bits) && !detail::any_words<detail::xor_op>(_words, rhs._words, word_count());
+			}
+
+			bool operator!= (const basic_dynamic_bit_set& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+			bool intersects(const basic_dynamic_bit_set& rhs) const
+			{
+				RECHARGEABLE_ASSERT(_bits == rhs._bits, "Sizes do not match");
+
+				return detail::any_words<detail::and_op>(_words, rhs._words, word_count());
+			}
+
+			bool any() const
+			{
+				return detail::any_words(_words, word_count());
+			}
+
+			bool none() const
+			{
+				return !any();
+			}
+
+			bool all() const
+			{
+				return count() == _bits;
+			}
+
+			std::int32_t count() const
+			{
+				return detail::count_words(_words, word_count());
+			}
+
+			/**
+			 * Counts the bits set before a location.
+			 *
+			 * Each call scans the words before the location. Use a
+			 * rank_select_index when ranking a large collection repeatedly.
+			 *
+			 * \param location The location to count up to. May be size().
+			 * \returns The number of bits set before the location.
+			 */
+			std::int32_t rank(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location <= _bits), "Invalid location");
+
+				return detail::rank_words(_words, word_count(), location);
+			}
+
+			/**
+			 * Finds the location of the nth bit set.
+			 *
+			 * \param n The zero based index of the set bit.
+			 * \returns The location of the nth bit set, or -1 if fewer bits are set.
+			 */
+			std::int32_t select(std::int32_t n) const
+			{
+				RECHARGEABLE_ASSERT(n >= 0, "Invalid index");
+
+				return detail::select_words(_words, word_count(), n);
+			}
+
+			//----------------------------------------------------------------------
+			// Iteration
+			//----------------------------------------------------------------------
+
+			iterator begin() const
+			{
+				return iterator(_words, word_count());
+			}
+
+			iterator end() const
+			{
+				return iterator(_words, word_count(), true);
+			}
+
+			template <typename Function>
+			void for_each_set(Function function) const
+			{
+				detail::for_each_word_bit(_words, word_count(), function);
+			}
+
+			/**
+			 * Finds the first bit set.
+			 *
+			 * \returns The location of the first bit set, or -1 if no bits are set.
+			 */
+			std::int32_t find_first() const
+			{
+				return detail::find_first_word(_words, word_count());
+			}
+
+			/**
+			 * Finds the next bit set after the given location.
+			 *
+			 * \param location The location to search after.
+			 * \returns The location of the next bit set, or -1 if no more bits are set.
+			 */
+			std::int32_t find_next(std::int32_t location) const
+			{
+				return detail::find_next_word(_words, word_count(), location);
+			}
+
+			/**
+			 * Finds the last bit set.
+			 *
+			 * \returns The location of the last bit set, or -1 if no bits are set.
+			 */
+			std::int32_t find_last() const
+			{
+				return detail::find_last_word(_words, word_count());
+			}
+
+		private:
+
+			typedef std::allocator_traits<allocator_type> allocator_traits;
+
+			/**
+			 * Grows the storage to hold a number of words.
+			 *
+			 * \param count The number of words required.
+			 */
+			void reserve_words(std::int32_t count)
+			{
+				// Grow geometrically so repeated resizes stay cheap
+				std::int32_t capacity = _capacity * 2;
+
+				if (capacity < count)
+					capacity = count;
+
+				word_type* words = allocator_traits::allocate(_allocator, capacity);
+
+				for (std::int32_t i = 0; i < word_count(); ++i)
+					words[i] = _words[i];
+
+				deallocate();
+
+				_words = words;
+				_capacity = capacity;
+			}
+
+			/**
+			 * Releases heap storage.
+			 */
+			void deallocate()
+			{
+				if (_words != _inline)
+					allocator_traits::deallocate(_allocator, _words, _capacity);
+
+				_words = _inline;
+				_capacity = inline_words;
+			}
+
+			/**
+			 * Copies the bits of another instance.
+			 */
+			void assign(const basic_dynamic_bit_set& copy)
+			{
+				const std::int32_t count = copy.word_count();
+
+				if (count > _capacity)
+				{
+					deallocate();
+					_bits = 0;
+
+					reserve_words(count);
+				}
+
+				for (std::int32_t i = 0; i < count; ++i)
+					_words[i] = copy._words[i];
+
+				_bits = copy._bits;
+			}
+
+			/**
+			 * Takes the storage of another instance and leaves it empty.
+			 */
+			void steal(basic_dynamic_bit_set& move)
+			{
+				if (move._words != move._inline)
+				{
+					_words = move._words;
+					_capacity = move._capacity;
+				}
+				else
+				{
+					_inline[0] = move._inline[0];
+					_inline[1] = move._inline[1];
+				}
+
+				_bits = move._bits;
+
+				move._words = move._inline;
+				move._capacity = inline_words;
+				move._bits = 0;
+				move._inline[0] = 0;
+				move._inline[1] = 0;
+			}
+
+			/// The allocator for heap storage
+			allocator_type _allocator;
+			/// The words holding the bits
+			word_type* _words;
+			/// The number of bits
+			std::int32_t _bits;
+			/// The number of words available
+			std::int32_t _capacity;
+			/// Storage for small collections
+			word_type _inline[inline_words];
+
+	} ; // end class basic_dynamic_bit_set<Allocator>
+
+	/// A dynamic_bit_set using the default allocator
+	typedef basic_dynamic_bit_set<> dynamic_bit_set;
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_DYNAMIC_BIT_SET_HPP_INCLUDED
@@ -0,0 +1,513 @@
+/**
+ * \file flag_batch.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_BATCH_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_BATCH_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <cstring>
+#include <vector>
+
+namespace rtl
+{
+	namespace detail
+	{
+		//----------------------------------------------------------------------
+		// Pattern operations
+		//
+		// An array of flag_sets no larger than a 64-bit word is a byte array
+		// in which the memory image of a mask repeats every element. The
+		// image is replicated into a 64-bit pattern and applied to the whole
+		// array at once, several flag_sets per word and more per SIMD
+		// register. Working on memory images keeps this independent of the
+		// byte order of the host.
+		//----------------------------------------------------------------------
+
+		/**
+		 * Determines whether an array of a type can be processed as a pattern.
+		 *
+		 * \tparam T The type of element.
+		 */
+		template <typename T>
+		struct is_pattern_element
+		{
+			static const bool value = (sizeof(T) <= 8) && ((8 % sizeof(T)) == 0);
+		} ;
+
+		/**
+		 * Replicates the memory image of a flag_set across 64 bits.
+		 *
+		 * Only the bit container is copied. Any other bytes of the flag_set,
+		 * such as the debug names of a bit_union, are left zero.
+		 *
+		 * \param value The flag_set to replicate.
+		 * \param pattern The 8 bytes of the pattern.
+		 */
+		template <typename Enum, std::int32_t Size, typename Names>
+		inline void make_pattern(const flag_set<Enum, Size, Names>& value, std::uint8_t* pattern)
+		{
+			typedef flag_set<Enum, Size, Names> value_type;
+
+			std::memset(pattern, 0, 8);
+
+			for (std::size_t offset = 0; offset < 8; offset += sizeof(value_type))
+				std::memcpy(pattern + offset, &value.container(), sizeof(typename value_type::container_type));
+		}
+
+		/**
+		 * Combines a byte array with a repeating 64-bit pattern.
+		 *
+		 * \tparam Op The operation to apply.
+		 * \param bytes The bytes to modify.
+		 * \param count The number of bytes.
+		 * \param pattern The 8 bytes of the pattern.
+		 */
+		template <typename Op>
+		inline void apply_pattern(std::uint8_t* bytes, std::size_t count, const std::uint8_t* pattern)
+		{
+			std::uint64_t word;
+			std::memcpy(&word, pattern, 8);
+
+			std::size_t i = 0;
+
+		#if defined(RECHARGEABLE_USE_AVX2)
+			const __m256i wide = _mm256_set1_epi64x(static_cast<long long>(word));
+
+			for (; i + 32 <= count; i += 32)
+			{
+				const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + i), Op::apply(value, wide));
+			}
+		#endif
+		#if defined(RECHARGEABLE_USE_SSE2)
+			const __m128i narrow = _mm_set1_epi64x(static_cast<long long>(word));
+
+			for (; i + 16 <= count; i += 16)
+			{
+				const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), Op::apply(value, narrow));
+			}
+		#endif
+
+			for (; i + 8 <= count; i += 8)
+			{
+				std::uint64_t value;
+				std::memcpy(&value, bytes + i, 8);
+
+				value = Op::apply(value, word);
+				std::memcpy(bytes + i, &value, 8);
+			}
+
+			for (; i < count; ++i)
+				bytes[i] = static_cast<std::uint8_t>(Op::apply(bytes[i], pattern[i & 7]));
+		}
+
+		/**
+		 * Sums the bytes of a 64-bit word.
+		 *
+		 * \param value The bytes to sum.
+		 * \returns The sum of the bytes.
+		 */
+		inline std::size_t sum_bytes(std::uint64_t value)
+		{
+			value = (value & 0x00ff00ff00ff00ffull) + ((value >> 8) & 0x00ff00ff00ff00ffull);
+
+			return static_cast<std::size_t>((value * 0x0001000100010001ull) >> 48);
+		}
+
+		/**
+		 * Counts the bytes of a byte array holding a single bit of a repeating pattern.
+		 *
+		 * Every byte of the pattern must have at most one bit set, and
+		 * that bit must be the same in every byte. Masking moves each byte
+		 * to 0 or that bit, and shifting moves the bit to bit 0, so the
+		 * bytes can be summed with byte adds. Byte counters are flushed
+		 * before they can overflow.
+		 *
+		 * \param bytes The bytes to count.
+		 * \param count The number of bytes.
+		 * \param pattern The 8 bytes of the pattern.
+		 * \param shift The bit set within the bytes of the pattern.
+		 * \returns The number of bytes holding the bit.
+		 */
+		inline std::size_t count_pattern(const std::uint8_t* bytes, std::size_t count, const std::uint8_t* pattern, std::int32_t shift)
+		{
+			std::uint64_t word;
+			std::memcpy(&word, pattern, 8);
+
+			std::size_t total = 0;
+			std::size_t i = 0;
+
+		#if defined(RECHARGEABLE_USE_AVX2)
+			const __m256i wide = _mm256_set1_epi64x(static_cast<long long>(word));
+			const __m128i wideShift = _mm_cvtsi32_si128(shift);
+
+			while (i + 32 <= count)
+			{
+				__m256i sum = _mm256_setzero_si256();
+
+				for (std::int32_t block = 0; (block < 255) && (i + 32 <= count); ++block, i += 32)
+				{
+					const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+					sum = _mm256_add_epi8(sum, _mm256_srl_epi64(_mm256_and_si256(value, wide), wideShift));
+				}
+
+				sum = _mm256_sad_epu8(sum, _mm256_setzero_si256());
+
+				std::uint64_t lanes[4];
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+
+				total += static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+			}
+		#endif
+		#if defined(RECHARGEABLE_USE_SSE2)
+			const __m128i narrow = _mm_set1_epi64x(static_cast<long long>(word));
+			const __m128i narrowShift = _mm_cvtsi32_si128(shift);
+
+			while (i + 16 <= count)
+			{
+				__m128i sum = _mm_setzero_si128();
+
+				for (std::int32_t block = 0; (block < 255) && (i + 16 <= count); ++block, i += 16)
+				{
+					const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+					sum = _mm_add_epi8(sum, _mm_srl_epi64(_mm_and_si128(value, narrow), narrowShift));
+				}
+
+				sum = _mm_sad_epu8(sum, _mm_setzero_si128());
+
+				std::uint64_t lanes[2];
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+
+				total += static_cast<std::size_t>(lanes[0] + lanes[1]);
+			}
+		#endif
+
+			while (i + 8 <= count)
+			{
+				std::uint64_t sum = 0;
+
+				for (std::int32_t block = 0; (block < 255) && (i + 8 <= count); ++block, i += 8)
+				{
+					std::uint64_t value;
+					std::memcpy(&value, bytes + i, 8);
+
+					sum += (value & word) >> shift;
+				}
+
+				total += sum_bytes(sum);
+			}
+
+			for (; i < count; ++i)
+				total += (bytes[i] & pattern[i & 7]) >> shift;
+
+			return total;
+		}
+
+		/**
+		 * Applies an operation to one flag across an array of flag_sets.
+		 *
+		 * \tparam Op The operation to apply.
+		 * \param flags The flag_sets to modify.
+		 * \param count The number of flag_sets.
+		 * \param flag The flag to modify.
+		 */
+		template <typename Op, typename Enum, std::int32_t Size, typename Names>
+		inline void apply_flag(flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+		{
+			typedef flag_set<Enum, Size, Names> value_type;
+			typedef typename value_type::word_type word_type;
+			typedef typename value_type::container_type container_type;
+
+			RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+			if (is_pattern_element<value_type>::value)
+			{
+				const value_type mask(flag);
+
+				std::uint8_t pattern[8];
+				make_pattern(mask, pattern);
+
+				apply_pattern<Op>(reinterpret_cast<std::uint8_t*>(flags), count * sizeof(value_type), pattern);
+			}
+			else
+			{
+				const std::int32_t index = flag / container_type::word_bits;
+				const word_type bit = static_cast<word_type>(word_type(1) << (flag % container_type::word_bits));
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					word_type& word = word_data(flags[i].container())[index];
+					word = static_cast<word_type>(Op::apply(word, bit));
+				}
+			}
+		}
+
+		/**
+		 * Applies an operation to one flag of the flag_sets at a list of indices.
+		 *
+		 * \tparam Op The operation to apply.
+		 * \param flags The flag_sets to modify.
+		 * \param indices The indices of the flag_sets to modify.
+		 * \param indexCount The number of indices.
+		 * \param flag The flag to modify.
+		 */
+		template <typename Op, typename Enum, std::int32_t Size, typename Names>
+		inline void apply_flag(flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, Enum flag)
+		{
+			typedef flag_set<Enum, Size, Names> value_type;
+			typedef typename value_type::word_type word_type;
+			typedef typename value_type::container_type container_type;
+
+			RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+			const std::int32_t index = flag / container_type::word_bits;
+			const word_type bit = static_cast<word_type>(word_type(1) << (flag % container_type::word_bits));
+
+			for (std::size_t i = 0; i < indexCount; ++i)
+			{
+				word_type& word = word_data(flags[indices[i]].container())[index];
+				word = static_cast<word_type>(Op::apply(word, bit));
+			}
+		}
+
+	} // end namespace detail
+
+	//----------------------------------------------------------------------
+	// Modification
+	//
+	// Each operation takes either a contiguous array of flag_sets or an
+	// array together with a list of indices into it. Arrays of flag_sets
+	// of 64 flags or less are processed several flag_sets at a time.
+	//----------------------------------------------------------------------
+
+	/**
+	 * Sets a flag on every flag_set in an array.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to set.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void set_all(flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		detail::apply_flag<detail::or_op>(flags, count, flag);
+	}
+
+	/**
+	 * Sets a flag on the flag_sets at a list of indices.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param indices The indices of the flag_sets to modify.
+	 * \param indexCount The number of indices.
+	 * \param flag The flag to set.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void set_all(flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, Enum flag)
+	{
+		detail::apply_flag<detail::or_op>(flags, indices, indexCount, flag);
+	}
+
+	/**
+	 * Clears a flag on every flag_set in an array.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to clear.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void clear_all(flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		detail::apply_flag<detail::andnot_op>(flags, count, flag);
+	}
+
+	/**
+	 * Clears a flag on the flag_sets at a list of indices.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param indices The indices of the flag_sets to modify.
+	 * \param indexCount The number of indices.
+	 * \param flag The flag to clear.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void clear_all(flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, Enum flag)
+	{
+		detail::apply_flag<detail::andnot_op>(flags, indices, indexCount, flag);
+	}
+
+	/**
+	 * Toggles a flag on every flag_set in an array.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to toggle.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void toggle_all(flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		detail::apply_flag<detail::xor_op>(flags, count, flag);
+	}
+
+	/**
+	 * Toggles a flag on the flag_sets at a list of indices.
+	 *
+	 * Listing an index twice toggles it twice.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param indices The indices of the flag_sets to modify.
+	 * \param indexCount The number of indices.
+	 * \param flag The flag to toggle.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void toggle_all(flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, Enum flag)
+	{
+		detail::apply_flag<detail::xor_op>(flags, indices, indexCount, flag);
+	}
+
+	/**
+	 * Writes flag_sets to a list of indices.
+	 *
+	 * \param flags The flag_sets to modify.
+	 * \param indices The indices of the flag_sets to write.
+	 * \param indexCount The number of indices.
+	 * \param values The values to write, one for each index.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void scatter(flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, const flag_set<Enum, Size, Names>* values)
+	{
+		for (std::size_t i = 0; i < indexCount; ++i)
+			flags[indices[i]] = values[i];
+	}
+
+	//----------------------------------------------------------------------
+	// Queries
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the flag_sets in an array with a flag set.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to query.
+	 * \returns The number of flag_sets with the flag set.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline std::size_t count_set(const flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		typedef flag_set<Enum, Size, Names> value_type;
+
+		RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+		if (detail::is_pattern_element<value_type>::value)
+		{
+			// The mask has a single bit per flag_set so counting bytes counts flag_sets
+			const value_type mask(flag);
+
+			std::uint8_t pattern[8];
+			detail::make_pattern(mask, pattern);
+
+			return detail::count_pattern(reinterpret_cast<const std::uint8_t*>(flags), count * sizeof(value_type), pattern, flag & 7);
+		}
+
+		std::size_t total = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+			total += flags[i].is_set(flag) ? 1 : 0;
+
+		return total;
+	}
+
+	/**
+	 * Counts the flag_sets at a list of indices with a flag set.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param indices The indices of the flag_sets to query.
+	 * \param indexCount The number of indices.
+	 * \param flag The flag to query.
+	 * \returns The number of listed flag_sets with the flag set.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline std::size_t count_set(const flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, Enum flag)
+	{
+		std::size_t total = 0;
+
+		for (std::size_t i = 0; i < indexCount; ++i)
+			total += flags[indices[i]].is_set(flag) ? 1 : 0;
+
+		return total;
+	}
+
+	/**
+	 * Finds the flag_sets in an array that have all the flags of a mask.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param mask The flags that must be set.
+	 * \param result The indices of the matching flag_sets are appended to the vector.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void gather_matching(const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_set<Enum, Size, Names>& mask, std::vector<std::int32_t>& result)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if ((flags[i] & mask) == mask)
+				result.push_back(static_cast<std::int32_t>(i));
+		}
+	}
+
+	/**
+	 * Finds the flag_sets at a list of indices that have all the flags of a mask.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param indices The indices of the flag_sets to query.
+	 * \param indexCount The number of indices.
+	 * \param mask The flags that must be set.
+	 * \param result The matching indices are appended to the vector.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	inline void gather_matching(const flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, const flag_set<Enum, Size, Names>& mask, std::vector<std::int32_t>& result)
+	{
+		for (std::size_t i = 0; i < indexCount; ++i)
+		{
+			if ((flags[indices[i]] & mask) == mask)
+				result.push_back(indices[i]);
+		}
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_BATCH_HPP_INCLUDED
@@ -0,0 +1,525 @@
+/**
+ * \file flag_column.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_COLUMN_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_COLUMN_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * Stores the flags of many rows as bit-planes.
+	 *
+	 * Each flag is held in its own plane of 64-bit words with one bit per
+	 * row. Queries combine whole planes word by word, so testing a flag
+	 * across 64 rows costs a single word operation.
+	 *
+	 * \tparam Enum The enumeration holding the flags.
+	 * \tparam Size The number of flags.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Enum, std::int32_t Size>
+	class flag_column
+	{
+		public:
+
+			typedef std::uint64_t word_type;
+			typedef detail::bit_set<detail::select_bits<Size>::value> mask_type;
+
+			/// The number of bits held in a word
+			static const std::int32_t word_bits = 64;
+
+			class row_reference;
+
+			/**
+			 * Creates an instance of the flag_column class with no rows.
+			 */
+			flag_column()
+			: _rows(0)
+			, _stride(0)
+			{ }
+
+			/**
+			 * Creates an instance of the flag_column class.
+			 *
+			 * All flags are initially cleared.
+			 *
+			 * \param rows The number of rows.
+			 */
+			explicit flag_column(std::int32_t rows)
+			: _rows(0)
+			, _stride(0)
+			{
+				resize(rows);
+			}
+
+			/**
+			 * Changes the number of rows.
+			 *
+			 * Added rows have all flags cleared.
+			 *
+			 * \param rows The number of rows.
+			 */
+			void resize(std::int32_t rows)
+			{
+				RECHARGEABLE_ASSERT(rows >= 0, "Invalid row count");
+
+				// Round the planes to a cache line of words
+				const std::int32_t stride = (((rows + 63) >> 6) + 7) & ~7;
+
+				if (stride != _stride)
+				{
+					std::vector<word_type> planes(static_cast<std::size_t>(stride) * Size, 0);
+					const std::int32_t copy = stride < _stride ? stride : _stride;
+
+					for (std::int32_t flag = 0; flag < Size; ++flag)
+					{
+						for (std::int32_t i = 0; i < copy; ++i)
+							planes[(flag * stride) + i] = _planes[(flag * _stride) + i];
+					}
+
+					_planes.swap(planes);
+					_stride = stride;
+				}
+
+				// Clear any rows that were removed, unless no planes remain
+				if ((rows < _rows) && (_stride > 0))
+				{
+					for (std::int32_t flag = 0; flag < Size; ++flag)
+					{
+						word_type* words = plane(static_cast<Enum>(flag));
+
+						for (std::int32_t i = rows >> 6; i < _stride; ++i)
+							words[i] &= (i == (rows >> 6)) ? low_mask(rows & 63) : 0;
+					}
+				}
+
+				_rows = rows;
+			}
+
+			/**
+			 * Gets the number of rows.
+			 *
+			 * \returns The number of rows.
+			 */
+			std::int32_t size() const
+			{
+				return _rows;
+			}
+
+			/**
+			 * Gets the number of words in each plane that hold rows.
+			 *
+			 * \returns The number of words to use in a result bitmap.
+			 */
+			std::int32_t word_count() const
+			{
+				return (_rows + 63) >> 6;
+			}
+
+			/**
+			 * Gets the bit-plane for a flag.
+			 *
+			 * \param flag The flag.
+			 * \returns An array of word_count() words with a bit per row.
+			 */
+			word_type* plane(Enum flag)
+			{
+				RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+				return _planes.data() + (static_cast<std::size_t>(flag) * _stride);
+			}
+
+			/**
+			 * Gets the bit-plane for a flag.
+			 *
+			 * \param flag The flag.
+			 * \returns An array of word_count() words with a bit per row.
+			 */
+			const word_type* plane(Enum flag) const
+			{
+				RECHARGEABLE_ASSERT((flag >= 0) && (flag < Size), "Invalid flag");
+
+				return _planes.data() + (static_cast<std::size_t>(flag) * _stride);
+			}
+
+			//----------------------------------------------------------------------
+			// Row operations
+			//----------------------------------------------------------------------
+
+			void set(std::int32_t row, Enum flag)
+			{
+				plane(flag)[word_index(row)] |= bit_mask(row);
+			}
+
+			void clear(std::int32_t row, Enum flag)
+			{
+				plane(flag)[word_index(row)] &= ~bit_mask(row);
+			}
+
+			void toggle(std::int32_t row, Enum flag)
+			{
+				plane(flag)[word_index(row)] ^= bit_mask(row);
+			}
+
+			bool is_set(std::int32_t row, Enum flag) const
+			{
+				return (plane(flag)[word_index(row)] & bit_mask(row)) != 0;
+			}
+
+			/**
+			 * Copies the flags of a row into a flag_set.
+			 *
+			 * \param row The row to read.
+			 * \param flags The flag_set to write to.
+			 */
+			template <typename Names>
+			void load(std::int32_t row, flag_set<Enum, Size, Names>& flags) const
+			{
+				const std::int32_t index = word_index(row);
+				const std::int32_t bit = row & 63;
+
+				typename flag_set<Enum, Size, Names>::container_type& container = flags.container();
+				detail::clear_bit_set(container);
+
+				for (std::int32_t flag = 0; flag < Size; ++flag)
+				{
+					if ((plane(static_cast<Enum>(flag))[index] >> bit) & 1)
+						detail::set_bit(container, flag);
+				}
+			}
+
+			/**
+			 * Copies the flags in a flag_set into a row.
+			 *
+			 * \param row The row to write.
+			 * \param flags The flag_set to read from.
+			 */
+			template <typename Names>
+			void store(std::int32_t row, const flag_set<Enum, Size, Names>& flags)
+			{
+				const std::int32_t index = word_index(row);
+				const std::int32_t bit = row & 63;
+
+				const typename flag_set<Enum, Size, Names>::container_type& container = flags.container();
+
+				for (std::int32_t flag = 0; flag < Size; ++flag)
+				{
+					word_type& word = plane(static_cast<Enum>(flag))[index];
+					const word_type value = detail::is_bit_set(container, flag) ? 1 : 0;
+
+					word = (word & ~(word_type(1) << bit)) | (value << bit);
+				}
+			}
+
+			/**
+			 * Gets a view of a row that behaves like a flag_set.
+			 *
+			 * \param row The row.
+			 * \returns A reference to the row.
+			 */
+			row_reference row(std::int32_t row)
+			{
+				return row_reference(*this, row);
+			}
+
+			//----------------------------------------------------------------------
+			// Queries
+			//----------------------------------------------------------------------
+
+			/**
+			 * Finds the rows that have all the required flags and none of the excluded flags.
+			 *
+			 * \param required The flags that must be set.
+			 * \param excluded The flags that must be cleared.
+			 * \param result The bitmap of matching rows. Resized to word_count() words.
+			 */
+			void match(const mask_type& required, const mask_type& excluded, std::vector<word_type>& result) const
+			{
+				const std::int32_t count = word_count();
+				result.resize(count);
+
+				if (count > 0)
+					match_words(required, excluded, &result[0], 0, count);
+			}
+
+			template <typename Names>
+			void match(const flag_set<Enum, Size, Names>& required, const flag_set<Enum, Size, Names>& excluded, std::vector<word_type>& result) const
+			{
+				match(required.container(), excluded.container(), result);
+			}
+
+			/**
+			 * Finds the rows that have all the required flags and none of the excluded flags.
+			 *
+			 * \param required The flags that must be set.
+			 * \param excluded The flags that must be cleared.
+			 * \param result The indices of the matching rows are appended to the vector.
+			 */
+			void match_indices(const mask_type& required, const mask_type& excluded, std::vector<std::int32_t>& result) const
+			{
+				word_type block[block_words];
+
+				for (std::int32_t start = 0; start < word_count(); start += block_words)
+				{
+					const std::int32_t count = match_words(required, excluded, block, start, block_words);
+
+					detail::for_each_word_bit(block, count, append_row(result, start * word_bits));
+				}
+			}
+
+			template <typename Names>
+			void match_indices(const flag_set<Enum, Size, Names>& required, const flag_set<Enum, Size, Names>& excluded, std::vector<std::int32_t>& result) const
+			{
+				match_indices(required.container(), excluded.container(), result);
+			}
+
+			/**
+			 * Counts the rows that have all the required flags and none of the excluded flags.
+			 *
+			 * \param required The flags that must be set.
+			 * \param excluded The flags that must be cleared.
+			 * \returns The number of matching rows.
+			 */
+			std::int32_t count_matching(const mask_type& required, const mask_type& excluded) const
+			{
+				word_type block[block_words];
+				std::int32_t total = 0;
+
+				for (std::int32_t start = 0; start < word_count(); start += block_words)
+				{
+					const std::int32_t count = match_words(required, excluded, block, start, block_words);
+
+					total += detail::count_words(block, count);
+				}
+
+				return total;
+			}
+
+			template <typename Names>
+			std::int32_t count_matching(const flag_set<Enum, Size, Names>& required, const flag_set<Enum, Size, Names>& excluded) const
+			{
+				return count_matching(required.container(), excluded.container());
+			}
+
+			/**
+			 * A reference to a single row of a flag_column.
+			 *
+			 * Provides the flag_set interface so code can move from an array
+			 * of flag_set to a flag_column.
+			 */
+			class row_reference
+			{
+				public:
+
+					row_reference(flag_column& column, std::int32_t row)
+					: _column(&column)
+					, _row(row)
+					{ }
+
+					void set(Enum flag)
+					{
+						_column->set(_row, flag);
+					}
+
+					void clear(Enum flag)
+					{
+						_column->clear(_row, flag);
+					}
+
+					void toggle(Enum flag)
+					{
+						_column->toggle(_row, flag);
+					}
+
+					bool is_set(Enum flag) const
+					{
+						return _column->is_set(_row, flag);
+					}
+
+					std::int32_t count() const
+					{
+						std::int32_t total = 0;
+
+						for (std::int32_t flag = 0; flag < Size; ++flag)
+							total += _column->is_set(_row, static_cast<Enum>(flag)) ? 1 : 0;
+
+						return total;
+					}
+
+					bool any() const
+					{
+						for (std::int32_t flag = 0; flag < Size; ++flag)
+						{
+							if (_column->is_set(_row, static_cast<Enum>(flag)))
+								return true;
+						}
+
+						return false;
+					}
+
+					bool none() const
+					{
+						return !any();
+					}
+
+					template <typename Names>
+					operator flag_set<Enum, Size, Names>() const
+					{
+						flag_set<Enum, Size, Names> flags;
+						_column->load(_row, flags);
+						return flags;
+					}
+
+					template <typename Names>
+					row_reference& operator= (const flag_set<Enum, Size, Names>& flags)
+					{
+						_column->store(_row, flags);
+						return *this;
+					}
+
+				private:
+
+					/// The column holding the row
+					flag_column* _column;
+					/// The index of the row
+					std::int32_t _row;
+
+			} ; // end class row_reference
+
+		private:
+
+			/// The number of words combined at a time when querying
+			static const std::int32_t block_words = 256;
+
+			/**
+			 * Appends the row of each bit to a vector.
+			 */
+			struct append_row
+			{
+				append_row(std::vector<std::int32_t>& rows, std::int32_t offset)
+				: _rows(rows)
+				, _offset(offset)
+				{ }
+
+				void operator() (std::int32_t location) const
+				{
+					_rows.push_back(_offset + location);
+				}
+
+				std::vector<std::int32_t>& _rows;
+				std::int32_t _offset;
+			} ;
+
+			/**
+			 * Computes the matching rows for a range of words.
+			 *
+			 * \param required The flags that must be set.
+			 * \param excluded The flags that must be cleared.
+			 * \param result The words to write to.
+			 * \param start The first word to compute.
+			 * \param count The maximum number of words to compute.
+			 * \returns The number of words written.
+			 */
+			std::int32_t match_words(const mask_type& required, const mask_type& excluded, word_type* result, std::int32_t start, std::int32_t count) const
+			{
+				const std::int32_t total = word_count();
+
+				if (start + count > total)
+					count = total - start;
+
+				std::int32_t first = detail::find_first(required);
+
+				if (first >= 0)
+				{
+					const word_type* words = plane(static_cast<Enum>(first)) + start;
+
+					for (std::int32_t i = 0; i < count; ++i)
+						result[i] = words[i];
+
+					for (std::int32_t flag = detail::find_next_word(detail::word_data(required), mask_type::word_count, first); flag >= 0; flag = detail::find_next_word(detail::word_data(required), mask_type::word_count, flag))
+						detail::transform_words<detail::and_op>(result, result, plane(static_cast<Enum>(flag)) + start, count);
+				}
+				else
+				{
+					for (std::int32_t i = 0; i < count; ++i)
+						result[i] = ~word_type(0);
+
+					// Only rows within the column can match
+					if ((start + count == total) && ((_rows & 63) != 0))
+						result[count - 1] = low_mask(_rows & 63);
+				}
+
+				for (std::int32_t flag = detail::find_first(excluded); flag >= 0; flag = detail::find_next_word(detail::word_data(excluded), mask_type::word_count, flag))
+					detail::transform_words<detail::andnot_op>(result, result, plane(static_cast<Enum>(flag)) + start, count);
+
+				return count;
+			}
+
+			std::int32_t word_index(std::int32_t row) const
+			{
+				RECHARGEABLE_ASSERT((row >= 0) && (row < _rows), "Invalid row");
+
+				return row >> 6;
+			}
+
+			static word_type bit_mask(std::int32_t row)
+			{
+				return word_type(1) << (row & 63);
+			}
+
+			static word_type low_mask(std::int32_t bits)
+			{
+				return (word_type(1) << bits) - 1;
+			}
+
+			/// The number of rows
+			std::int32_t _rows;
+			/// The number of words between planes
+			std::int32_t _stride;
+			/// The bit-planes
+			std::vector<word_type> _planes;
+
+	} ; // end class flag_column<Enum, Size>
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_COLUMN_HPP_INCLUDED
@@ -0,0 +1,405 @@
+/**
+ * \file flag_delta.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_DELTA_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_DELTA_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/detail/varint.hpp>
+
+namespace rtl
+{
+	//----------------------------------------------------------------------
+	// Encoding
+	//
+	// A delta holds the bits that changed between two snapshots. It is
+	// written in whichever of two forms is smaller:
+	//
+	//   sparse: varint (changed << 1), then a varint gap before each
+	//           changed bit
+	//   raw:    byte 0x01, then the changed mask as (Size + 7) / 8 bytes
+	//
+	// An empty delta is the single byte 0x00. Applying a delta toggles
+	// the changed bits of the base.
+	//----------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * Encodes the difference between two arrays of words.
+		 *
+		 * \tparam Word The type of word.
+		 * \param previous The previous words.
+		 * \param current The current words.
+		 * \param count The number of words.
+		 * \param size The number of bits in use.
+		 * \param out The buffer to write to.
+		 * \returns The position after the written bytes.
+		 */
+		template <typename Word>
+		std::uint8_t* encode_delta_words(const Word* previous, const Word* current, std::int32_t count, std::int32_t size, std::uint8_t* out)
+		{
+			const std::int32_t word_bits = sizeof(Word) * 8;
+			const std::size_t rawBytes = 1 + ((size + 7) / 8);
+
+			// Size the sparse form, stopping once the raw form is smaller
+			std::uint64_t changed = 0;
+			std::size_t sparseBytes = 0;
+			std::int32_t last = -1;
+
+			for (std::int32_t i = 0; (i < count) && (sparseBytes < rawBytes); ++i)
+			{
+				std::uint64_t diff = previous[i] ^ current[i];
+
+				while (diff != 0)
+				{
+					const std::int32_t location = (i * word_bits) + count_trailing_zeros(diff);
+
+					sparseBytes += varint_size(location - last - 1);
+					last = location;
+					++changed;
+
+					diff &= diff - 1;
+				}
+			}
+
+			if (changed == 0)
+			{
+				*out++ = 0;
+				return out;
+			}
+
+			sparseBytes += varint_size(changed << 1);
+
+			if (sparseBytes < rawBytes)
+			{
+				out = write_varint(out, changed << 1);
+				last = -1;
+
+				for (std::int32_t i = 0; i < count; ++i)
+				{
+					std::uint64_t diff = previous[i] ^ current[i];
+
+					while (diff != 0)
+					{
+						const std::int32_t location = (i * word_bits) + count_trailing_zeros(diff);
+
+						out = write_varint(out, location - last - 1);
+						last = location;
+
+						diff &= diff - 1;
+					}
+				}
+			}
+			else
+			{
+				*out++ = 1;
+
+				for (std::size_t byte = 0; byte < rawBytes - 1; ++byte)
+				{
+					const std::size_t word = (byte * 8) / word_bits;
+					const std::int32_t shift = static_cast<std::int32_t>((byte * 8) % word_bits);
+
+					*out++ = static_cast<std::uint8_t>(static_cast<std::uint64_t>(previous[word] ^ current[word]) >> shift);
+				}
+			}
+
+			return out;
+		}
+
+		/**
+		 * Applies an encoded delta to an array of words.
+		 *
+		 * \tparam Word The type of word.
+		 * \param words The words to modify.
+		 * \param size The number of bits in use.
+		 * \param in The buffer to read from.
+		 * \param end The end of the buffer.
+		 * \returns The position after the read bytes, or nullptr if the delta is malformed.
+		 */
+		template <typename Word>
+		const std::uint8_t* apply_delta_words(Word* words, std::int32_t size, const std::uint8_t* in, const std::uint8_t* end)
+		{
+			const std::int32_t word_bits = sizeof(Word) * 8;
+
+			std::uint64_t header;
+			in = read_varint(in, end, header);
+
+			if (in == nullptr)
+				return nullptr;
+
+			if (header == 1)
+			{
+				const std::size_t rawBytes = (size + 7) / 8;
+
+				if (static_cast<std::size_t>(end - in) < rawBytes)
+					return nullptr;
+
+				// Bits past the end of the set must not be changed
+				if (((size & 7) != 0) && ((in[rawBytes - 1] >> (size & 7)) != 0))
+					return nullptr;
+
+				for (std::size_t byte = 0; byte < rawBytes; ++byte)
+				{
+					const std::size_t word = (byte * 8) / word_bits;
+					const std::int32_t shift = static_cast<std::int32_t>((byte * 8) % word_bits);
+
+					words[word] ^= static_cast<Word>(static_cast<std::uint64_t>(in[byte]) << shift);
+				}
+
+				return in + rawBytes;
+			}
+
+			if ((header & 1) != 0)
+				return nullptr;
+
+			const std::uint64_t changed = header >> 1;
+
+			if (changed > static_cast<std::uint64_t>(size))
+				return nullptr;
+
+			std::uint64_t location = ~std::uint64_t(0);
+
+			for (std::uint64_t i = 0; i < changed; ++i)
+			{
+				std::uint64_t gap;
+				in = read_varint(in, end, gap);
+
+				if ((in == nullptr) || (gap >= static_cast<std::uint64_t>(size)))
+					return nullptr;
+
+				location += gap + 1;
+
+				if (location >= static_cast<std::uint64_t>(size))
+					return nullptr;
+
+				words[location / word_bits] ^= static_cast<Word>(Word(1) << (location % word_bits));
+			}
+
+			return in;
+		}
+
+	} // end namespace detail
+
+	/**
+	 * Gets the sizes of encoded deltas for a flag_set.
+	 *
+	 * \tparam FlagSet The type of flag_set.
+	 */
+	template <typename FlagSet>
+	struct flag_delta_traits;
+
+	template <typename Enum, std::int32_t Size, typename Names>
+	struct flag_delta_traits<flag_set<Enum, Size, Names> >
+	{
+		/// The largest number of bytes used to encode a single delta
+		static const std::size_t max_size = 1 + ((Size + 7) / 8);
+
+		/**
+		 * Gets the largest number of bytes used to encode a batch of deltas.
+		 *
+		 * \param count The number of flag_sets in the batch.
+		 * \returns The largest encoded size.
+		 */
+		static constexpr std::size_t max_batch_size(std::size_t count)
+		{
+			return (2 * detail::max_varint_size) + (count * (max_size + 2));
+		}
+
+	} ; // end struct flag_delta_traits
+
+	/**
+	 * Gets the flags that differ between two snapshots.
+	 *
+	 * \param previous The previous snapshot.
+	 * \param current The current snapshot.
+	 * \returns The changed flags.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	constexpr flag_set<Enum, Size, Names> changed_flags(const flag_set<Enum, Size, Names>& previous, const flag_set<Enum, Size, Names>& current)
+	{
+		return previous ^ current;
+	}
+
+	/**
+	 * Encodes the difference between two snapshots.
+	 *
+	 * \param previous The snapshot known to the receiver.
+	 * \param current The snapshot to send.
+	 * \param out The buffer to write to. Must hold flag_delta_traits::max_size bytes.
+	 * \returns The number of bytes written.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	std::size_t encode_delta(const flag_set<Enum, Size, Names>& previous, const flag_set<Enum, Size, Names>& current, std::uint8_t* out)
+	{
+		typedef typename flag_set<Enum, Size, Names>::container_type container_type;
+
+		return detail::encode_delta_words(
+			detail::word_data(previous.container()),
+			detail::word_data(current.container()),
+			container_type::word_count,
+			Size,
+			out) - out;
+	}
+
+	/**
+	 * Applies an encoded delta to a snapshot.
+	 *
+	 * \param flags The snapshot to modify. Left unchanged if the delta is malformed.
+	 * \param in The buffer to read from.
+	 * \param size The size of the buffer.
+	 * \returns The number of bytes read, or 0 if the delta is malformed.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	std::size_t apply_delta(flag_set<Enum, Size, Names>& flags, const std::uint8_t* in, std::size_t size)
+	{
+		flag_set<Enum, Size, Names> result(flags);
+
+		const std::uint8_t* end = detail::apply_delta_words(detail::word_data(result.container()), Size, in, in + size);
+
+		if (end == nullptr)
+			return 0;
+
+		flags = result;
+
+		return end - in;
+	}
+
+	//----------------------------------------------------------------------
+	// Batch encoding
+	//
+	// A batch starts with a varint count of snapshots. Each changed
+	// snapshot is written as a varint of the unchanged snapshots skipped
+	// before it followed by its delta. When the last snapshots are
+	// unchanged a final skip reaches the end of the batch.
+	//----------------------------------------------------------------------
+
+	/**
+	 * Encodes the differences between two arrays of snapshots.
+	 *
+	 * \param previous The snapshots known to the receiver.
+	 * \param current The snapshots to send.
+	 * \param count The number of snapshots.
+	 * \param out The buffer to write to. Must hold flag_delta_traits::max_batch_size(count) bytes.
+	 * \returns The number of bytes written.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	std::size_t encode_deltas(const flag_set<Enum, Size, Names>* previous, const flag_set<Enum, Size, Names>* current, std::size_t count, std::uint8_t* out)
+	{
+		typedef typename flag_set<Enum, Size, Names>::container_type container_type;
+
+		std::uint8_t* position = detail::write_varint(out, count);
+		std::size_t skipped = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (previous[i] == current[i])
+			{
+				++skipped;
+				continue;
+			}
+
+			position = detail::write_varint(position, skipped);
+			position = detail::encode_delta_words(
+				detail::word_data(previous[i].container()),
+				detail::word_data(current[i].container()),
+				container_type::word_count,
+				Size,
+				position);
+
+			skipped = 0;
+		}
+
+		if (skipped != 0)
+			position = detail::write_varint(position, skipped);
+
+		return position - out;
+	}
+
+	/**
+	 * Applies a batch of encoded deltas to an array of snapshots.
+	 *
+	 * The snapshots are modified in place as the batch is read. If the
+	 * batch is malformed the snapshots read before the error, and the
+	 * one holding it, may already have been modified.
+	 *
+	 * \param flags The snapshots to modify.
+	 * \param count The number of snapshots. Must match the encoded count.
+	 * \param in The buffer to read from.
+	 * \param size The size of the buffer.
+	 * \returns The number of bytes read, or 0 if the batch is malformed.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	std::size_t apply_deltas(flag_set<Enum, Size, Names>* flags, std::size_t count, const std::uint8_t* in, std::size_t size)
+	{
+		const std::uint8_t* end = in + size;
+
+		std::uint64_t encodedCount;
+		const std::uint8_t* position = detail::read_varint(in, end, encodedCount);
+
+		if ((position == nullptr) || (encodedCount != count))
+			return 0;
+
+		std::size_t index = 0;
+
+		while (index < count)
+		{
+			std::uint64_t skipped;
+			position = detail::read_varint(position, end, skipped);
+
+			if ((position == nullptr) || (skipped > count - index))
+				return 0;
+
+			index += static_cast<std::size_t>(skipped);
+
+			if (index == count)
+				break;
+
+			position = detail::apply_delta_words(detail::word_data(flags[index].container()), Size, position, end);
+
+			if (position == nullptr)
+				return 0;
+
+			++index;
+		}
+
+		return position - in;
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_DELTA_HPP_INCLUDED
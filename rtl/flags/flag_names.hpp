@@ -0,0 +1,524 @@
+/**
+ * \file flag_names.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_NAMES_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_NAMES_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/detail/hash.hpp>
+
+namespace rtl
+{
+	namespace detail
+	{
+		/**
+		 * Rounds a value up to a power of two.
+		 *
+		 * \param value The value to round.
+		 * \returns The smallest power of two not less than the value.
+		 */
+		constexpr std::int32_t next_power_of_two(std::int32_t value)
+		{
+			std::int32_t result = 1;
+
+			while (result < value)
+				result <<= 1;
+
+			return result;
+		}
+
+		/**
+		 * Reports a name table holding the same name twice.
+		 *
+		 * Not constexpr, so reaching it while building a table at compile
+		 * time is a compile error naming this function. At runtime it
+		 * asserts and the table reports that it is not valid.
+		 */
+		inline void duplicate_flag_name()
+		{
+			RECHARGEABLE_ASSERT(false, "Duplicate flag name");
+		}
+
+		/**
+		 * Determines whether a character is whitespace.
+		 */
+		constexpr bool is_name_space(char c)
+		{
+			return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+		}
+
+	} // end namespace detail
+
+	/**
+	 * Maps flag names to bits with a perfect hash built at compile time.
+	 *
+	 * The names are hashed once. The hash selects a bucket holding a
+	 * displacement, and the hash rehashed with the displacement selects the
+	 * single slot that can hold the name, so a lookup is a hash, two table
+	 * reads and one string compare. The displacements are found by the constructor,
+	 * which is constexpr so the table can be built during compilation.
+	 *
+	 * \code
+	 * constexpr const char* status_names[] = { "Burning", "Frozen", "Poisoned" };
+	 * constexpr rtl::flag_name_table<3> status_table(status_names);
+	 * \endcode
+	 *
+	 * Names must be unique. The name at index i names bit i. A table
+	 * built at compile time from repeated names does not compile. One
+	 * built at runtime is not valid, so find never matches and parse
+	 * always fails.
+	 *
+	 * \tparam Count The number of names.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <std::int32_t Count>
+	class flag_name_table
+	{
+		public:
+
+			static_assert(Count > 0, "A name table requires at least one name");
+
+			/// The number of displacement buckets
+			static const std::int32_t bucket_count = (Count + 1) / 2;
+			/// The number of slots, keeping the table at most half full
+			static const std::int32_t slot_count = detail::next_power_of_two(Count * 2);
+			/// The number of displacements tried before placing a bucket fails
+			static const std::uint32_t max_displacement = 4096;
+
+			/**
+			 * Creates an instance of the flag_name_table class.
+			 *
+			 * \param names The names of the flags. Must outlive the table.
+			 */
+			constexpr explicit flag_name_table(const char* const (&names)[Count])
+			: _names()
+			, _lengths()
+			, _displacements()
+			, _slots()
+			, _valid(true)
+			{
+				std::uint64_t hashes[Count] = { };
+				std::int32_t bucketSizes[bucket_count] = { };
+				std::int32_t bucketStarts[bucket_count + 1] = { };
+				std::int32_t order[Count] = { };
+
+				for (std::int32_t i = 0; i < Count; ++i)
+				{
+					std::size_t length = 0;
+
+					while (names[i][length] != '\0')
+						++length;
+
+					_names[i] = names[i];
+					_lengths[i] = length;
+
+					hashes[i] = hash(names[i], length);
+					++bucketSizes[bucket(hashes[i])];
+				}
+
+				for (std::int32_t i = 0; i < slot_count; ++i)
+					_slots[i] = -1;
+
+				// Identical names hash identically and can never be placed
+				for (std::int32_t i = 1; i < Count; ++i)
+				{
+					for (std::int32_t j = 0; j < i; ++j)
+					{
+						if ((hashes[i] == hashes[j]) && same_name(names[i], _lengths[i], names[j], _lengths[j]))
+						{
+							_valid = false;
+							detail::duplicate_flag_name();
+							return;
+						}
+					}
+				}
+
+				// Group the names by bucket
+				for (std::int32_t i = 0; i < bucket_count; ++i)
+					bucketStarts[i + 1] = bucketStarts[i] + bucketSizes[i];
+
+				std::int32_t positions[bucket_count] = { };
+
+				for (std::int32_t i = 0; i < Count; ++i)
+				{
+					const std::int32_t b = bucket(hashes[i]);
+					order[bucketStarts[b] + positions[b]++] = i;
+				}
+
+				// Place the largest buckets first while the table is emptiest
+				std::int32_t largest = 0;
+
+				for (std::int32_t i = 0; i < bucket_count; ++i)
+					largest = (bucketSizes[i] > largest) ? bucketSizes[i] : largest;
+
+				for (std::int32_t size = largest; size > 0; --size)
+				{
+					for (std::int32_t b = 0; b < bucket_count; ++b)
+					{
+						if (bucketSizes[b] == size)
+							place_bucket(b, hashes, order + bucketStarts[b], size);
+					}
+				}
+			}
+
+			/**
+			 * Gets the number of names.
+			 *
+			 * \returns The number of names.
+			 */
+			static constexpr std::int32_t size()
+			{
+				return Count;
+			}
+
+			/**
+			 * Determines whether every name was placed in the table.
+			 *
+			 * \returns \b true \b if the names are unique; \b false \b otherwise.
+			 */
+			constexpr bool valid() const
+			{
+				return _valid;
+			}
+
+			/**
+			 * Finds the bit with a name.
+			 *
+			 * \param name The name to find. Does not need to be null terminated.
+			 * \param length The length of the name.
+			 * \returns The bit with the name, or -1 if no flag has the name or the table is not valid.
+			 */
+			constexpr std::int32_t find(const char* name, std::size_t length) const
+			{
+				if (!_valid)
+					return -1;
+
+				const std::uint64_t value = hash(name, length);
+				const std::int32_t index = _slots[slot(value, _displacements[bucket(value)])];
+
+				if ((index < 0) || !same_name(_names[index], _lengths[index], name, length))
+					return -1;
+
+				return index;
+			}
+
+			/**
+			 * Gets the name of a bit.
+			 *
+			 * \param bit The bit.
+			 * \returns The null terminated name of the bit.
+			 */
+			constexpr const char* name(std::int32_t bit) const
+			{
+				RECHARGEABLE_ASSERT((bit >= 0) && (bit < Count), "Invalid bit");
+
+				return _names[bit];
+			}
+
+			/**
+			 * Gets the length of the name of a bit.
+			 *
+			 * \param bit The bit.
+			 * \returns The length of the name.
+			 */
+			constexpr std::size_t name_length(std::int32_t bit) const
+			{
+				RECHARGEABLE_ASSERT((bit >= 0) && (bit < Count), "Invalid bit");
+
+				return _lengths[bit];
+			}
+
+		private:
+
+			static constexpr std::uint64_t hash(const char* name, std::size_t length)
+			{
+				return detail::mix_hash(detail::fnv1a(name, length, detail::fnv1a_basis));
+			}
+
+			static constexpr bool same_name(const char* lhs, std::size_t lhsLength, const char* rhs, std::size_t rhsLength)
+			{
+				if (lhsLength != rhsLength)
+					return false;
+
+				for (std::size_t i = 0; i < lhsLength; ++i)
+				{
+					if (lhs[i] != rhs[i])
+						return false;
+				}
+
+				return true;
+			}
+
+			static constexpr std::int32_t bucket(std::uint64_t value)
+			{
+				return static_cast<std::int32_t>(value % bucket_count);
+			}
+
+			static constexpr std::int32_t slot(std::uint64_t value, std::uint32_t displacement)
+			{
+				// Each displacement rehashes the name to an independent slot
+				return static_cast<std::int32_t>(detail::mix_hash(value + (displacement * 0x9e3779b97f4a7c15ull)) & (slot_count - 1));
+			}
+
+			/**
+			 * Finds a displacement placing every name of a bucket in a free slot.
+			 *
+			 * \param b The bucket.
+			 * \param hashes The hashes of all the names.
+			 * \param members The names in the bucket.
+			 * \param size The number of names in the bucket.
+			 */
+			constexpr void place_bucket(std::int32_t b, const std::uint64_t* hashes, const std::int32_t* members, std::int32_t size)
+			{
+				for (std::uint32_t displacement = 0; displacement < max_displacement; ++displacement)
+				{
+					bool placed = true;
+
+					for (std::int32_t i = 0; (i < size) && placed; ++i)
+					{
+						const std::int32_t target = slot(hashes[members[i]], displacement);
+
+						placed = _slots[target] < 0;
+
+						// Names within the bucket must not collide with each other
+						for (std::int32_t j = 0; (j < i) && placed; ++j)
+							placed = slot(hashes[members[j]], displacement) != target;
+					}
+
+					if (placed)
+					{
+						for (std::int32_t i = 0; i < size; ++i)
+							_slots[slot(hashes[members[i]], displacement)] = members[i];
+
+						_displacements[b] = displacement;
+						return;
+					}
+				}
+
+				// Distinct names that still cannot be placed
+				_valid = false;
+				detail::duplicate_flag_name();
+			}
+
+			/// The names indexed by bit
+			const char* _names[Count];
+			/// The lengths of the names
+			std::size_t _lengths[Count];
+			/// The displacement of each bucket
+			std::uint32_t _displacements[bucket_count];
+			/// The bit held in each slot, or -1 if empty
+			std::int32_t _slots[slot_count];
+			/// Whether every name was placed
+			bool _valid;
+
+	} ; // end class flag_name_table
+
+	//----------------------------------------------------------------------
+	// Formatting
+	//----------------------------------------------------------------------
+
+	/**
+	 * Writes the names of the flags that are set.
+	 *
+	 * The names are written in bit order and separated by the separator,
+	 * for example "Burning|Poisoned". Flags without a name are written as
+	 * their bit number. Like snprintf the output is truncated to fit and
+	 * always null terminated when size is not zero.
+	 *
+	 * \param flags The flags to write.
+	 * \param table The names of the flags.
+	 * \param buffer The buffer to write to.
+	 * \param size The size of the buffer.
+	 * \param separator The character between names.
+	 * \returns The length of the full string, not counting the null terminator.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t Count>
+	std::size_t to_string(const flag_set<Enum, Size, Names>& flags, const flag_name_table<Count>& table, char* buffer, std::size_t size, char separator = '|')
+	{
+		static_assert(Count <= Size, "The name table holds more names than there are flags");
+
+		std::size_t length = 0;
+
+		const auto append = [&](const char* text, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i, ++length)
+			{
+				if (length + 1 < size)
+					buffer[length] = text[i];
+			}
+		};
+
+		for (typename flag_set<Enum, Size, Names>::iterator itr = flags.begin(); itr != flags.end(); ++itr)
+		{
+			const std::int32_t bit = static_cast<std::int32_t>(*itr);
+
+			if (length != 0)
+				append(&separator, 1);
+
+			if (bit < Count)
+			{
+				append(table.name(bit), table.name_length(bit));
+			}
+			else
+			{
+				char digits[12];
+				std::size_t count = 0;
+
+				for (std::int32_t value = bit; value != 0 || count == 0; value /= 10)
+					digits[sizeof(digits) - ++count] = static_cast<char>('0' + (value % 10));
+
+				append(digits + sizeof(digits) - count, count);
+			}
+		}
+
+		if (size != 0)
+			buffer[(length < size) ? length : size - 1] = '\0';
+
+		return length;
+	}
+
+	//----------------------------------------------------------------------
+	// Parsing
+	//----------------------------------------------------------------------
+
+	/**
+	 * Reads a list of flag names.
+	 *
+	 * Names are separated by the separator and may be surrounded by
+	 * whitespace. A bit number is accepted in place of a name. An empty
+	 * or all whitespace string is an empty set. No memory is allocated.
+	 * Nothing is read with a table that is not valid.
+	 *
+	 * \param text The text to read. Does not need to be null terminated.
+	 * \param length The length of the text.
+	 * \param table The names of the flags.
+	 * \param flags The flags read. Left unchanged if the text is invalid.
+	 * \param separator The character between names.
+	 * \returns \b true \b if every name was recognized; \b false \b otherwise.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t Count>
+	bool parse(const char* text, std::size_t length, const flag_name_table<Count>& table, flag_set<Enum, Size, Names>& flags, char separator = '|')
+	{
+		static_assert(Count <= Size, "The name table holds more names than there are flags");
+
+		if (!table.valid())
+			return false;
+
+		flag_set<Enum, Size, Names> result;
+
+		const char* position = text;
+		const char* const end = text + length;
+
+		while ((position != end) && detail::is_name_space(*position))
+			++position;
+
+		if (position == end)
+		{
+			flags = result;
+			return true;
+		}
+
+		while (true)
+		{
+			const char* first = position;
+
+			while ((position != end) && (*position != separator))
+				++position;
+
+			const char* last = position;
+
+			while ((first != last) && detail::is_name_space(*first))
+				++first;
+
+			while ((last != first) && detail::is_name_space(*(last - 1)))
+				--last;
+
+			if (first == last)
+				return false;
+
+			std::int32_t bit = table.find(first, static_cast<std::size_t>(last - first));
+
+			if ((bit < 0) && (*first >= '0') && (*first <= '9') && (last - first <= 10))
+			{
+				std::int64_t value = 0;
+
+				for (const char* digit = first; (digit != last) && (value >= 0); ++digit)
+					value = ((*digit >= '0') && (*digit <= '9')) ? (value * 10) + (*digit - '0') : -1;
+
+				bit = (value < Size) ? static_cast<std::int32_t>(value) : -1;
+			}
+
+			if (bit < 0)
+				return false;
+
+			result.set(static_cast<Enum>(bit));
+
+			if (position == end)
+				break;
+
+			++position;
+		}
+
+		flags = result;
+		return true;
+	}
+
+	/**
+	 * Reads a null terminated list of flag names.
+	 *
+	 * \param text The null terminated text to read.
+	 * \param table The names of the flags.
+	 * \param flags The flags read. Left unchanged if the text is invalid.
+	 * \param separator The character between names.
+	 * \returns \b true \b if every name was recognized; \b false \b otherwise.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t Count>
+	bool parse(const char* text, const flag_name_table<Count>& table, flag_set<Enum, Size, Names>& flags, char separator = '|')
+	{
+		std::size_t length = 0;
+
+		while (text[length] != '\0')
+			++length;
+
+		return parse(text, length, table, flags, separator);
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_NAMES_HPP_INCLUDED
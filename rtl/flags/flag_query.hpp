@@ -0,0 +1,549 @@
+/**
+ * \file flag_query.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_QUERY_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_QUERY_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * A predicate over a flag_set folded into mask comparisons.
+	 *
+	 * The predicate holds true when (value & mask) == expect and, for
+	 * each of the AnyCount groups, at least one flag of the group is set.
+	 * Every has, lacks, all and none term of a query folds into the single
+	 * mask and expect pair so a query of only those terms is one masked
+	 * compare per word. A contradictory query such as has(A) & lacks(A)
+	 * leaves a bit in expect that is not in mask so it never matches.
+	 *
+	 * Predicates are created from a query with make_predicate and can be
+	 * built at compile time. !has(A) is the same term as lacks(A), but a
+	 * query starting with it, such as !has(A) & has(B), is warned about
+	 * by GCC's -Wparentheses, so lacks is the spelling for exclusions.
+	 *
+	 * \code
+	 * using namespace rtl::query;
+	 *
+	 * constexpr auto burning = rtl::make_predicate<status_set>(lacks(Frozen) & has(Burning) & any(Poisoned, Bleeding));
+	 *
+	 * if (burning(flags)) { ... }
+	 * \endcode
+	 *
+	 * \tparam FlagSet The type of flag_set.
+	 * \tparam AnyCount The number of groups of which any flag must be set.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename FlagSet, std::int32_t AnyCount>
+	class flag_predicate
+	{
+		public:
+
+			typedef typename FlagSet::container_type container_type;
+			typedef typename container_type::word_type word_type;
+
+			/**
+			 * Creates an instance of the flag_predicate class that matches everything.
+			 */
+			constexpr flag_predicate()
+			: _mask()
+			, _expect()
+			, _any()
+			{ }
+
+			/**
+			 * Determines whether a flag_set matches the predicate.
+			 *
+			 * \param flags The flags to test.
+			 * \returns \b true \b if the flags match; \b false \b otherwise.
+			 */
+			constexpr bool operator() (const FlagSet& flags) const
+			{
+				const word_type* value = detail::word_data(flags.container());
+				const word_type* mask = detail::word_data(_mask);
+				const word_type* expect = detail::word_data(_expect);
+
+				word_type difference = 0;
+
+				for (std::int32_t i = 0; i < container_type::word_count; ++i)
+					difference |= static_cast<word_type>((value[i] & mask[i]) ^ expect[i]);
+
+				if (difference != 0)
+					return false;
+
+				for (std::int32_t group = 0; group < AnyCount; ++group)
+				{
+					const word_type* any = detail::word_data(_any[group]);
+
+					word_type common = 0;
+
+					for (std::int32_t i = 0; i < container_type::word_count; ++i)
+						common |= static_cast<word_type>(value[i] & any[i]);
+
+					if (common == 0)
+						return false;
+				}
+
+				return true;
+			}
+
+			//----------------------------------------------------------------------
+			// Construction
+			//
+			// Called by the query terms while folding a query.
+			//----------------------------------------------------------------------
+
+			/**
+			 * Requires a flag to be set.
+			 *
+			 * \param location The bit of the flag.
+			 */
+			constexpr void require(std::int32_t location)
+			{
+				// A contradiction stays a contradiction
+				if (!detail::is_bit_set(_mask, location) && detail::is_bit_set(_expect, location))
+					return;
+
+				// A flag already excluded is a contradiction
+				if (detail::is_bit_set(_mask, location) && !detail::is_bit_set(_expect, location))
+				{
+					detail::clear_bit(_mask, location);
+					detail::set_bit(_expect, location);
+					return;
+				}
+
+				detail::set_bit(_mask, location);
+				detail::set_bit(_expect, location);
+			}
+
+			/**
+			 * Requires a flag to be cleared.
+			 *
+			 * \param location The bit of the flag.
+			 */
+			constexpr void exclude(std::int32_t location)
+			{
+				// A flag already required is a contradiction
+				if (detail::is_bit_set(_expect, location))
+				{
+					detail::clear_bit(_mask, location);
+					return;
+				}
+
+				detail::set_bit(_mask, location);
+			}
+
+			/**
+			 * Adds a flag to a group of which any flag must be set.
+			 *
+			 * \param group The index of the group.
+			 * \param location The bit of the flag.
+			 */
+			constexpr void require_any(std::int32_t group, std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((group >= 0) && (group < AnyCount), "Invalid group");
+
+				detail::set_bit(_any[group], location);
+			}
+
+		private:
+
+			/// The bits that are compared
+			container_type _mask;
+			/// The expected value of the compared bits
+			container_type _expect;
+			/// The groups of which any bit must be set
+			container_type _any[AnyCount > 0 ? AnyCount : 1];
+
+	} ; // end class flag_predicate
+
+	namespace query
+	{
+		//----------------------------------------------------------------------
+		// Terms
+		//----------------------------------------------------------------------
+
+		/// Requires a flag to be set
+		template <typename Enum>
+		struct has_term
+		{
+			static const std::int32_t any_count = 0;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t&) const
+			{
+				predicate.require(static_cast<std::int32_t>(flag));
+			}
+
+			Enum flag;
+		} ;
+
+		/// Requires a flag to be cleared
+		template <typename Enum>
+		struct not_has_term
+		{
+			static const std::int32_t any_count = 0;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t&) const
+			{
+				predicate.exclude(static_cast<std::int32_t>(flag));
+			}
+
+			Enum flag;
+		} ;
+
+		/// Requires every flag of a group to be set
+		template <typename Enum, std::size_t Count>
+		struct all_term
+		{
+			static const std::int32_t any_count = 0;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t&) const
+			{
+				for (std::size_t i = 0; i < Count; ++i)
+					predicate.require(static_cast<std::int32_t>(flags[i]));
+			}
+
+			Enum flags[Count];
+		} ;
+
+		/// Requires every flag of a group to be cleared
+		template <typename Enum, std::size_t Count>
+		struct none_term
+		{
+			static const std::int32_t any_count = 0;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t&) const
+			{
+				for (std::size_t i = 0; i < Count; ++i)
+					predicate.exclude(static_cast<std::int32_t>(flags[i]));
+			}
+
+			Enum flags[Count];
+		} ;
+
+		/// Requires any flag of a group to be set
+		template <typename Enum, std::size_t Count>
+		struct any_term
+		{
+			static const std::int32_t any_count = 1;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t& group) const
+			{
+				for (std::size_t i = 0; i < Count; ++i)
+					predicate.require_any(group, static_cast<std::int32_t>(flags[i]));
+
+				++group;
+			}
+
+			Enum flags[Count];
+		} ;
+
+		/// Requires both terms to hold
+		template <typename Lhs, typename Rhs>
+		struct and_term
+		{
+			static const std::int32_t any_count = Lhs::any_count + Rhs::any_count;
+
+			template <typename Predicate>
+			constexpr void apply(Predicate& predicate, std::int32_t& group) const
+			{
+				lhs.apply(predicate, group);
+				rhs.apply(predicate, group);
+			}
+
+			Lhs lhs;
+			Rhs rhs;
+		} ;
+
+		/**
+		 * Determines whether a type is a query term.
+		 */
+		template <typename T> struct is_term : std::false_type { } ;
+		template <typename Enum> struct is_term<has_term<Enum> > : std::true_type { } ;
+		template <typename Enum> struct is_term<not_has_term<Enum> > : std::true_type { } ;
+		template <typename Enum, std::size_t Count> struct is_term<all_term<Enum, Count> > : std::true_type { } ;
+		template <typename Enum, std::size_t Count> struct is_term<none_term<Enum, Count> > : std::true_type { } ;
+		template <typename Enum, std::size_t Count> struct is_term<any_term<Enum, Count> > : std::true_type { } ;
+		template <typename Lhs, typename Rhs> struct is_term<and_term<Lhs, Rhs> > : std::true_type { } ;
+
+		//----------------------------------------------------------------------
+		// Term creation
+		//----------------------------------------------------------------------
+
+		/**
+		 * Requires a flag to be set.
+		 */
+		template <typename Enum, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+		constexpr has_term<Enum> has(Enum flag)
+		{
+			return has_term<Enum> { flag };
+		}
+
+		/**
+		 * Requires a flag to be cleared.
+		 */
+		template <typename Enum, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+		constexpr not_has_term<Enum> lacks(Enum flag)
+		{
+			return not_has_term<Enum> { flag };
+		}
+
+		/**
+		 * Requires every flag to be set.
+		 */
+		template <typename Enum, typename... Flags, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+		constexpr all_term<Enum, sizeof...(Flags) + 1> all(Enum flag, Flags... flags)
+		{
+			return all_term<Enum, sizeof...(Flags) + 1> { { flag, flags... } };
+		}
+
+		/**
+		 * Requires every flag to be cleared.
+		 */
+		template <typename Enum, typename... Flags, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+		constexpr none_term<Enum, sizeof...(Flags) + 1> none(Enum flag, Flags... flags)
+		{
+			return none_term<Enum, sizeof...(Flags) + 1> { { flag, flags... } };
+		}
+
+		/**
+		 * Requires any of the flags to be set.
+		 */
+		template <typename Enum, typename... Flags, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+		constexpr any_term<Enum, sizeof...(Flags) + 1> any(Enum flag, Flags... flags)
+		{
+			return any_term<Enum, sizeof...(Flags) + 1> { { flag, flags... } };
+		}
+
+		//----------------------------------------------------------------------
+		// Negation
+		//
+		// Only negations that keep the query a conjunction of mask
+		// comparisons are provided. A negated conjunction does not
+		// compile.
+		//----------------------------------------------------------------------
+
+		template <typename Enum>
+		constexpr not_has_term<Enum> operator! (const has_term<Enum>& term)
+		{
+			return not_has_term<Enum> { term.flag };
+		}
+
+		template <typename Enum>
+		constexpr has_term<Enum> operator! (const not_has_term<Enum>& term)
+		{
+			return has_term<Enum> { term.flag };
+		}
+
+		template <typename Enum, std::size_t Count>
+		constexpr none_term<Enum, Count> operator! (const any_term<Enum, Count>& term)
+		{
+			none_term<Enum, Count> result = { };
+
+			for (std::size_t i = 0; i < Count; ++i)
+				result.flags[i] = term.flags[i];
+
+			return result;
+		}
+
+		template <typename Enum, std::size_t Count>
+		constexpr any_term<Enum, Count> operator! (const none_term<Enum, Count>& term)
+		{
+			any_term<Enum, Count> result = { };
+
+			for (std::size_t i = 0; i < Count; ++i)
+				result.flags[i] = term.flags[i];
+
+			return result;
+		}
+
+		//----------------------------------------------------------------------
+		// Combination
+		//----------------------------------------------------------------------
+
+		/**
+		 * Requires both terms to hold.
+		 */
+		template <typename Lhs, typename Rhs, typename = typename std::enable_if<is_term<Lhs>::value && is_term<Rhs>::value>::type>
+		constexpr and_term<Lhs, Rhs> operator& (const Lhs& lhs, const Rhs& rhs)
+		{
+			return and_term<Lhs, Rhs> { lhs, rhs };
+		}
+
+		/**
+		 * Requires either flag to be set.
+		 */
+		template <typename Enum>
+		constexpr any_term<Enum, 2> operator| (const has_term<Enum>& lhs, const has_term<Enum>& rhs)
+		{
+			return any_term<Enum, 2> { { lhs.flag, rhs.flag } };
+		}
+
+		/**
+		 * Adds a flag to a group of which any flag must be set.
+		 */
+		template <typename Enum, std::size_t Count>
+		constexpr any_term<Enum, Count + 1> operator| (const any_term<Enum, Count>& lhs, const has_term<Enum>& rhs)
+		{
+			any_term<Enum, Count + 1> result = { };
+
+			for (std::size_t i = 0; i < Count; ++i)
+				result.flags[i] = lhs.flags[i];
+
+			result.flags[Count] = rhs.flag;
+
+			return result;
+		}
+
+		template <typename Enum, std::size_t Count>
+		constexpr any_term<Enum, Count + 1> operator| (const has_term<Enum>& lhs, const any_term<Enum, Count>& rhs)
+		{
+			return rhs | lhs;
+		}
+
+		/**
+		 * Joins two groups of which any flag must be set.
+		 */
+		template <typename Enum, std::size_t LhsCount, std::size_t RhsCount>
+		constexpr any_term<Enum, LhsCount + RhsCount> operator| (const any_term<Enum, LhsCount>& lhs, const any_term<Enum, RhsCount>& rhs)
+		{
+			any_term<Enum, LhsCount + RhsCount> result = { };
+
+			for (std::size_t i = 0; i < LhsCount; ++i)
+				result.flags[i] = lhs.flags[i];
+
+			for (std::size_t i = 0; i < RhsCount; ++i)
+				result.flags[LhsCount + i] = rhs.flags[i];
+
+			return result;
+		}
+
+	} // end namespace query
+
+	/**
+	 * Folds a query into a predicate.
+	 *
+	 * \tparam FlagSet The type of flag_set the predicate applies to.
+	 * \param term The query.
+	 * \returns The predicate.
+	 */
+	template <typename FlagSet, typename Term>
+	constexpr flag_predicate<FlagSet, Term::any_count> make_predicate(const Term& term)
+	{
+		static_assert(query::is_term<Term>::value, "Not a query term");
+
+		flag_predicate<FlagSet, Term::any_count> predicate;
+		std::int32_t group = 0;
+
+		term.apply(predicate, group);
+
+		return predicate;
+	}
+
+	//----------------------------------------------------------------------
+	// Batch queries
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the flag_sets in an array that match a predicate.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param predicate The predicate to match.
+	 * \returns The number of matching flag_sets.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t AnyCount>
+	inline std::size_t count_matching(const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_predicate<flag_set<Enum, Size, Names>, AnyCount>& predicate)
+	{
+		std::size_t total = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+			total += predicate(flags[i]) ? 1 : 0;
+
+		return total;
+	}
+
+	/**
+	 * Finds the flag_sets in an array that match a predicate.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param predicate The predicate to match.
+	 * \param result The indices of the matching flag_sets are appended to the vector.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t AnyCount>
+	inline void gather_matching(const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_predicate<flag_set<Enum, Size, Names>, AnyCount>& predicate, std::vector<std::int32_t>& result)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (predicate(flags[i]))
+				result.push_back(static_cast<std::int32_t>(i));
+		}
+	}
+
+	/**
+	 * Finds the flag_sets at a list of indices that match a predicate.
+	 *
+	 * \param flags The flag_sets to query.
+	 * \param indices The indices of the flag_sets to query.
+	 * \param indexCount The number of indices.
+	 * \param predicate The predicate to match.
+	 * \param result The matching indices are appended to the vector.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names, std::int32_t AnyCount>
+	inline void gather_matching(const flag_set<Enum, Size, Names>* flags, const std::int32_t* indices, std::size_t indexCount, const flag_predicate<flag_set<Enum, Size, Names>, AnyCount>& predicate, std::vector<std::int32_t>& result)
+	{
+		for (std::size_t i = 0; i < indexCount; ++i)
+		{
+			if (predicate(flags[indices[i]]))
+				result.push_back(indices[i]);
+		}
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_QUERY_HPP_INCLUDED
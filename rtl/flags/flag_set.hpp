@@ -39,6 +39,9 @@
 #define RECHARGEABLE_FLAG_SET_HPP_INCLUDED
 
 #include <rtl/flags/detail/bit_union.hpp>
+#include <rtl/flags/detail/bit_set_ops.hpp>
+#include <rtl/flags/detail/bit_iterator.hpp>
+#include <initializer_list>
 
 namespace rtl
 {
@@ -47,87 +50,414 @@ namespace rtl
 	{
 		private:
 
-			static const std::int32_t Bits = (((Size + 7) & ~7) >> 3) * 8;
+			static const std::int32_t Bits = detail::select_bits<Size>::value;
 
 		public:
 
 			typedef detail::bit_union<Bits, Names> union_type;
 			typedef detail::bit_set<Bits> container_type;
+			typedef typename container_type::word_type word_type;
+			typedef detail::set_bit_iterator<word_type, Enum> iterator;
+			typedef iterator const_iterator;
 
 			/**
 			 * Creates an instance of the flag_set class.
 			 *
 			 * All flags are initially cleared.
 			 */
-			flag_set()
+			constexpr flag_set()
+			: _set()
+			{ }
+
+			/**
+			 * Creates an instance of the flag_set class with the given flags set.
+			 *
+			 * \param flags The flags to set.
+			 */
+			constexpr flag_set(std::initializer_list<Enum> flags)
+			: _set()
 			{
-				clear_bit_set(_set);
+				for (const Enum* flag = flags.begin(); flag != flags.end(); ++flag)
+					set_bit(_set, *flag);
+			}
+
+			/**
+			 * Creates an instance of the flag_set class with the given flags set.
+			 *
+			 * \param flag The first flag to set.
+			 * \param flags The remaining flags to set.
+			 */
+			template <typename... Flags>
+			constexpr explicit flag_set(Enum flag, Flags... flags)
+			: _set()
+			{
+				const Enum list[] = { flag, flags... };
+
+				for (std::size_t i = 0; i < sizeof...(Flags) + 1; ++i)
+					set_bit(_set, list[i]);
 			}
 
-			flag_set(std::uint8_t value)
+			constexpr flag_set(std::uint8_t value)
+			: _set()
 			{
 				static_assert(Bits == 8, "The underlying container is not a uint8_t");
 
 				set_bit_values(_set, value);
 			}
 
-			flag_set(std::uint16_t value)
+			constexpr flag_set(std::uint16_t value)
+			: _set()
 			{
 				static_assert(Bits == 16, "The underlying container is not a uint16_t");
 
 				set_bit_values(_set, value);
 			}
 
-			flag_set(std::uint32_t value)
+			constexpr flag_set(std::uint32_t value)
+			: _set()
 			{
-				static_assert(Bits == 16, "The underlying container is not a uint32_t");
+				static_assert(Bits == 32, "The underlying container is not a uint32_t");
 
 				set_bit_values(_set, value);
 			}
 
+			constexpr flag_set(std::uint64_t value)
+			: _set()
+			{
+				static_assert(Bits == 64, "The underlying container is not a uint64_t");
+
+				set_bit_values(_set, value);
+			}
+
+			constexpr operator std::uint8_t() const
+			{
+				return get_bit_values(_set);
+			}
+
+			constexpr operator std::uint16_t() const
+			{
+				return get_bit_values(_set);
+			}
 
-			inline operator std::uint8_t() const
+			constexpr operator std::uint32_t() const
 			{
 				return get_bit_values(_set);
 			}
 
-			inline operator std::uint16_t() const
+			constexpr operator std::uint64_t() const
 			{
 				return get_bit_values(_set);
 			}
 
-			void set(Enum flag)
+			constexpr void set(Enum flag)
 			{
 				set_bit(_set, flag);
 			}
 
-			void set_values(std::uint8_t values)
+			constexpr void set_values(std::uint8_t values)
+			{
+				set_bit_values(_set, values);
+			}
+
+			constexpr void set_values(std::uint16_t values)
 			{
 				set_bit_values(_set, values);
 			}
 
-			void set_values(std::uint16_t values)
+			constexpr void set_values(std::uint32_t values)
 			{
 				set_bit_values(_set, values);
 			}
 
-			void clear(Enum flag)
+			constexpr void set_values(std::uint64_t values)
+			{
+				set_bit_values(_set, values);
+			}
+
+			constexpr void clear(Enum flag)
 			{
 				clear_bit(_set, flag);
 			}
 
-			void toggle(Enum flag)
+			constexpr void toggle(Enum flag)
 			{
 				toggle_bit(_set, flag);
 			}
 
-			bool is_set(Enum flag) const
+			constexpr bool is_set(Enum flag) const
 			{
 				return is_bit_set(_set, flag);
 			}
 
+			//----------------------------------------------------------------------
+			// Set algebra
+			//----------------------------------------------------------------------
+
+			constexpr flag_set operator& (const flag_set& rhs) const
+			{
+				flag_set result;
+				result.container() = container() & rhs.container();
+				return result;
+			}
+
+			constexpr flag_set operator| (const flag_set& rhs) const
+			{
+				flag_set result;
+				result.container() = container() | rhs.container();
+				return result;
+			}
+
+			constexpr flag_set operator^ (const flag_set& rhs) const
+			{
+				flag_set result;
+				result.container() = container() ^ rhs.container();
+				return result;
+			}
+
+			/**
+			 * Computes the complement of the flags.
+			 *
+			 * Only the flags within the enumeration are set in the result.
+			 *
+			 * \returns The flags that are not set.
+			 */
+			constexpr flag_set operator~ () const
+			{
+				flag_set result;
+				result.container() = ~container();
+
+				if (Size != Bits)
+				{
+					container_type mask = { };
+					detail::fill_bit_set(mask, Size);
+
+					result.container() &= mask;
+				}
+
+				return result;
+			}
+
+			/**
+			 * Computes the flags that are set and not set in another flag_set.
+			 *
+			 * \param rhs The flags to remove.
+			 * \returns The flags set in the instance and not in rhs.
+			 */
+			constexpr flag_set andnot(const flag_set& rhs) const
+			{
+				flag_set result;
+				result.container() = detail::andnot(container(), rhs.container());
+				return result;
+			}
+
+			constexpr flag_set& operator&= (const flag_set& rhs)
+			{
+				container() &= rhs.container();
+				return *this;
+			}
+
+			constexpr flag_set& operator|= (const flag_set& rhs)
+			{
+				container() |= rhs.container();
+				return *this;
+			}
+
+			constexpr flag_set& operator^= (const flag_set& rhs)
+			{
+				container() ^= rhs.container();
+				return *this;
+			}
+
+			constexpr bool operator== (const flag_set& rhs) const
+			{
+				return container() == rhs.container();
+			}
+
+			constexpr bool operator!= (const flag_set& rhs) const
+			{
+				return container() != rhs.container();
+			}
+
+			/**
+			 * Determines whether any flags are shared with another flag_set.
+			 *
+			 * \param rhs The flags to test against.
+			 * \returns \b true \b if a flag is set in both; \b false \b otherwise.
+			 */
+			constexpr bool intersects(const flag_set& rhs) const
+			{
+				return detail::intersects(container(), rhs.container());
+			}
+
+			constexpr bool any() const
+			{
+				return detail::any(container());
+			}
+
+			constexpr bool none() const
+			{
+				return detail::none(container());
+			}
+
+			constexpr bool all() const
+			{
+				return detail::count(container()) == Size;
+			}
+
+			constexpr std::int32_t count() const
+			{
+				return detail::count(container());
+			}
+
+			/**
+			 * Counts the flags set before the given flag.
+			 *
+			 * When the flags describe which members of a sparse set are
+			 * present this is the dense index of the flag.
+			 *
+			 * \param flag The flag to count up to.
+			 * \returns The number of flags set before the flag.
+			 */
+			constexpr std::int32_t rank(Enum flag) const
+			{
+				return detail::rank(container(), static_cast<std::int32_t>(flag));
+			}
+
+			/**
+			 * Finds the nth flag set.
+			 *
+			 * \param n The zero based index of the set flag.
+			 * \returns The nth flag set, or Size if fewer flags are set.
+			 */
+			constexpr Enum select(std::int32_t n) const
+			{
+				return to_enum(detail::select(container(), n));
+			}
+
+			//----------------------------------------------------------------------
+			// Iteration
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets an iterator to the first flag set.
+			 *
+			 * Iteration only visits the flags that are set, in ascending order.
+			 *
+			 * \returns An iterator to the first flag set.
+			 */
+			iterator begin() const
+			{
+				return iterator(detail::word_data(container()), container_type::word_count);
+			}
+
+			/**
+			 * Gets an iterator past the last flag.
+			 *
+			 * \returns An iterator past the last flag.
+			 */
+			iterator end() const
+			{
+				return iterator(detail::word_data(container()), container_type::word_count, true);
+			}
+
+			/**
+			 * Invokes a function for each flag set.
+			 *
+			 * \tparam Function The type of function. Called with an Enum.
+			 * \param function The function to invoke.
+			 */
+			template <typename Function>
+			void for_each_set(Function function) const
+			{
+				detail::for_each_set(container(), enum_function<Function>(function));
+			}
+
+			/**
+			 * Finds the first flag set.
+			 *
+			 * \returns The first flag set, or Size if no flags are set.
+			 */
+			constexpr Enum find_first() const
+			{
+				return to_enum(detail::find_first(container()));
+			}
+
+			/**
+			 * Finds the next flag set after the given flag.
+			 *
+			 * \param flag The flag to search after.
+			 * \returns The next flag set, or Size if no more flags are set.
+			 */
+			constexpr Enum find_next(Enum flag) const
+			{
+				return to_enum(detail::find_next(container(), flag));
+			}
+
+			/**
+			 * Finds the last flag set.
+			 *
+			 * \returns The last flag set, or Size if no flags are set.
+			 */
+			constexpr Enum find_last() const
+			{
+				return to_enum(detail::find_last(container()));
+			}
+
+			//----------------------------------------------------------------------
+			// Container access
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the underlying bit container.
+			 *
+			 * \returns The bit container.
+			 */
+			constexpr container_type& container()
+			{
+				return detail::bit_container(_set);
+			}
+
+			/**
+			 * Gets the underlying bit container.
+			 *
+			 * \returns The bit container.
+			 */
+			constexpr const container_type& container() const
+			{
+				return detail::bit_container(_set);
+			}
+
 		private:
 
+			/**
+			 * Converts a bit location into a flag.
+			 *
+			 * \param location The location of the bit, or -1 if not found.
+			 * \returns The flag, or Size if the location was not found.
+			 */
+			static constexpr Enum to_enum(std::int32_t location)
+			{
+				return static_cast<Enum>(location < 0 ? Size : location);
+			}
+
+			/**
+			 * Adapts a function taking an Enum to take a bit location.
+			 */
+			template <typename Function>
+			struct enum_function
+			{
+				enum_function(Function& function)
+				: _function(function)
+				{ }
+
+				void operator() (std::int32_t location) const
+				{
+					_function(static_cast<Enum>(location));
+				}
+
+				Function& _function;
+			} ;
+
 		#ifdef RECHARGEABLE_USE_BIT_UNION
 			union_type _set;
 		#else
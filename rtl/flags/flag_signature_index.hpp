@@ -0,0 +1,394 @@
+/**
+ * \file flag_signature_index.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_SIGNATURE_INDEX_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_SIGNATURE_INDEX_HPP_INCLUDED
+
+#include <rtl/flags/flag_query.hpp>
+#include <rtl/flags/detail/hash.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace rtl
+{
+	namespace detail
+	{
+		/**
+		 * Hashes the words of a flag_set.
+		 */
+		template <typename FlagSet>
+		struct flag_set_hash
+		{
+			std::size_t operator() (const FlagSet& flags) const
+			{
+				typedef typename FlagSet::container_type container_type;
+
+				const typename container_type::word_type* words = word_data(flags.container());
+				std::uint64_t hash = fnv1a_basis;
+
+				for (std::int32_t i = 0; i < container_type::word_count; ++i)
+					hash = fnv1a_value(words[i], hash);
+
+				return static_cast<std::size_t>(mix_hash(hash));
+			}
+
+		} ; // end struct flag_set_hash
+
+	} // end namespace detail
+
+	/**
+	 * Groups objects by their exact flag_set.
+	 *
+	 * Each distinct flag_set, or signature, owns a bucket holding the
+	 * identifiers of its objects contiguously. Queries test the mask
+	 * against each distinct signature, which are stored together, and
+	 * hand back whole buckets. A query over millions of objects sharing
+	 * a few hundred signatures costs a few hundred mask tests.
+	 *
+	 * Identifiers are small non-negative integers such as entity indices.
+	 * Removing an object moves the last object of its bucket into its
+	 * place so the order within a bucket is not preserved.
+	 *
+	 * \code
+	 * rtl::flag_signature_index<component_set> index;
+	 *
+	 * index.insert(entity, components);
+	 *
+	 * index.for_each_superset(component_set(Component::Transform, Component::Velocity),
+	 *     [] (const component_set& signature, const std::int32_t* entities, std::size_t count) { ... });
+	 * \endcode
+	 *
+	 * \tparam FlagSet The type of flag_set.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename FlagSet>
+	class flag_signature_index
+	{
+		public:
+
+			/**
+			 * Creates an empty instance of the flag_signature_index class.
+			 */
+			flag_signature_index()
+			: _size(0)
+			{ }
+
+			//----------------------------------------------------------------------
+			// Modifiers
+			//----------------------------------------------------------------------
+
+			/**
+			 * Adds an object.
+			 *
+			 * \param id The identifier of the object. Must not already be present.
+			 * \param flags The flags of the object.
+			 */
+			void insert(std::int32_t id, const FlagSet& flags)
+			{
+				RECHARGEABLE_ASSERT(id >= 0, "Invalid identifier");
+				RECHARGEABLE_ASSERT(!contains(id), "Identifier already present");
+
+				if (id >= static_cast<std::int32_t>(_locations.size()))
+					_locations.resize(id + 1);
+
+				add(id, find_or_add(flags));
+				++_size;
+			}
+
+			/**
+			 * Changes the flags of an object.
+			 *
+			 * The object is added if it is not present.
+			 *
+			 * \param id The identifier of the object.
+			 * \param flags The flags of the object.
+			 */
+			void update(std::int32_t id, const FlagSet& flags)
+			{
+				if (!contains(id))
+				{
+					insert(id, flags);
+					return;
+				}
+
+				const std::int32_t signature = find_or_add(flags);
+
+				if (signature == _locations[id].signature)
+					return;
+
+				detach(id);
+				add(id, signature);
+			}
+
+			/**
+			 * Removes an object.
+			 *
+			 * \param id The identifier of the object.
+			 * \returns \b true \b if the object was removed; \b false \b if it was not present.
+			 */
+			bool remove(std::int32_t id)
+			{
+				if (!contains(id))
+					return false;
+
+				detach(id);
+				_locations[id].signature = -1;
+				--_size;
+
+				return true;
+			}
+
+			/**
+			 * Removes all objects and signatures.
+			 */
+			void clear()
+			{
+				_signatures.clear();
+				_buckets.clear();
+				_lookup.clear();
+				_locations.clear();
+				_size = 0;
+			}
+
+			//----------------------------------------------------------------------
+			// Queries
+			//----------------------------------------------------------------------
+
+			/**
+			 * Determines whether an object is present.
+			 *
+			 * \param id The identifier of the object.
+			 * \returns \b true \b if the object is present; \b false \b otherwise.
+			 */
+			bool contains(std::int32_t id) const
+			{
+				return (id >= 0) && (id < static_cast<std::int32_t>(_locations.size())) && (_locations[id].signature >= 0);
+			}
+
+			/**
+			 * Gets the flags of an object.
+			 *
+			 * \param id The identifier of the object. Must be present.
+			 * \returns The flags of the object.
+			 */
+			const FlagSet& signature(std::int32_t id) const
+			{
+				RECHARGEABLE_ASSERT(contains(id), "Identifier not present");
+
+				return _signatures[_locations[id].signature];
+			}
+
+			/**
+			 * Gets the number of objects.
+			 */
+			std::size_t size() const
+			{
+				return _size;
+			}
+
+			/**
+			 * Gets the number of distinct signatures seen.
+			 *
+			 * Signatures whose objects have all been removed are kept
+			 * until clear is called.
+			 */
+			std::int32_t signature_count() const
+			{
+				return static_cast<std::int32_t>(_signatures.size());
+			}
+
+			/**
+			 * Invokes a function with each bucket whose signature contains a mask.
+			 *
+			 * \param mask The flags that must be set.
+			 * \param function The function to invoke with the signature, the identifiers and the number of identifiers.
+			 */
+			template <typename Function>
+			void for_each_superset(const FlagSet& mask, Function function) const
+			{
+				for_each_bucket([&] (const FlagSet& signature) { return (signature & mask) == mask; }, function);
+			}
+
+			/**
+			 * Invokes a function with each bucket whose signature is within a mask.
+			 *
+			 * \param mask The flags that may be set.
+			 * \param function The function to invoke with the signature, the identifiers and the number of identifiers.
+			 */
+			template <typename Function>
+			void for_each_subset(const FlagSet& mask, Function function) const
+			{
+				for_each_bucket([&] (const FlagSet& signature) { return (signature & mask) == signature; }, function);
+			}
+
+			/**
+			 * Invokes a function with each bucket whose signature matches a predicate.
+			 *
+			 * \param predicate The predicate to match.
+			 * \param function The function to invoke with the signature, the identifiers and the number of identifiers.
+			 */
+			template <std::int32_t AnyCount, typename Function>
+			void for_each_matching(const flag_predicate<FlagSet, AnyCount>& predicate, Function function) const
+			{
+				for_each_bucket(predicate, function);
+			}
+
+			/**
+			 * Counts the objects whose flags contain a mask.
+			 *
+			 * \param mask The flags that must be set.
+			 * \returns The number of objects.
+			 */
+			std::size_t count_supersets(const FlagSet& mask) const
+			{
+				std::size_t total = 0;
+
+				for_each_superset(mask, [&] (const FlagSet&, const std::int32_t*, std::size_t count)
+				{
+					total += count;
+				});
+
+				return total;
+			}
+
+			/**
+			 * Finds the objects whose flags contain a mask.
+			 *
+			 * \param mask The flags that must be set.
+			 * \param result The identifiers are appended to the vector grouped by signature.
+			 */
+			void gather_supersets(const FlagSet& mask, std::vector<std::int32_t>& result) const
+			{
+				for_each_superset(mask, [&] (const FlagSet&, const std::int32_t* ids, std::size_t count)
+				{
+					result.insert(result.end(), ids, ids + count);
+				});
+			}
+
+		private:
+
+			/**
+			 * Where an object lives.
+			 */
+			struct location
+			{
+				location()
+				: signature(-1)
+				, position(0)
+				{ }
+
+				/// The index of the signature, or -1 if not present
+				std::int32_t signature;
+				/// The position within the bucket
+				std::int32_t position;
+			} ;
+
+			template <typename Test, typename Function>
+			void for_each_bucket(const Test& test, Function& function) const
+			{
+				// Signatures are stored apart from their buckets so the scan stays dense
+				const std::size_t count = _signatures.size();
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					const std::vector<std::int32_t>& bucket = _buckets[i];
+
+					if (!bucket.empty() && test(_signatures[i]))
+						function(_signatures[i], bucket.data(), bucket.size());
+				}
+			}
+
+			std::int32_t find_or_add(const FlagSet& flags)
+			{
+				typename lookup_type::iterator found = _lookup.find(flags);
+
+				if (found != _lookup.end())
+					return found->second;
+
+				const std::int32_t signature = static_cast<std::int32_t>(_signatures.size());
+
+				_signatures.push_back(flags);
+				_buckets.emplace_back();
+				_lookup.emplace(flags, signature);
+
+				return signature;
+			}
+
+			void add(std::int32_t id, std::int32_t signature)
+			{
+				std::vector<std::int32_t>& bucket = _buckets[signature];
+
+				_locations[id].signature = signature;
+				_locations[id].position = static_cast<std::int32_t>(bucket.size());
+
+				bucket.push_back(id);
+			}
+
+			void detach(std::int32_t id)
+			{
+				const location& current = _locations[id];
+				std::vector<std::int32_t>& bucket = _buckets[current.signature];
+
+				// Move the last object into the hole
+				const std::int32_t last = bucket.back();
+
+				bucket[current.position] = last;
+				_locations[last].position = current.position;
+
+				bucket.pop_back();
+			}
+
+			typedef std::unordered_map<FlagSet, std::int32_t, detail::flag_set_hash<FlagSet> > lookup_type;
+
+			/// The distinct signatures
+			std::vector<FlagSet> _signatures;
+			/// The identifiers of the objects with each signature
+			std::vector<std::vector<std::int32_t> > _buckets;
+			/// Maps a signature to its index
+			lookup_type _lookup;
+			/// The location of each identifier
+			std::vector<location> _locations;
+			/// The number of objects
+			std::size_t _size;
+
+	} ; // end class flag_signature_index
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_SIGNATURE_INDEX_HPP_INCLUDED
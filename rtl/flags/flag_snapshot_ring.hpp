@@ -0,0 +1,398 @@
+/**
+ * \file flag_snapshot_ring.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_SNAPSHOT_RING_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_SNAPSHOT_RING_HPP_INCLUDED
+
+#include <rtl/flags/dynamic_bit_set.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * A table of flag_sets that can be restored to recent snapshots.
+	 *
+	 * The table is divided into fixed size pages. Writes go through
+	 * modify, and the first write to a page after a snapshot copies the
+	 * page into the undo log of that snapshot. Taking a snapshot only
+	 * closes the current undo log, and restoring copies back the pages
+	 * logged since the requested snapshot, so both cost time in the
+	 * number of pages touched rather than the size of the table.
+	 *
+	 * The undo logs form a ring of History entries. Their storage is
+	 * reused as the ring wraps so a steady simulation does not allocate.
+	 *
+	 * \code
+	 * rtl::flag_snapshot_ring<entity_set> ring(entityCount);
+	 *
+	 * const std::int64_t tick = ring.snapshot();
+	 * ring.modify(entity).set(Entity::Jumping);
+	 * ...
+	 * ring.restore(tick);
+	 * \endcode
+	 *
+	 * \tparam FlagSet The type of flag_set held in the table.
+	 * \tparam History The number of snapshots that can be restored.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename FlagSet, std::int32_t History = 8>
+	class flag_snapshot_ring
+	{
+		public:
+
+			static_assert(History > 0, "At least one snapshot must be kept");
+
+			/// The number of bytes targeted by a page
+			static const std::size_t page_bytes = 4096;
+			/// The number of flag_sets within a page
+			static const std::int32_t page_size = (sizeof(FlagSet) >= page_bytes) ? 1 : static_cast<std::int32_t>(page_bytes / sizeof(FlagSet));
+
+			/**
+			 * Creates an instance of the flag_snapshot_ring class.
+			 *
+			 * No snapshots are held until snapshot is called.
+			 *
+			 * \param count The number of flag_sets in the table.
+			 */
+			explicit flag_snapshot_ring(std::int32_t count)
+			: _count(count)
+			, _newest(-1)
+			, _oldest(0)
+			{
+				RECHARGEABLE_ASSERT(count >= 0, "Invalid count");
+
+				// Pad to whole pages so every page can be copied in full
+				const std::int32_t pages = (count + page_size - 1) / page_size;
+
+				_flags.resize(static_cast<std::size_t>(pages) * page_size);
+				_dirty.resize(pages);
+			}
+
+			//----------------------------------------------------------------------
+			// Table access
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the number of flag_sets in the table.
+			 */
+			std::int32_t size() const
+			{
+				return _count;
+			}
+
+			/**
+			 * Gets the number of pages in the table.
+			 */
+			std::int32_t page_count() const
+			{
+				return _dirty.size();
+			}
+
+			/**
+			 * Gets the flag_sets in the table.
+			 *
+			 * Writes must go through modify to be captured by snapshots.
+			 */
+			const FlagSet* data() const
+			{
+				return _flags.data();
+			}
+
+			const FlagSet& operator[] (std::int32_t index) const
+			{
+				RECHARGEABLE_ASSERT((index >= 0) && (index < _count), "Invalid index");
+
+				return _flags[index];
+			}
+
+			/**
+			 * Gets a flag_set for writing.
+			 *
+			 * \param index The index of the flag_set.
+			 * \returns The flag_set.
+			 */
+			FlagSet& modify(std::int32_t index)
+			{
+				RECHARGEABLE_ASSERT((index >= 0) && (index < _count), "Invalid index");
+
+				touch(index / page_size);
+
+				return _flags[index];
+			}
+
+			/**
+			 * Gets a range of flag_sets for writing.
+			 *
+			 * \param first The index of the first flag_set.
+			 * \param count The number of flag_sets.
+			 * \returns The first flag_set of the range.
+			 */
+			FlagSet* modify(std::int32_t first, std::int32_t count)
+			{
+				RECHARGEABLE_ASSERT((first >= 0) && (count >= 0) && (first + count <= _count), "Invalid range");
+
+				if (count > 0)
+				{
+					const std::int32_t last = (first + count - 1) / page_size;
+
+					for (std::int32_t page = first / page_size; page <= last; ++page)
+						touch(page);
+				}
+
+				return _flags.data() + first;
+			}
+
+			//----------------------------------------------------------------------
+			// Snapshots
+			//----------------------------------------------------------------------
+
+			/**
+			 * Takes a snapshot of the table.
+			 *
+			 * When History snapshots are already held the oldest is dropped.
+			 *
+			 * \returns The tick of the snapshot.
+			 */
+			std::int64_t snapshot()
+			{
+				if (_newest >= 0)
+					clear_dirty(log(_newest));
+
+				++_newest;
+
+				if (_newest - _oldest >= History)
+					_oldest = _newest - History + 1;
+
+				undo_log& current = log(_newest);
+				current.pages.clear();
+				current.images.clear();
+
+				return _newest;
+			}
+
+			/**
+			 * Restores the table to a snapshot.
+			 *
+			 * Snapshots taken after the tick are discarded. The restored
+			 * snapshot is kept so it can be restored again.
+			 *
+			 * \param tick The tick of the snapshot.
+			 * \returns \b true \b if the snapshot was restored; \b false \b if it is no longer held.
+			 */
+			bool restore(std::int64_t tick)
+			{
+				if (!can_restore(tick))
+					return false;
+
+				clear_dirty(log(_newest));
+
+				// Undo newest first so each page ends with its image from the tick
+				for (std::int64_t i = _newest; i >= tick; --i)
+				{
+					undo_log& undo = log(i);
+
+					for (std::size_t page = 0; page < undo.pages.size(); ++page)
+					{
+						std::copy_n(
+							undo.images.data() + page * page_size,
+							page_size,
+							_flags.data() + static_cast<std::size_t>(undo.pages[page]) * page_size
+						);
+					}
+
+					undo.pages.clear();
+					undo.images.clear();
+				}
+
+				_newest = tick;
+
+				return true;
+			}
+
+			/**
+			 * Determines whether a snapshot is held.
+			 *
+			 * \param tick The tick of the snapshot.
+			 * \returns \b true \b if the snapshot can be restored; \b false \b otherwise.
+			 */
+			bool can_restore(std::int64_t tick) const
+			{
+				return (_newest >= 0) && (tick >= _oldest) && (tick <= _newest);
+			}
+
+			/**
+			 * Gets the tick of the newest snapshot, or -1 if no snapshots were taken.
+			 */
+			std::int64_t newest_tick() const
+			{
+				return _newest;
+			}
+
+			/**
+			 * Gets the tick of the oldest snapshot held.
+			 */
+			std::int64_t oldest_tick() const
+			{
+				return _oldest;
+			}
+
+			/**
+			 * Finds the pages written between two snapshots.
+			 *
+			 * Pages outside the result are identical in both snapshots. A
+			 * page in the result was written but may have been written
+			 * back to its earlier value.
+			 *
+			 * \param from The tick of the earlier snapshot.
+			 * \param to The tick of the later snapshot.
+			 * \param result The pages are appended to the vector in ascending order.
+			 * \returns \b true \b if both snapshots are held; \b false \b otherwise.
+			 */
+			bool changed_pages(std::int64_t from, std::int64_t to, std::vector<std::int32_t>& result) const
+			{
+				if (!can_restore(from) || !can_restore(to) || (from > to))
+					return false;
+
+				gather_pages(from, to, result);
+
+				return true;
+			}
+
+			/**
+			 * Finds the pages written since a snapshot.
+			 *
+			 * \param from The tick of the snapshot.
+			 * \param result The pages are appended to the vector in ascending order.
+			 * \returns \b true \b if the snapshot is held; \b false \b otherwise.
+			 */
+			bool changed_pages(std::int64_t from, std::vector<std::int32_t>& result) const
+			{
+				if (!can_restore(from))
+					return false;
+
+				gather_pages(from, _newest + 1, result);
+
+				return true;
+			}
+
+		private:
+
+			/**
+			 * The images of the pages written after a snapshot.
+			 */
+			struct undo_log
+			{
+				/// The pages written
+				std::vector<std::int32_t> pages;
+				/// The contents of each page at the snapshot
+				std::vector<FlagSet> images;
+			} ;
+
+			undo_log& log(std::int64_t tick)
+			{
+				return _logs[tick % History];
+			}
+
+			const undo_log& log(std::int64_t tick) const
+			{
+				return _logs[tick % History];
+			}
+
+			/**
+			 * Copies a page into the current undo log on its first write.
+			 */
+			void touch(std::int32_t page)
+			{
+				if ((_newest < 0) || _dirty.is_set(page))
+					return;
+
+				_dirty.set(page);
+
+				undo_log& current = log(_newest);
+				const FlagSet* first = _flags.data() + static_cast<std::size_t>(page) * page_size;
+
+				current.pages.push_back(page);
+				current.images.insert(current.images.end(), first, first + page_size);
+			}
+
+			/**
+			 * Clears the written marks of the pages in an undo log.
+			 */
+			void clear_dirty(const undo_log& undo)
+			{
+				for (std::int32_t page : undo.pages)
+					_dirty.clear(page);
+			}
+
+			/**
+			 * Gathers the pages in the undo logs of ticks [from, to).
+			 */
+			void gather_pages(std::int64_t from, std::int64_t to, std::vector<std::int32_t>& result) const
+			{
+				const std::size_t start = result.size();
+
+				for (std::int64_t i = from; i < to; ++i)
+				{
+					const undo_log& undo = log(i);
+					result.insert(result.end(), undo.pages.begin(), undo.pages.end());
+				}
+
+				std::sort(result.begin() + start, result.end());
+				result.erase(std::unique(result.begin() + start, result.end()), result.end());
+			}
+
+			/// The live table padded to whole pages
+			std::vector<FlagSet> _flags;
+			/// The number of flag_sets in the table
+			std::int32_t _count;
+			/// The pages written since the newest snapshot
+			dynamic_bit_set _dirty;
+			/// The undo log of each held snapshot
+			undo_log _logs[History];
+			/// The tick of the newest snapshot
+			std::int64_t _newest;
+			/// The tick of the oldest snapshot held
+			std::int64_t _oldest;
+
+	} ; // end class flag_snapshot_ring
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_SNAPSHOT_RING_HPP_INCLUDED
@@ -0,0 +1,561 @@
+/**
+ * \file flag_table.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_TABLE_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_TABLE_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/detail/hash.hpp>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#ifdef _WIN32
+	// Keep the min and max macros out of the headers that use std::min and std::max
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+		#define RECHARGEABLE_DEFINED_WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+		#define RECHARGEABLE_DEFINED_NOMINMAX
+	#endif
+	#include <windows.h>
+	#ifdef RECHARGEABLE_DEFINED_WIN32_LEAN_AND_MEAN
+		#undef WIN32_LEAN_AND_MEAN
+		#undef RECHARGEABLE_DEFINED_WIN32_LEAN_AND_MEAN
+	#endif
+	#ifdef RECHARGEABLE_DEFINED_NOMINMAX
+		#undef NOMINMAX
+		#undef RECHARGEABLE_DEFINED_NOMINMAX
+	#endif
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace rtl
+{
+	/**
+	 * The result of reading or writing a flag table file.
+	 */
+	enum flag_table_status
+	{
+		/// The operation succeeded
+		flag_table_ok,
+		/// The file could not be opened
+		flag_table_open_failed,
+		/// The file could not be mapped into memory
+		flag_table_map_failed,
+		/// The file could not be written
+		flag_table_write_failed,
+		/// The file is not a flag table or is truncated
+		flag_table_invalid_format,
+		/// The file was written by an unsupported version
+		flag_table_version_mismatch,
+		/// The file was written on a host with a different byte order
+		flag_table_endian_mismatch,
+		/// The flag_set layout or schema differs from the file
+		flag_table_schema_mismatch
+	} ;
+
+	/**
+	 * The header of a flag table file.
+	 *
+	 * The header is followed by padding up to payload_offset and then by
+	 * count flag_sets exactly as they are laid out in memory.
+	 */
+	struct flag_table_header
+	{
+		/// Identifies the file as a flag table
+		std::uint32_t magic;
+		/// The version of the format
+		std::uint16_t version;
+		/// The byte order marker, written as 0x0102 in host order
+		std::uint16_t byte_order;
+		/// The number of flags in each flag_set
+		std::uint32_t size;
+		/// The number of bits in each flag_set container
+		std::uint32_t bits;
+		/// The size of each flag_set in bytes
+		std::uint32_t element_size;
+		/// The alignment of each flag_set in bytes
+		std::uint32_t element_align;
+		/// Hash of the layout and the user supplied schema
+		std::uint64_t schema;
+		/// The number of flag_sets
+		std::uint64_t count;
+		/// The offset of the first flag_set from the start of the file
+		std::uint64_t payload_offset;
+		/// Reserved for future use, written as zero
+		std::uint8_t reserved[16];
+
+	} ; // end struct flag_table_header
+
+	static_assert(sizeof(flag_table_header) == 64, "flag_table_header must be 64 bytes");
+
+	namespace detail
+	{
+		/// Magic number identifying a flag table, 'RTLF' in little endian
+		const std::uint32_t flag_table_magic = 0x464c5452;
+		/// The current version of the format
+		const std::uint16_t flag_table_version = 1;
+		/// The byte order marker
+		const std::uint16_t flag_table_byte_order = 0x0102;
+		/// The byte order marker as read on a host with the other byte order
+		const std::uint16_t flag_table_swapped_byte_order = 0x0201;
+		/// The offset of the payload, a multiple of any flag_set alignment
+		const std::uint64_t flag_table_payload_offset = sizeof(flag_table_header);
+
+		/**
+		 * Describes the layout of a flag_set stored in a flag table.
+		 *
+		 * \tparam FlagSet The type of flag_set.
+		 */
+		template <typename FlagSet>
+		struct flag_table_traits;
+
+		template <typename Enum, std::int32_t Size, typename Names>
+		struct flag_table_traits<flag_set<Enum, Size, Names> >
+		{
+			/// The number of flags
+			static const std::uint32_t size = Size;
+			/// The number of bits in the container
+			static const std::uint32_t bits = select_bits<Size>::value;
+
+		} ; // end struct flag_table_traits
+
+		/**
+		 * Computes the schema hash stored in a flag table.
+		 *
+		 * \tparam FlagSet The type of flag_set.
+		 * \param schema The user supplied schema.
+		 * \returns The hash of the layout and the schema.
+		 */
+		template <typename FlagSet>
+		constexpr std::uint64_t flag_table_schema(std::uint64_t schema)
+		{
+			return fnv1a_value(schema, fnv1a_value(flag_table_traits<FlagSet>::bits, fnv1a_value(flag_table_traits<FlagSet>::size)));
+		}
+
+		/**
+		 * Fills a header describing an array of flag_sets.
+		 *
+		 * \tparam FlagSet The type of flag_set.
+		 * \param count The number of flag_sets.
+		 * \param schema The user supplied schema.
+		 * \returns The header.
+		 */
+		template <typename FlagSet>
+		flag_table_header make_flag_table_header(std::uint64_t count, std::uint64_t schema)
+		{
+			flag_table_header header;
+			std::memset(&header, 0, sizeof(header));
+
+			header.magic = flag_table_magic;
+			header.version = flag_table_version;
+			header.byte_order = flag_table_byte_order;
+			header.size = flag_table_traits<FlagSet>::size;
+			header.bits = flag_table_traits<FlagSet>::bits;
+			header.element_size = sizeof(FlagSet);
+			header.element_align = alignof(FlagSet);
+			header.schema = flag_table_schema<FlagSet>(schema);
+			header.count = count;
+			header.payload_offset = flag_table_payload_offset;
+
+			return header;
+		}
+
+	} // end namespace detail
+
+	/**
+	 * Hashes a description of the flags for use as a flag table schema.
+	 *
+	 * Passing the enumerator names, for example "Burning,Frozen,Poisoned",
+	 * rejects files written before the enumeration was reordered.
+	 *
+	 * \param text The description of the flags.
+	 * \returns The schema.
+	 */
+	constexpr std::uint64_t flag_schema_hash(const char* text)
+	{
+		return detail::fnv1a(text);
+	}
+
+	/**
+	 * Writes an array of flag_sets to a flag table file.
+	 *
+	 * \param path The path of the file to write.
+	 * \param flags The flag_sets to write.
+	 * \param count The number of flag_sets.
+	 * \param schema The user supplied schema.
+	 * \returns flag_table_ok on success; an error otherwise.
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	flag_table_status write_flag_table(const char* path, const flag_set<Enum, Size, Names>* flags, std::size_t count, std::uint64_t schema = 0)
+	{
+		typedef flag_set<Enum, Size, Names> value_type;
+
+		std::FILE* file = std::fopen(path, "wb");
+
+		if (file == nullptr)
+			return flag_table_open_failed;
+
+		const flag_table_header header = detail::make_flag_table_header<value_type>(count, schema);
+
+		// The payload directly follows the header
+		bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+		written = written && ((count == 0) || (std::fwrite(flags, sizeof(value_type), count, file) == count));
+
+		if (std::fclose(file) != 0)
+			written = false;
+
+		return written ? flag_table_ok : flag_table_write_failed;
+	}
+
+	/**
+	 * A read-only view of a memory mapped flag table file.
+	 *
+	 * The flag_sets are used in place from the mapping without being
+	 * parsed or copied. The file must have been written by
+	 * write_flag_table for the same flag_set type and schema on a host
+	 * with the same byte order.
+	 *
+	 * \tparam FlagSet The type of flag_set.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename FlagSet>
+	class flag_table_view
+	{
+		public:
+
+			typedef FlagSet value_type;
+			typedef const FlagSet* const_iterator;
+			typedef const_iterator iterator;
+
+			static_assert(std::is_trivially_copyable<FlagSet>::value, "The flag_set must be trivially copyable to be mapped");
+
+			/**
+			 * Creates an instance of the flag_table_view class with no file.
+			 */
+			flag_table_view()
+			: _mapping(nullptr)
+			, _mappingSize(0)
+			, _data(nullptr)
+			, _count(0)
+			{ }
+
+			flag_table_view(flag_table_view&& other)
+			: _mapping(other._mapping)
+			, _mappingSize(other._mappingSize)
+			, _data(other._data)
+			, _count(other._count)
+			{
+				other.release();
+			}
+
+			flag_table_view& operator= (flag_table_view&& other)
+			{
+				if (this != &other)
+				{
+					close();
+
+					_mapping = other._mapping;
+					_mappingSize = other._mappingSize;
+					_data = other._data;
+					_count = other._count;
+
+					other.release();
+				}
+
+				return *this;
+			}
+
+			/**
+			 * Destroys an instance of the flag_table_view class.
+			 *
+			 * The file is unmapped.
+			 */
+			~flag_table_view()
+			{
+				close();
+			}
+
+			/**
+			 * Maps a flag table file.
+			 *
+			 * Any previously mapped file is closed first. On failure the view
+			 * is left empty.
+			 *
+			 * \param path The path of the file to map.
+			 * \param schema The user supplied schema the file must match.
+			 * \returns flag_table_ok on success; an error otherwise.
+			 */
+			flag_table_status open(const char* path, std::uint64_t schema = 0)
+			{
+				close();
+
+				flag_table_status status = map(path);
+
+				if (status != flag_table_ok)
+					return status;
+
+				status = validate(schema);
+
+				if (status != flag_table_ok)
+					close();
+
+				return status;
+			}
+
+			/**
+			 * Unmaps the file.
+			 */
+			void close()
+			{
+				if (_mapping != nullptr)
+				{
+				#ifdef _WIN32
+					UnmapViewOfFile(_mapping);
+				#else
+					munmap(_mapping, _mappingSize);
+				#endif
+				}
+
+				release();
+			}
+
+			bool is_open() const
+			{
+				return _mapping != nullptr;
+			}
+
+			//----------------------------------------------------------------------
+			// Access
+			//----------------------------------------------------------------------
+
+			const FlagSet* data() const
+			{
+				return _data;
+			}
+
+			std::size_t size() const
+			{
+				return _count;
+			}
+
+			bool empty() const
+			{
+				return _count == 0;
+			}
+
+			const FlagSet& operator[] (std::size_t index) const
+			{
+				RECHARGEABLE_ASSERT(index < _count, "Index is out of range");
+
+				return _data[index];
+			}
+
+			const_iterator begin() const
+			{
+				return _data;
+			}
+
+			const_iterator end() const
+			{
+				return _data + _count;
+			}
+
+		private:
+
+			flag_table_view(const flag_table_view&);
+			flag_table_view& operator= (const flag_table_view&);
+
+			/**
+			 * Maps the whole file read-only.
+			 *
+			 * \param path The path of the file to map.
+			 * \returns flag_table_ok on success; an error otherwise.
+			 */
+			flag_table_status map(const char* path)
+			{
+			#ifdef _WIN32
+				HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+				if (file == INVALID_HANDLE_VALUE)
+					return flag_table_open_failed;
+
+				LARGE_INTEGER fileSize;
+
+				if (!GetFileSizeEx(file, &fileSize))
+				{
+					CloseHandle(file);
+					return flag_table_open_failed;
+				}
+
+				if (static_cast<std::uint64_t>(fileSize.QuadPart) < sizeof(flag_table_header))
+				{
+					CloseHandle(file);
+					return flag_table_invalid_format;
+				}
+
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				CloseHandle(file);
+
+				if (mapping == nullptr)
+					return flag_table_map_failed;
+
+				void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+
+				if (view == nullptr)
+					return flag_table_map_failed;
+
+				_mapping = view;
+				_mappingSize = static_cast<std::size_t>(fileSize.QuadPart);
+			#else
+				const int file = ::open(path, O_RDONLY);
+
+				if (file < 0)
+					return flag_table_open_failed;
+
+				struct stat info;
+
+				if (fstat(file, &info) != 0)
+				{
+					::close(file);
+					return flag_table_open_failed;
+				}
+
+				if (static_cast<std::uint64_t>(info.st_size) < sizeof(flag_table_header))
+				{
+					::close(file);
+					return flag_table_invalid_format;
+				}
+
+				void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+				::close(file);
+
+				if (view == MAP_FAILED)
+					return flag_table_map_failed;
+
+				_mapping = view;
+				_mappingSize = static_cast<std::size_t>(info.st_size);
+			#endif
+
+				return flag_table_ok;
+			}
+
+			/**
+			 * Checks the header against the flag_set type and the schema.
+			 *
+			 * \param schema The user supplied schema.
+			 * \returns flag_table_ok on success; an error otherwise.
+			 */
+			flag_table_status validate(std::uint64_t schema)
+			{
+				const flag_table_header& header = *static_cast<const flag_table_header*>(_mapping);
+
+				// The byte order is checked first as the magic reads byte swapped from a foreign host
+				if (header.byte_order != detail::flag_table_byte_order)
+				{
+					return (header.byte_order == detail::flag_table_swapped_byte_order)
+						? flag_table_endian_mismatch
+						: flag_table_invalid_format;
+				}
+
+				if (header.magic != detail::flag_table_magic)
+					return flag_table_invalid_format;
+
+				if (header.version != detail::flag_table_version)
+					return flag_table_version_mismatch;
+
+				const flag_table_header expected = detail::make_flag_table_header<FlagSet>(header.count, schema);
+
+				if ((header.size != expected.size) ||
+					(header.bits != expected.bits) ||
+					(header.element_size != expected.element_size) ||
+					(header.element_align != expected.element_align) ||
+					(header.schema != expected.schema))
+				{
+					return flag_table_schema_mismatch;
+				}
+
+				// The payload must be aligned and lie within the file
+				if ((header.payload_offset < sizeof(flag_table_header)) ||
+					(header.payload_offset % alignof(FlagSet) != 0) ||
+					(header.payload_offset > _mappingSize) ||
+					(header.count > (_mappingSize - header.payload_offset) / sizeof(FlagSet)))
+				{
+					return flag_table_invalid_format;
+				}
+
+				_data = reinterpret_cast<const FlagSet*>(static_cast<const std::uint8_t*>(_mapping) + header.payload_offset);
+				_count = static_cast<std::size_t>(header.count);
+
+				return flag_table_ok;
+			}
+
+			/**
+			 * Forgets the mapping without unmapping it.
+			 */
+			void release()
+			{
+				_mapping = nullptr;
+				_mappingSize = 0;
+				_data = nullptr;
+				_count = 0;
+			}
+
+			/// The start of the mapping
+			void* _mapping;
+			/// The size of the mapping in bytes
+			std::size_t _mappingSize;
+			/// The first flag_set
+			const FlagSet* _data;
+			/// The number of flag_sets
+			std::size_t _count;
+
+	} ; // end class flag_table_view
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_TABLE_HPP_INCLUDED
@@ -0,0 +1,438 @@
+/**
+ * \file flag_thread_pool.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_FLAG_THREAD_POOL_HPP_INCLUDED
+#define RECHARGEABLE_FLAG_THREAD_POOL_HPP_INCLUDED
+
+#include <rtl/flags/detail/config.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * Runs the tasks of a parallel query on the calling thread.
+	 *
+	 * An executor is any callable taking a task count and a task. It
+	 * must invoke the task once with each index in [0, taskCount) and
+	 * return only once every invocation has completed. The tasks of a
+	 * query write to disjoint results so they may run in any order and
+	 * on any thread.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	struct inline_executor
+	{
+		template <typename Task>
+		void operator() (std::int32_t taskCount, Task task) const
+		{
+			for (std::int32_t i = 0; i < taskCount; ++i)
+				task(i);
+		}
+
+	} ; // end struct inline_executor
+
+	/**
+	 * A small work stealing thread pool for parallel queries.
+	 *
+	 * The tasks of a call are divided into one contiguous range per
+	 * thread. Each thread takes tasks from the front of its own range and
+	 * once that is exhausted steals tasks from the back of the ranges of
+	 * other threads, so uneven tasks still balance. A range is a single
+	 * atomic word holding its bounds so taking and stealing are each a
+	 * compare and swap.
+	 *
+	 * The calling thread takes part in the work so a pool of N threads
+	 * starts N - 1 workers. Calls into the pool must not overlap.
+	 *
+	 * If a task throws the tasks not yet taken are abandoned, and once
+	 * the tasks already running complete the first exception is rethrown
+	 * on the calling thread.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	class flag_thread_pool
+	{
+		public:
+
+			/**
+			 * Creates an instance of the flag_thread_pool class.
+			 *
+			 * \param threadCount The number of threads including the calling thread. Zero uses the hardware concurrency.
+			 */
+			explicit flag_thread_pool(std::int32_t threadCount = 0)
+			: _storage()
+			, _ranges(nullptr)
+			, _threadCount(0)
+			, _invoke(nullptr)
+			, _context(nullptr)
+			, _generation(0)
+			, _active(0)
+			, _stop(false)
+			, _error()
+			{
+				if (threadCount <= 0)
+					threadCount = static_cast<std::int32_t>(std::thread::hardware_concurrency());
+
+				if (threadCount <= 0)
+					threadCount = 1;
+
+				// Offset the ranges within their allocation so each starts on a cache line
+				_storage.reset(new char[(static_cast<std::size_t>(threadCount) * sizeof(range)) + 63]);
+
+				const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(_storage.get());
+
+				_ranges = reinterpret_cast<range*>(_storage.get() + ((64 - (address & 63)) & 63));
+
+				for (std::int32_t i = 0; i < threadCount; ++i)
+					new (&_ranges[i]) range();
+
+				_threadCount = threadCount;
+
+				for (std::int32_t i = 1; i < threadCount; ++i)
+					_workers.emplace_back(&flag_thread_pool::worker, this, i);
+			}
+
+			flag_thread_pool(const flag_thread_pool&) = delete;
+			flag_thread_pool& operator= (const flag_thread_pool&) = delete;
+
+			/**
+			 * Stops and joins the worker threads.
+			 */
+			~flag_thread_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_stop = true;
+				}
+
+				_wake.notify_all();
+
+				for (std::thread& thread : _workers)
+					thread.join();
+			}
+
+			/**
+			 * Gets the number of threads including the calling thread.
+			 *
+			 * \returns The number of threads.
+			 */
+			std::int32_t thread_count() const
+			{
+				return _threadCount;
+			}
+
+			/**
+			 * Runs tasks across the pool.
+			 *
+			 * Returns once every task has completed. If a task throws the
+			 * first exception is rethrown once the running tasks complete.
+			 *
+			 * \param taskCount The number of tasks.
+			 * \param task The task to invoke with each index in [0, taskCount).
+			 */
+			template <typename Task>
+			void operator() (std::int32_t taskCount, Task task)
+			{
+				RECHARGEABLE_ASSERT(taskCount >= 0, "Invalid task count");
+
+				if ((taskCount <= 1) || (_threadCount == 1))
+				{
+					inline_executor()(taskCount, task);
+					return;
+				}
+
+				// Split the tasks evenly between the threads
+				for (std::int32_t i = 0; i < _threadCount; ++i)
+				{
+					const std::int64_t begin = (static_cast<std::int64_t>(taskCount) * i) / _threadCount;
+					const std::int64_t end = (static_cast<std::int64_t>(taskCount) * (i + 1)) / _threadCount;
+
+					_ranges[i].bounds.store(pack(static_cast<std::int32_t>(begin), static_cast<std::int32_t>(end)), std::memory_order_relaxed);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_invoke = &invoke_task<Task>;
+					_context = &task;
+					++_generation;
+				}
+
+				_wake.notify_all();
+
+				try
+				{
+					run(0, &invoke_task<Task>, &task);
+				}
+				catch (...)
+				{
+					abandon(std::current_exception());
+				}
+
+				// Every task has been taken so close the call and wait for the workers still running one
+				std::unique_lock<std::mutex> lock(_mutex);
+
+				_invoke = nullptr;
+				_context = nullptr;
+				_done.wait(lock, [this] { return _active == 0; });
+
+				if (_error)
+				{
+					std::exception_ptr error = _error;
+					_error = nullptr;
+
+					std::rethrow_exception(error);
+				}
+			}
+
+		private:
+
+			/**
+			 * The tasks remaining for a thread.
+			 *
+			 * Aligned so the ranges of different threads are on separate
+			 * cache lines. Trivially destructible so the ranges are never
+			 * destroyed before their storage is released.
+			 */
+			struct alignas(64) range
+			{
+				range()
+				: bounds(0)
+				{ }
+
+				/// The first task in the low 32 bits and one past the last in the high 32 bits
+				std::atomic<std::uint64_t> bounds;
+			} ;
+
+			typedef void (*invoke_function)(void*, std::int32_t);
+
+			static std::uint64_t pack(std::int32_t begin, std::int32_t end)
+			{
+				return static_cast<std::uint32_t>(begin) | (static_cast<std::uint64_t>(static_cast<std::uint32_t>(end)) << 32);
+			}
+
+			template <typename Task>
+			static void invoke_task(void* context, std::int32_t index)
+			{
+				(*static_cast<Task*>(context))(index);
+			}
+
+			/**
+			 * Takes a task from the front of a range.
+			 */
+			bool take_front(range& tasks, std::int32_t& index)
+			{
+				std::uint64_t bounds = tasks.bounds.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					const std::int32_t begin = static_cast<std::int32_t>(bounds & 0xffffffff);
+					const std::int32_t end = static_cast<std::int32_t>(bounds >> 32);
+
+					if (begin >= end)
+						return false;
+
+					if (tasks.bounds.compare_exchange_weak(bounds, pack(begin + 1, end), std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						index = begin;
+						return true;
+					}
+				}
+			}
+
+			/**
+			 * Steals a task from the back of a range.
+			 */
+			bool take_back(range& tasks, std::int32_t& index)
+			{
+				std::uint64_t bounds = tasks.bounds.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					const std::int32_t begin = static_cast<std::int32_t>(bounds & 0xffffffff);
+					const std::int32_t end = static_cast<std::int32_t>(bounds >> 32);
+
+					if (begin >= end)
+						return false;
+
+					if (tasks.bounds.compare_exchange_weak(bounds, pack(begin, end - 1), std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						index = end - 1;
+						return true;
+					}
+				}
+			}
+
+			/**
+			 * Empties every range after a task throws.
+			 *
+			 * Tasks already taken still run to completion.
+			 *
+			 * \param error The exception thrown by the task.
+			 */
+			void abandon(std::exception_ptr error)
+			{
+				for (std::int32_t i = 0; i < _threadCount; ++i)
+					_ranges[i].bounds.store(0, std::memory_order_relaxed);
+
+				std::lock_guard<std::mutex> lock(_mutex);
+
+				if (!_error)
+					_error = error;
+			}
+
+			/**
+			 * Runs tasks until every range is empty.
+			 *
+			 * \param thread The index of the thread.
+			 * \param invoke Invokes the task.
+			 * \param context The task.
+			 */
+			void run(std::int32_t thread, invoke_function invoke, void* context)
+			{
+				std::int32_t index = 0;
+
+				while (take_front(_ranges[thread], index))
+					invoke(context, index);
+
+				// Steal from the other threads until a full pass finds nothing
+				bool stole = true;
+
+				while (stole)
+				{
+					stole = false;
+
+					for (std::int32_t i = 1; i < _threadCount; ++i)
+					{
+						range& victim = _ranges[(thread + i) % _threadCount];
+
+						while (take_back(victim, index))
+						{
+							invoke(context, index);
+							stole = true;
+						}
+					}
+				}
+			}
+
+			/**
+			 * Waits for calls into the pool and helps run them.
+			 *
+			 * \param thread The index of the thread.
+			 */
+			void worker(std::int32_t thread)
+			{
+				std::uint64_t seen = 0;
+
+				for (;;)
+				{
+					invoke_function invoke = nullptr;
+					void* context = nullptr;
+
+					{
+						std::unique_lock<std::mutex> lock(_mutex);
+
+						_wake.wait(lock, [&] { return _stop || ((_generation != seen) && (_invoke != nullptr)); });
+
+						if (_stop)
+							return;
+
+						seen = _generation;
+						invoke = _invoke;
+						context = _context;
+						++_active;
+					}
+
+					try
+					{
+						run(thread, invoke, context);
+					}
+					catch (...)
+					{
+						abandon(std::current_exception());
+					}
+
+					{
+						std::lock_guard<std::mutex> lock(_mutex);
+						--_active;
+					}
+
+					_done.notify_one();
+				}
+			}
+
+			/// The storage of the ranges including the alignment padding
+			std::unique_ptr<char[]> _storage;
+			/// The tasks remaining for each thread
+			range* _ranges;
+			/// The number of threads including the calling thread
+			std::int32_t _threadCount;
+			/// The worker threads
+			std::vector<std::thread> _workers;
+			/// Invokes the task of the current call
+			invoke_function _invoke;
+			/// The task of the current call
+			void* _context;
+			/// Incremented for each call
+			std::uint64_t _generation;
+			/// The number of workers running tasks
+			std::int32_t _active;
+			/// Whether the workers should exit
+			bool _stop;
+			/// The first exception thrown by a task of the current call
+			std::exception_ptr _error;
+			/// Guards the state shared with the workers
+			std::mutex _mutex;
+			/// Signals the workers of a call
+			std::condition_variable _wake;
+			/// Signals the calling thread that a worker finished
+			std::condition_variable _done;
+
+	} ; // end class flag_thread_pool
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_FLAG_THREAD_POOL_HPP_INCLUDED
@@ -0,0 +1,451 @@
+/**
+ * \file hierarchical_bit_set.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_HIERARCHICAL_BIT_SET_HPP_INCLUDED
+#define RECHARGEABLE_HIERARCHICAL_BIT_SET_HPP_INCLUDED
+
+#include <rtl/flags/detail/config.hpp>
+#include <rtl/flags/detail/intrinsics.hpp>
+
+namespace rtl
+{
+	/**
+	 * A large collection of bits with summary levels for fast searches.
+	 *
+	 * The bits are held in leaf words. Above them a summary level keeps
+	 * one bit per leaf word that is not empty and one bit per leaf word
+	 * that is not full. A top level does the same for the summary words.
+	 * Finding the next set or clear bit touches a leaf word, a summary
+	 * word and a scan of the top level, which is 4 words for a million
+	 * bits, no matter how full the collection is.
+	 *
+	 * Every modification keeps the summaries up to date, costing a few
+	 * extra word operations when a leaf word becomes empty or full.
+	 *
+	 * \tparam Bits The number of bits.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <std::int32_t Bits>
+	class hierarchical_bit_set
+	{
+		public:
+
+			static_assert(Bits > 0, "The number of bits must be positive");
+
+			/// The type holding the bits
+			typedef std::uint64_t word_type;
+
+			/// The number of leaf words
+			static const std::int32_t word_count = (Bits + 63) >> 6;
+			/// The number of summary words
+			static const std::int32_t summary_count = (word_count + 63) >> 6;
+			/// The number of top level words
+			static const std::int32_t top_count = (summary_count + 63) >> 6;
+
+			/**
+			 * Creates an instance of the hierarchical_bit_set class.
+			 *
+			 * All bits are initially cleared.
+			 */
+			hierarchical_bit_set()
+			{
+				clear_all();
+			}
+
+			//----------------------------------------------------------------------
+			// Modification
+			//----------------------------------------------------------------------
+
+			/**
+			 * Sets the bit at the given location.
+			 *
+			 * \param location The bit to set.
+			 */
+			void set(std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+				const std::int32_t index = location >> 6;
+				const word_type bit = word_type(1) << (location & 63);
+				const word_type word = _words[index];
+
+				if ((word & bit) != 0)
+					return;
+
+				_words[index] = word | bit;
+				++_count;
+
+				if (word == 0)
+					set_summary(_nonempty, _topNonempty, index);
+
+				if ((word | bit) == leaf_mask(index))
+					clear_summary(_nonfull, _topNonfull, index);
+			}
+
+			/**
+			 * Clears the bit at the given location.
+			 *
+			 * \param location The bit to clear.
+			 */
+			void clear(std::int32_t location)
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+				const std::int32_t index = location >> 6;
+				const word_type bit = word_type(1) << (location & 63);
+				const word_type word = _words[index];
+
+				if ((word & bit) == 0)
+					return;
+
+				_words[index] = word & ~bit;
+				--_count;
+
+				if (word == leaf_mask(index))
+					set_summary(_nonfull, _topNonfull, index);
+
+				if ((word & ~bit) == 0)
+					clear_summary(_nonempty, _topNonempty, index);
+			}
+
+			/**
+			 * Toggles the bit at the given location.
+			 *
+			 * \param location The bit to toggle.
+			 */
+			void toggle(std::int32_t location)
+			{
+				if (is_set(location))
+					clear(location);
+				else
+					set(location);
+			}
+
+			/**
+			 * Queries whether a bit is set.
+			 *
+			 * \param location The bit to query.
+			 * \returns \b true \b if the bit is set; \b false \b otherwise.
+			 */
+			bool is_set(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+				return ((_words[location >> 6] >> (location & 63)) & 1) != 0;
+			}
+
+			/**
+			 * Sets all the bits.
+			 */
+			void set_all()
+			{
+				for (std::int32_t i = 0; i < word_count; ++i)
+					_words[i] = leaf_mask(i);
+
+				fill_summary(_nonempty, _topNonempty);
+				clear_summary_level(_nonfull, _topNonfull);
+
+				_count = Bits;
+			}
+
+			/**
+			 * Clears all the bits.
+			 */
+			void clear_all()
+			{
+				for (std::int32_t i = 0; i < word_count; ++i)
+					_words[i] = 0;
+
+				clear_summary_level(_nonempty, _topNonempty);
+				fill_summary(_nonfull, _topNonfull);
+
+				_count = 0;
+			}
+
+			//----------------------------------------------------------------------
+			// Queries
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the number of bits set.
+			 *
+			 * \returns The number of bits set.
+			 */
+			std::int32_t count() const
+			{
+				return _count;
+			}
+
+			bool any() const
+			{
+				return _count != 0;
+			}
+
+			bool none() const
+			{
+				return _count == 0;
+			}
+
+			bool all() const
+			{
+				return _count == Bits;
+			}
+
+			/**
+			 * Finds the first bit set.
+			 *
+			 * \returns The location of the first bit set, or -1 if no bits are set.
+			 */
+			std::int32_t find_first_set() const
+			{
+				return find_from<false>(0);
+			}
+
+			/**
+			 * Finds the first bit cleared.
+			 *
+			 * \returns The location of the first bit cleared, or -1 if all bits are set.
+			 */
+			std::int32_t find_first_clear() const
+			{
+				return find_from<true>(0);
+			}
+
+			/**
+			 * Finds the next bit set after a location.
+			 *
+			 * \param location The location to search after.
+			 * \returns The location of the next bit set, or -1 if there are none.
+			 */
+			std::int32_t find_next_set(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+				return find_from<false>(location + 1);
+			}
+
+			/**
+			 * Finds the next bit cleared after a location.
+			 *
+			 * \param location The location to search after.
+			 * \returns The location of the next bit cleared, or -1 if there are none.
+			 */
+			std::int32_t find_next_clear(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location < Bits), "Invalid location");
+
+				return find_from<true>(location + 1);
+			}
+
+			/**
+			 * Gets the leaf words holding the bits.
+			 *
+			 * \returns A pointer to the first of word_count words.
+			 */
+			const word_type* word_data() const
+			{
+				return _words;
+			}
+
+		private:
+
+			/**
+			 * Gets the bits of a leaf word that are within the collection.
+			 *
+			 * \param index The index of the leaf word.
+			 * \returns The mask of valid bits.
+			 */
+			static word_type leaf_mask(std::int32_t index)
+			{
+				return ((index == word_count - 1) && ((Bits & 63) != 0))
+					? (word_type(1) << (Bits & 63)) - 1
+					: ~word_type(0);
+			}
+
+			/**
+			 * Gets a leaf word with the searched for bits set.
+			 *
+			 * \tparam Clear Whether cleared bits are searched for.
+			 * \param index The index of the leaf word.
+			 * \returns The leaf word, inverted when searching for cleared bits.
+			 */
+			template <bool Clear>
+			word_type leaf(std::int32_t index) const
+			{
+				return Clear ? ~_words[index] & leaf_mask(index) : _words[index];
+			}
+
+			/**
+			 * Marks a leaf word within a summary.
+			 *
+			 * \param summary The summary level.
+			 * \param top The top level above it.
+			 * \param index The index of the leaf word.
+			 */
+			static void set_summary(word_type* summary, word_type* top, std::int32_t index)
+			{
+				const std::int32_t summaryIndex = index >> 6;
+
+				if (summary[summaryIndex] == 0)
+					top[summaryIndex >> 6] |= word_type(1) << (summaryIndex & 63);
+
+				summary[summaryIndex] |= word_type(1) << (index & 63);
+			}
+
+			/**
+			 * Unmarks a leaf word within a summary.
+			 *
+			 * \param summary The summary level.
+			 * \param top The top level above it.
+			 * \param index The index of the leaf word.
+			 */
+			static void clear_summary(word_type* summary, word_type* top, std::int32_t index)
+			{
+				const std::int32_t summaryIndex = index >> 6;
+
+				summary[summaryIndex] &= ~(word_type(1) << (index & 63));
+
+				if (summary[summaryIndex] == 0)
+					top[summaryIndex >> 6] &= ~(word_type(1) << (summaryIndex & 63));
+			}
+
+			/**
+			 * Marks every leaf word within a summary.
+			 *
+			 * \param summary The summary level.
+			 * \param top The top level above it.
+			 */
+			static void fill_summary(word_type* summary, word_type* top)
+			{
+				for (std::int32_t i = 0; i < summary_count; ++i)
+					summary[i] = ((i == summary_count - 1) && ((word_count & 63) != 0)) ? (word_type(1) << (word_count & 63)) - 1 : ~word_type(0);
+
+				for (std::int32_t i = 0; i < top_count; ++i)
+					top[i] = ((i == top_count - 1) && ((summary_count & 63) != 0)) ? (word_type(1) << (summary_count & 63)) - 1 : ~word_type(0);
+			}
+
+			/**
+			 * Unmarks every leaf word within a summary.
+			 *
+			 * \param summary The summary level.
+			 * \param top The top level above it.
+			 */
+			static void clear_summary_level(word_type* summary, word_type* top)
+			{
+				for (std::int32_t i = 0; i < summary_count; ++i)
+					summary[i] = 0;
+
+				for (std::int32_t i = 0; i < top_count; ++i)
+					top[i] = 0;
+			}
+
+			/**
+			 * Finds the first searched for bit at or after a location.
+			 *
+			 * \tparam Clear Whether cleared bits are searched for.
+			 * \param location The location to search from.
+			 * \returns The location of the bit found, or -1 if there are none.
+			 */
+			template <bool Clear>
+			std::int32_t find_from(std::int32_t location) const
+			{
+				if (location >= Bits)
+					return -1;
+
+				const word_type* summary = Clear ? _nonfull : _nonempty;
+				const word_type* top = Clear ? _topNonfull : _topNonempty;
+
+				// Remaining bits of the leaf word holding the location
+				std::int32_t index = location >> 6;
+				word_type word = leaf<Clear>(index) & (~word_type(0) << (location & 63));
+
+				if (word != 0)
+					return (index << 6) + detail::count_trailing_zeros(word);
+
+				// Remaining leaf words of the summary word
+				if (++index >= word_count)
+					return -1;
+
+				std::int32_t summaryIndex = index >> 6;
+				word = summary[summaryIndex] & (~word_type(0) << (index & 63));
+
+				if (word == 0)
+				{
+					// Remaining summary words through the top level
+					if (++summaryIndex >= summary_count)
+						return -1;
+
+					std::int32_t topIndex = summaryIndex >> 6;
+					word = top[topIndex] & (~word_type(0) << (summaryIndex & 63));
+
+					while (word == 0)
+					{
+						if (++topIndex >= top_count)
+							return -1;
+
+						word = top[topIndex];
+					}
+
+					summaryIndex = (topIndex << 6) + detail::count_trailing_zeros(word);
+					word = summary[summaryIndex];
+				}
+
+				index = (summaryIndex << 6) + detail::count_trailing_zeros(word);
+
+				return (index << 6) + detail::count_trailing_zeros(leaf<Clear>(index));
+			}
+
+			/// The leaf words
+			word_type _words[word_count];
+			/// One bit per leaf word that has a bit set
+			word_type _nonempty[summary_count];
+			/// One bit per leaf word that has a bit cleared
+			word_type _nonfull[summary_count];
+			/// One bit per summary word of _nonempty that is not zero
+			word_type _topNonempty[top_count];
+			/// One bit per summary word of _nonfull that is not zero
+			word_type _topNonfull[top_count];
+			/// The number of bits set
+			std::int32_t _count;
+
+	} ; // end class hierarchical_bit_set
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_HIERARCHICAL_BIT_SET_HPP_INCLUDED
@@ -0,0 +1,385 @@
+/**
+ * \file observable_flag_table.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_OBSERVABLE_FLAG_TABLE_HPP_INCLUDED
+#define RECHARGEABLE_OBSERVABLE_FLAG_TABLE_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/dynamic_bit_set.hpp>
+#include <functional>
+#include <vector>
+
+namespace rtl
+{
+	template <typename FlagSet>
+	class observable_flag_table;
+
+	/**
+	 * A table of flag_sets whose changes are delivered to subscribers in batches.
+	 *
+	 * Mutations write the flag_set and mark the entity in a dirty bitmap,
+	 * so the cost of observing a write is a single OR. Nothing is compared
+	 * or called until sync, which visits only the dirty entities, diffs
+	 * them against their values at the previous sync and builds a change
+	 * log for each watched flag. The logs are then dispatched in order of
+	 * flag, with the changes of each flag in order of entity.
+	 *
+	 * Changes are coalesced over the frame. A flag that is set and then
+	 * cleared again before sync is not reported, and a flag changed many
+	 * times is reported once with its final value.
+	 *
+	 * \code
+	 * rtl::observable_flag_table<entity_set> table(entityCount);
+	 *
+	 * table.subscribe(Entity::Jumping, [] (Entity::Type flag, const change* changes, std::size_t count) { ... });
+	 * table.set(entity, Entity::Jumping);
+	 * ...
+	 * table.sync();
+	 * \endcode
+	 *
+	 * \tparam Enum The enumeration of flags.
+	 * \tparam Size The number of flags within the enumeration.
+	 * \tparam Names The bit field structure holding the names of the flags.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Enum, std::int32_t Size, typename Names>
+	class observable_flag_table<flag_set<Enum, Size, Names> >
+	{
+		public:
+
+			typedef flag_set<Enum, Size, Names> value_type;
+
+			/**
+			 * A change to a flag of an entity.
+			 */
+			struct change
+			{
+				/// The index of the entity
+				std::int32_t entity;
+				/// The value of the flag at the sync
+				bool value;
+			} ;
+
+			/// The type of function receiving the changes to a flag
+			typedef std::function<void(Enum, const change*, std::size_t)> callback_type;
+
+			/**
+			 * Creates an instance of the observable_flag_table class.
+			 *
+			 * All flags of all entities are initially cleared.
+			 *
+			 * \param count The number of entities in the table.
+			 */
+			explicit observable_flag_table(std::int32_t count)
+			: _flags(count)
+			, _previous(count)
+			, _dirty(count)
+			, _log(Size)
+			, _nextId(0)
+			, _dispatching(false)
+			{
+				RECHARGEABLE_ASSERT(count >= 0, "Invalid count");
+			}
+
+			//----------------------------------------------------------------------
+			// Table access
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the number of entities in the table.
+			 */
+			std::int32_t size() const
+			{
+				return static_cast<std::int32_t>(_flags.size());
+			}
+
+			/**
+			 * Gets the flags of an entity.
+			 *
+			 * \param entity The index of the entity.
+			 * \returns The current flags of the entity.
+			 */
+			const value_type& operator[] (std::int32_t entity) const
+			{
+				RECHARGEABLE_ASSERT((entity >= 0) && (entity < size()), "Invalid entity");
+
+				return _flags[entity];
+			}
+
+			/**
+			 * Gets the flags of an entity for writing.
+			 *
+			 * The entity is marked dirty, so any number of changes can be
+			 * made through the reference until the next sync.
+			 *
+			 * \param entity The index of the entity.
+			 * \returns The flags of the entity.
+			 */
+			value_type& modify(std::int32_t entity)
+			{
+				RECHARGEABLE_ASSERT((entity >= 0) && (entity < size()), "Invalid entity");
+
+				_dirty.set(entity);
+
+				return _flags[entity];
+			}
+
+			/**
+			 * Sets a flag of an entity.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flag The flag to set.
+			 */
+			void set(std::int32_t entity, Enum flag)
+			{
+				modify(entity).set(flag);
+			}
+
+			/**
+			 * Clears a flag of an entity.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flag The flag to clear.
+			 */
+			void clear(std::int32_t entity, Enum flag)
+			{
+				modify(entity).clear(flag);
+			}
+
+			/**
+			 * Toggles a flag of an entity.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flag The flag to toggle.
+			 */
+			void toggle(std::int32_t entity, Enum flag)
+			{
+				modify(entity).toggle(flag);
+			}
+
+			/**
+			 * Replaces the flags of an entity.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flags The new flags of the entity.
+			 */
+			void assign(std::int32_t entity, const value_type& flags)
+			{
+				modify(entity) = flags;
+			}
+
+			/**
+			 * Determines whether any entity has been written since the last sync.
+			 *
+			 * \returns \b true \b if an entity is dirty; \b false \b otherwise.
+			 */
+			bool is_dirty() const
+			{
+				return _dirty.any();
+			}
+
+			//----------------------------------------------------------------------
+			// Subscriptions
+			//----------------------------------------------------------------------
+
+			/**
+			 * Subscribes to the changes of a flag.
+			 *
+			 * Subscribers of the same flag are called in the order they
+			 * subscribed. Subscriptions cannot change during a sync.
+			 *
+			 * \param flag The flag to watch.
+			 * \param callback The function receiving the changes.
+			 * \returns The identifier of the subscription.
+			 */
+			std::int32_t subscribe(Enum flag, callback_type callback)
+			{
+				RECHARGEABLE_ASSERT(!_dispatching, "Cannot subscribe during a sync");
+				RECHARGEABLE_ASSERT((static_cast<std::int32_t>(flag) >= 0) && (static_cast<std::int32_t>(flag) < Size), "Invalid flag");
+
+				// Keep the subscriptions sorted by flag so sync dispatches in order
+				typename std::vector<subscription>::iterator position = _subscriptions.begin();
+
+				while ((position != _subscriptions.end()) && (position->flag <= flag))
+					++position;
+
+				const std::int32_t id = _nextId++;
+
+				subscription added;
+				added.id = id;
+				added.flag = flag;
+				added.callback = std::move(callback);
+
+				_subscriptions.insert(position, std::move(added));
+				_watched.set(flag);
+
+				return id;
+			}
+
+			/**
+			 * Removes a subscription.
+			 *
+			 * \param id The identifier returned by subscribe.
+			 * \returns \b true \b if the subscription was removed; \b false \b if it was not found.
+			 */
+			bool unsubscribe(std::int32_t id)
+			{
+				RECHARGEABLE_ASSERT(!_dispatching, "Cannot unsubscribe during a sync");
+
+				for (typename std::vector<subscription>::iterator position = _subscriptions.begin(); position != _subscriptions.end(); ++position)
+				{
+					if (position->id == id)
+					{
+						_subscriptions.erase(position);
+						update_watched();
+
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			//----------------------------------------------------------------------
+			// Sync
+			//----------------------------------------------------------------------
+
+			/**
+			 * Dispatches the changes made since the last sync.
+			 *
+			 * Each subscriber is called at most once, with every change to
+			 * its flag. Writes made by subscribers are reported at the next
+			 * sync.
+			 *
+			 * \returns The number of changes to watched flags.
+			 */
+			std::size_t sync()
+			{
+				RECHARGEABLE_ASSERT(!_dispatching, "Cannot sync during a sync");
+
+				std::size_t changes = 0;
+				value_type logged;
+
+				_dirty.for_each_set([&] (std::int32_t entity)
+				{
+					const value_type& current = _flags[entity];
+					const value_type changed = (current ^ _previous[entity]) & _watched;
+
+					_previous[entity] = current;
+
+					changed.for_each_set([&] (Enum flag)
+					{
+						change entry;
+						entry.entity = entity;
+						entry.value = current.is_set(flag);
+
+						_log[flag].push_back(entry);
+						++changes;
+					});
+
+					logged |= changed;
+				});
+
+				_dirty.reset();
+
+				_dispatching = true;
+
+				for (std::size_t i = 0; i < _subscriptions.size(); ++i)
+				{
+					const std::vector<change>& log = _log[_subscriptions[i].flag];
+
+					if (!log.empty())
+						_subscriptions[i].callback(_subscriptions[i].flag, log.data(), log.size());
+				}
+
+				_dispatching = false;
+
+				logged.for_each_set([&] (Enum flag)
+				{
+					_log[flag].clear();
+				});
+
+				return changes;
+			}
+
+		private:
+
+			/**
+			 * A function watching a flag.
+			 */
+			struct subscription
+			{
+				std::int32_t id;
+				Enum flag;
+				callback_type callback;
+			} ;
+
+			/**
+			 * Recomputes the flags that have subscribers.
+			 */
+			void update_watched()
+			{
+				_watched = value_type();
+
+				for (std::size_t i = 0; i < _subscriptions.size(); ++i)
+					_watched.set(_subscriptions[i].flag);
+			}
+
+			/// The current flags of each entity
+			std::vector<value_type> _flags;
+			/// The flags of each entity at the last sync
+			std::vector<value_type> _previous;
+			/// The entities written since the last sync
+			dynamic_bit_set _dirty;
+			/// The changes to each flag found by sync
+			std::vector<std::vector<change> > _log;
+			/// The subscriptions sorted by flag
+			std::vector<subscription> _subscriptions;
+			/// The flags that have subscribers
+			value_type _watched;
+			/// The identifier of the next subscription
+			std::int32_t _nextId;
+			/// Whether subscribers are being called
+			bool _dispatching;
+
+	} ; // end class observable_flag_table
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_OBSERVABLE_FLAG_TABLE_HPP_INCLUDED
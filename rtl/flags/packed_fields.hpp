@@ -0,0 +1,504 @@
+/**
+ * \file packed_fields.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_PACKED_FIELDS_HPP_INCLUDED
+#define RECHARGEABLE_PACKED_FIELDS_HPP_INCLUDED
+
+#include <rtl/flags/detail/bit_set.hpp>
+#include <rtl/flags/detail/bit_set_ops.hpp>
+#include <type_traits>
+
+namespace rtl
+{
+	/**
+	 * Describes a field of packed_fields.
+	 *
+	 * A field occupies Width bits starting at bit Offset. The value is
+	 * converted to and from an unsigned integer so T can be an unsigned
+	 * integer, an enumeration with non-negative values, or bool.
+	 *
+	 * \tparam Offset The first bit of the field.
+	 * \tparam Width The number of bits in the field.
+	 * \tparam T The type of the value held in the field.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <std::int32_t Offset, std::int32_t Width, typename T = std::uint32_t>
+	struct bit_field
+	{
+		static_assert(Offset >= 0, "Invalid offset");
+		static_assert((Width > 0) && (Width <= 64), "Invalid width");
+		static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "Field values must be integral or enumerations");
+
+		typedef T value_type;
+
+		/// The first bit of the field
+		static const std::int32_t offset = Offset;
+		/// The number of bits in the field
+		static const std::int32_t width = Width;
+		/// The largest value the field holds
+		static const std::uint64_t max_value = (Width == 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << Width) - 1;
+
+	} ; // end struct bit_field<Offset, Width, T>
+
+	/**
+	 * Describes a single bit flag of packed_fields.
+	 *
+	 * \tparam Offset The bit of the flag.
+	 */
+	template <std::int32_t Offset>
+	using bit_flag = bit_field<Offset, 1, bool>;
+
+	namespace detail
+	{
+		/**
+		 * Determines whether any of the fields share a bit.
+		 */
+		template <typename... Fields>
+		constexpr bool fields_overlap()
+		{
+			const std::int32_t offsets[] = { Fields::offset..., 0 };
+			const std::int32_t widths[] = { Fields::width..., 0 };
+
+			for (std::size_t i = 0; i < sizeof...(Fields); ++i)
+			{
+				for (std::size_t j = i + 1; j < sizeof...(Fields); ++j)
+				{
+					if ((offsets[i] < offsets[j] + widths[j]) && (offsets[j] < offsets[i] + widths[i]))
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+		/**
+		 * Computes the number of bits spanned by the fields.
+		 */
+		template <typename... Fields>
+		constexpr std::int32_t fields_bits()
+		{
+			const std::int32_t ends[] = { (Fields::offset + Fields::width)..., 0 };
+
+			std::int32_t bits = 1;
+
+			for (std::size_t i = 0; i < sizeof...(Fields); ++i)
+				bits = (ends[i] > bits) ? ends[i] : bits;
+
+			return bits;
+		}
+
+		/**
+		 * Determines whether a field is one of the fields.
+		 */
+		template <typename Field, typename... Fields>
+		constexpr bool contains_field()
+		{
+			const bool matches[] = { std::is_same<Field, Fields>::value..., false };
+
+			for (std::size_t i = 0; i < sizeof...(Fields); ++i)
+			{
+				if (matches[i])
+					return true;
+			}
+
+			return false;
+		}
+
+	} // end namespace detail
+
+	/**
+	 * Declares the fields stored within packed_fields.
+	 *
+	 * Fields must not share bits and must not straddle a word of the
+	 * underlying storage. The storage is the smallest of an 8, 16, 32 or
+	 * 64-bit word that holds the layout, so the 10-bit layout below takes
+	 * 2 bytes. Larger layouts are stored in an array of 64-bit words.
+	 *
+	 * \code
+	 * typedef rtl::bit_field<0, 2, facing> facing_field;
+	 * typedef rtl::bit_field<2, 3, stance> stance_field;
+	 * typedef rtl::bit_field<5, 4> team_field;
+	 * typedef rtl::bit_flag<9> alive_flag;
+	 *
+	 * typedef rtl::packed_layout<facing_field, stance_field, team_field, alive_flag> entity_layout;
+	 * \endcode
+	 *
+	 * \tparam Fields The bit_field types within the layout.
+	 */
+	template <typename... Fields>
+	struct packed_layout
+	{
+		static_assert(!detail::fields_overlap<Fields...>(), "Fields share bits");
+
+		/// The number of bits spanned by the fields
+		static const std::int32_t bits = detail::fields_bits<Fields...>();
+
+		/// The bits used for storage
+		typedef detail::bit_set<detail::select_bits<bits>::value> container_type;
+
+		/**
+		 * Determines whether a field is part of the layout.
+		 */
+		template <typename Field>
+		struct contains : std::integral_constant<bool, detail::contains_field<Field, Fields...>()> { } ;
+
+	} ; // end struct packed_layout<Fields...>
+
+	namespace detail
+	{
+		/**
+		 * Describes where a field lives within the storage of a layout.
+		 */
+		template <typename Layout, typename Field>
+		struct field_location
+		{
+			static_assert(Layout::template contains<Field>::value, "Field is not part of the layout");
+
+			typedef typename Layout::container_type container_type;
+			typedef typename container_type::word_type word_type;
+
+			/// The word holding the field
+			static const std::int32_t word = Field::offset / container_type::word_bits;
+			/// The shift of the field within the word
+			static const std::int32_t shift = Field::offset % container_type::word_bits;
+			/// The mask of the field within the word
+			static const word_type mask = static_cast<word_type>(Field::max_value << shift);
+
+			static_assert(shift + Field::width <= container_type::word_bits, "Field straddles a word boundary");
+
+		} ; // end struct field_location<Layout, Field>
+
+	} // end namespace detail
+
+	template <typename Layout>
+	class packed_pattern;
+
+	/**
+	 * Stores multi-bit fields and flags within a single bit_set.
+	 *
+	 * Small enumerated state is kept next to flags in the same words so
+	 * the state of an entity is packed as tightly as the layout allows.
+	 * Fields are accessed through their bit_field type, so a field of one
+	 * layout cannot be read through another.
+	 *
+	 * \code
+	 * rtl::packed_fields<entity_layout> state;
+	 *
+	 * state.set<stance_field>(stance::crouched);
+	 * state.set(alive_flag(), true);
+	 *
+	 * if (state.get<stance_field>() == stance::crouched) { ... }
+	 * \endcode
+	 *
+	 * \tparam Layout The packed_layout of the fields.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Layout>
+	class packed_fields
+	{
+		public:
+
+			typedef Layout layout_type;
+			typedef typename Layout::container_type container_type;
+			typedef typename container_type::word_type word_type;
+
+			/**
+			 * Creates an instance of the packed_fields class with all fields zeroed.
+			 */
+			constexpr packed_fields()
+			: _bits()
+			{ }
+
+			//----------------------------------------------------------------------
+			// Field access
+			//----------------------------------------------------------------------
+
+			/**
+			 * Gets the value of a field.
+			 *
+			 * \tparam Field The field to get.
+			 * \returns The value of the field.
+			 */
+			template <typename Field>
+			constexpr typename Field::value_type get() const
+			{
+				typedef detail::field_location<Layout, Field> location;
+
+				const word_type word = detail::word_data(_bits)[location::word];
+
+				return static_cast<typename Field::value_type>((word & location::mask) >> location::shift);
+			}
+
+			/**
+			 * Gets the value of a field.
+			 *
+			 * \param field The field to get.
+			 * \returns The value of the field.
+			 */
+			template <typename Field>
+			constexpr typename Field::value_type get(Field) const
+			{
+				return get<Field>();
+			}
+
+			/**
+			 * Sets the value of a field.
+			 *
+			 * \tparam Field The field to set.
+			 * \param value The value of the field.
+			 */
+			template <typename Field>
+			constexpr void set(typename Field::value_type value)
+			{
+				typedef detail::field_location<Layout, Field> location;
+
+				const std::uint64_t raw = static_cast<std::uint64_t>(value);
+
+				RECHARGEABLE_ASSERT(raw <= Field::max_value, "Value does not fit within the field");
+
+				word_type& word = detail::word_data(_bits)[location::word];
+
+				word = static_cast<word_type>((word & ~location::mask) | ((static_cast<word_type>(raw) << location::shift) & location::mask));
+			}
+
+			/**
+			 * Sets the value of a field.
+			 *
+			 * \param field The field to set.
+			 * \param value The value of the field.
+			 */
+			template <typename Field>
+			constexpr void set(Field, typename Field::value_type value)
+			{
+				set<Field>(value);
+			}
+
+			/**
+			 * Zeroes all fields.
+			 */
+			constexpr void clear()
+			{
+				detail::clear_bit_set(_bits);
+			}
+
+			//----------------------------------------------------------------------
+			// Queries
+			//----------------------------------------------------------------------
+
+			/**
+			 * Determines whether the fields match a pattern.
+			 *
+			 * \param pattern The pattern to match.
+			 * \returns \b true \b if the fields match; \b false \b otherwise.
+			 */
+			constexpr bool matches(const packed_pattern<Layout>& pattern) const
+			{
+				return pattern(*this);
+			}
+
+			/**
+			 * Gets the underlying storage.
+			 *
+			 * \returns The underlying storage.
+			 */
+			constexpr const container_type& container() const
+			{
+				return _bits;
+			}
+
+			constexpr bool operator== (const packed_fields& other) const
+			{
+				return _bits == other._bits;
+			}
+
+			constexpr bool operator!= (const packed_fields& other) const
+			{
+				return !(_bits == other._bits);
+			}
+
+		private:
+
+			/// The packed fields
+			container_type _bits;
+
+	} ; // end class packed_fields
+
+	/**
+	 * Matches packed_fields against required field values.
+	 *
+	 * Every required value folds into a mask and expected value so a
+	 * pattern is tested with one masked compare per word regardless of
+	 * the number of fields involved.
+	 *
+	 * \code
+	 * constexpr auto crouchedRed = rtl::packed_pattern<entity_layout>()
+	 *     .require<stance_field>(stance::crouched)
+	 *     .require<team_field>(2);
+	 * \endcode
+	 *
+	 * \tparam Layout The packed_layout of the fields.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Layout>
+	class packed_pattern
+	{
+		public:
+
+			typedef typename Layout::container_type container_type;
+			typedef typename container_type::word_type word_type;
+
+			/**
+			 * Creates an instance of the packed_pattern class that matches everything.
+			 */
+			constexpr packed_pattern()
+			: _mask()
+			, _expect()
+			{ }
+
+			/**
+			 * Requires a field to hold a value.
+			 *
+			 * \tparam Field The field to compare.
+			 * \param value The required value.
+			 * \returns The pattern.
+			 */
+			template <typename Field>
+			constexpr packed_pattern require(typename Field::value_type value) const
+			{
+				typedef detail::field_location<Layout, Field> location;
+
+				const std::uint64_t raw = static_cast<std::uint64_t>(value);
+
+				RECHARGEABLE_ASSERT(raw <= Field::max_value, "Value does not fit within the field");
+
+				packed_pattern result(*this);
+
+				word_type& mask = detail::word_data(result._mask)[location::word];
+				word_type& expect = detail::word_data(result._expect)[location::word];
+
+				mask = static_cast<word_type>(mask | location::mask);
+				expect = static_cast<word_type>((expect & ~location::mask) | ((static_cast<word_type>(raw) << location::shift) & location::mask));
+
+				return result;
+			}
+
+			/**
+			 * Requires a field to hold a value.
+			 *
+			 * \param field The field to compare.
+			 * \param value The required value.
+			 * \returns The pattern.
+			 */
+			template <typename Field>
+			constexpr packed_pattern require(Field, typename Field::value_type value) const
+			{
+				return require<Field>(value);
+			}
+
+			/**
+			 * Determines whether packed_fields match the pattern.
+			 *
+			 * \param fields The fields to test.
+			 * \returns \b true \b if the fields match; \b false \b otherwise.
+			 */
+			constexpr bool operator() (const packed_fields<Layout>& fields) const
+			{
+				const word_type* value = detail::word_data(fields.container());
+				const word_type* mask = detail::word_data(_mask);
+				const word_type* expect = detail::word_data(_expect);
+
+				word_type difference = 0;
+
+				for (std::int32_t i = 0; i < container_type::word_count; ++i)
+					difference |= static_cast<word_type>((value[i] & mask[i]) ^ expect[i]);
+
+				return difference == 0;
+			}
+
+			/**
+			 * Gets the bits compared by the pattern.
+			 */
+			constexpr const container_type& mask() const
+			{
+				return _mask;
+			}
+
+			/**
+			 * Gets the expected value of the compared bits.
+			 */
+			constexpr const container_type& expect() const
+			{
+				return _expect;
+			}
+
+		private:
+
+			/// The bits that are compared
+			container_type _mask;
+			/// The expected value of the compared bits
+			container_type _expect;
+
+	} ; // end class packed_pattern
+
+	/**
+	 * Counts the packed_fields in an array that match a pattern.
+	 *
+	 * \param fields The packed_fields to query.
+	 * \param count The number of packed_fields.
+	 * \param pattern The pattern to match.
+	 * \returns The number of matching packed_fields.
+	 */
+	template <typename Layout>
+	inline std::size_t count_matching(const packed_fields<Layout>* fields, std::size_t count, const packed_pattern<Layout>& pattern)
+	{
+		std::size_t total = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+			total += pattern(fields[i]) ? 1 : 0;
+
+		return total;
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_PACKED_FIELDS_HPP_INCLUDED
@@ -0,0 +1,381 @@
+/**
+ * \file parallel_query.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_PARALLEL_QUERY_HPP_INCLUDED
+#define RECHARGEABLE_PARALLEL_QUERY_HPP_INCLUDED
+
+#include <rtl/flags/flag_batch.hpp>
+#include <rtl/flags/flag_query.hpp>
+#include <rtl/flags/dynamic_bit_set.hpp>
+#include <rtl/flags/flag_thread_pool.hpp>
+#include <atomic>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Parallel queries
+//
+// Each query splits an array into chunks, runs the chunks through an
+// executor and merges the per chunk results in chunk order, so results
+// match the sequential queries exactly. Chunks are a multiple of 64
+// bytes so chunks of an array aligned to a cache line never share a
+// line. Any executor described by inline_executor can be used,
+// including flag_thread_pool.
+//----------------------------------------------------------------------
+
+namespace rtl
+{
+	namespace detail
+	{
+		/// The number of bytes targeted by each chunk of a parallel query
+		const std::size_t parallel_chunk_bytes = 64 * 1024;
+
+		/**
+		 * Gets the number of elements within a chunk of a parallel query.
+		 *
+		 * \tparam T The type of element.
+		 */
+		template <typename T>
+		constexpr std::size_t parallel_chunk_size()
+		{
+			// Any multiple of 64 elements is a multiple of 64 bytes
+			return ((parallel_chunk_bytes / sizeof(T)) & ~std::size_t(63)) > 64
+				? ((parallel_chunk_bytes / sizeof(T)) & ~std::size_t(63))
+				: 64;
+		}
+
+		/**
+		 * Runs a function over the chunks of an array.
+		 *
+		 * \param executor The executor to run the chunks on.
+		 * \param count The number of elements.
+		 * \param chunkSize The number of elements within a chunk.
+		 * \param function The function to invoke with the chunk index, first element and element count.
+		 * \returns The number of chunks.
+		 */
+		template <typename Executor, typename Function>
+		inline std::int32_t for_each_chunk(Executor& executor, std::size_t count, std::size_t chunkSize, Function function)
+		{
+			const std::int32_t chunks = static_cast<std::int32_t>((count + chunkSize - 1) / chunkSize);
+
+			executor(chunks, [&] (std::int32_t chunk)
+			{
+				const std::size_t first = static_cast<std::size_t>(chunk) * chunkSize;
+				const std::size_t last = (first + chunkSize < count) ? first + chunkSize : count;
+
+				function(chunk, first, last - first);
+			});
+
+			return chunks;
+		}
+
+		/**
+		 * Sums the per chunk counts of a parallel query.
+		 */
+		template <typename Executor, typename Count>
+		inline std::size_t parallel_sum(Executor& executor, std::size_t count, std::size_t chunkSize, Count countChunk)
+		{
+			std::vector<std::size_t> totals((count + chunkSize - 1) / chunkSize);
+
+			for_each_chunk(executor, count, chunkSize, [&] (std::int32_t chunk, std::size_t first, std::size_t size)
+			{
+				totals[chunk] = countChunk(first, size);
+			});
+
+			std::size_t total = 0;
+
+			for (std::size_t value : totals)
+				total += value;
+
+			return total;
+		}
+
+		/**
+		 * Appends the per chunk indices of a parallel query in chunk order.
+		 */
+		template <typename Executor, typename Gather>
+		inline void parallel_gather(Executor& executor, std::size_t count, std::size_t chunkSize, Gather gatherChunk, std::vector<std::int32_t>& result)
+		{
+			std::vector<std::vector<std::int32_t> > chunks((count + chunkSize - 1) / chunkSize);
+
+			for_each_chunk(executor, count, chunkSize, [&] (std::int32_t chunk, std::size_t first, std::size_t size)
+			{
+				gatherChunk(first, size, chunks[chunk]);
+
+				// Chunk results are relative to the start of the chunk
+				for (std::int32_t& index : chunks[chunk])
+					index += static_cast<std::int32_t>(first);
+			});
+
+			std::size_t total = 0;
+
+			for (const std::vector<std::int32_t>& indices : chunks)
+				total += indices.size();
+
+			result.reserve(result.size() + total);
+
+			for (const std::vector<std::int32_t>& indices : chunks)
+				result.insert(result.end(), indices.begin(), indices.end());
+		}
+
+		/**
+		 * Determines whether any element of an array satisfies a test.
+		 *
+		 * Chunks that start after a match has been found are skipped.
+		 */
+		template <typename Executor, typename Test>
+		inline bool parallel_any(Executor& executor, std::size_t count, std::size_t chunkSize, Test test)
+		{
+			std::atomic<bool> found(false);
+
+			for_each_chunk(executor, count, chunkSize, [&] (std::int32_t, std::size_t first, std::size_t size)
+			{
+				if (found.load(std::memory_order_relaxed))
+					return;
+
+				for (std::size_t i = first; i < first + size; ++i)
+				{
+					if (test(i))
+					{
+						found.store(true, std::memory_order_relaxed);
+						return;
+					}
+				}
+			});
+
+			return found.load();
+		}
+
+	} // end namespace detail
+
+	//----------------------------------------------------------------------
+	// flag_set arrays
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the flag_sets in an array with a flag set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to test.
+	 * \returns The number of flag_sets with the flag set.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names>
+	inline std::size_t parallel_count_set(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		return detail::parallel_sum(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [=] (std::size_t first, std::size_t size)
+		{
+			return count_set(flags + first, size, flag);
+		});
+	}
+
+	/**
+	 * Counts the flag_sets in an array that match a predicate.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param predicate The predicate to match.
+	 * \returns The number of matching flag_sets.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names, std::int32_t AnyCount>
+	inline std::size_t parallel_count_matching(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_predicate<flag_set<Enum, Size, Names>, AnyCount>& predicate)
+	{
+		return detail::parallel_sum(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [&] (std::size_t first, std::size_t size)
+		{
+			return count_matching(flags + first, size, predicate);
+		});
+	}
+
+	/**
+	 * Determines whether any flag_set in an array has a flag set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to test.
+	 * \returns \b true \b if any flag_set has the flag set; \b false \b otherwise.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names>
+	inline bool parallel_any_set(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		return detail::parallel_any(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [=] (std::size_t i)
+		{
+			return flags[i].is_set(flag);
+		});
+	}
+
+	/**
+	 * Determines whether every flag_set in an array has a flag set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param flag The flag to test.
+	 * \returns \b true \b if every flag_set has the flag set; \b false \b otherwise.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names>
+	inline bool parallel_all_set(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, Enum flag)
+	{
+		return !detail::parallel_any(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [=] (std::size_t i)
+		{
+			return !flags[i].is_set(flag);
+		});
+	}
+
+	/**
+	 * Finds the flag_sets in an array that have all the flags of a mask.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param mask The flags that must be set.
+	 * \param result The indices of the matching flag_sets are appended to the vector in order.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names>
+	inline void parallel_gather_matching(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_set<Enum, Size, Names>& mask, std::vector<std::int32_t>& result)
+	{
+		detail::parallel_gather(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [&] (std::size_t first, std::size_t size, std::vector<std::int32_t>& indices)
+		{
+			gather_matching(flags + first, size, mask, indices);
+		}, result);
+	}
+
+	/**
+	 * Finds the flag_sets in an array that match a predicate.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param flags The flag_sets to query.
+	 * \param count The number of flag_sets.
+	 * \param predicate The predicate to match.
+	 * \param result The indices of the matching flag_sets are appended to the vector in order.
+	 */
+	template <typename Executor, typename Enum, std::int32_t Size, typename Names, std::int32_t AnyCount>
+	inline void parallel_gather_matching(Executor& executor, const flag_set<Enum, Size, Names>* flags, std::size_t count, const flag_predicate<flag_set<Enum, Size, Names>, AnyCount>& predicate, std::vector<std::int32_t>& result)
+	{
+		detail::parallel_gather(executor, count, detail::parallel_chunk_size<flag_set<Enum, Size, Names> >(), [&] (std::size_t first, std::size_t size, std::vector<std::int32_t>& indices)
+		{
+			gather_matching(flags + first, size, predicate, indices);
+		}, result);
+	}
+
+	//----------------------------------------------------------------------
+	// Bitmaps
+	//----------------------------------------------------------------------
+
+	/**
+	 * Counts the bits set in a basic_dynamic_bit_set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param bits The bits to count.
+	 * \returns The number of bits set.
+	 */
+	template <typename Executor, typename Allocator>
+	inline std::size_t parallel_count(Executor& executor, const basic_dynamic_bit_set<Allocator>& bits)
+	{
+		const std::uint64_t* words = bits.data();
+
+		return detail::parallel_sum(executor, static_cast<std::size_t>(bits.word_count()), detail::parallel_chunk_size<std::uint64_t>(), [=] (std::size_t first, std::size_t size)
+		{
+			return static_cast<std::size_t>(detail::count_words(words + first, static_cast<std::int32_t>(size)));
+		});
+	}
+
+	/**
+	 * Determines whether any bit is set in a basic_dynamic_bit_set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param bits The bits to test.
+	 * \returns \b true \b if any bit is set; \b false \b otherwise.
+	 */
+	template <typename Executor, typename Allocator>
+	inline bool parallel_any(Executor& executor, const basic_dynamic_bit_set<Allocator>& bits)
+	{
+		const std::uint64_t* words = bits.data();
+
+		return detail::parallel_any(executor, static_cast<std::size_t>(bits.word_count()), detail::parallel_chunk_size<std::uint64_t>(), [=] (std::size_t i)
+		{
+			return words[i] != 0;
+		});
+	}
+
+	/**
+	 * Determines whether every bit is set in a basic_dynamic_bit_set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param bits The bits to test.
+	 * \returns \b true \b if every bit is set; \b false \b otherwise.
+	 */
+	template <typename Executor, typename Allocator>
+	inline bool parallel_all(Executor& executor, const basic_dynamic_bit_set<Allocator>& bits)
+	{
+		return parallel_count(executor, bits) == static_cast<std::size_t>(bits.size());
+	}
+
+	/**
+	 * Finds the locations of the bits set in a basic_dynamic_bit_set.
+	 *
+	 * \param executor The executor to run the query on.
+	 * \param bits The bits to search.
+	 * \param result The locations of the bits set are appended to the vector in order.
+	 */
+	template <typename Executor, typename Allocator>
+	inline void parallel_gather_set(Executor& executor, const basic_dynamic_bit_set<Allocator>& bits, std::vector<std::int32_t>& result)
+	{
+		const std::uint64_t* words = bits.data();
+		const std::size_t wordCount = static_cast<std::size_t>(bits.word_count());
+		const std::size_t chunkSize = detail::parallel_chunk_size<std::uint64_t>();
+		std::vector<std::vector<std::int32_t> > chunks((wordCount + chunkSize - 1) / chunkSize);
+
+		detail::for_each_chunk(executor, wordCount, chunkSize, [&] (std::int32_t chunk, std::size_t first, std::size_t size)
+		{
+			const std::int32_t offset = static_cast<std::int32_t>(first * 64);
+			std::vector<std::int32_t>& indices = chunks[chunk];
+
+			detail::for_each_word_bit(words + first, static_cast<std::int32_t>(size), [&] (std::int32_t location)
+			{
+				indices.push_back(offset + location);
+			});
+		});
+
+		for (const std::vector<std::int32_t>& indices : chunks)
+			result.insert(result.end(), indices.begin(), indices.end());
+	}
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_PARALLEL_QUERY_HPP_INCLUDED
@@ -0,0 +1,267 @@
+/**
+ * \file rank_select_index.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_RANK_SELECT_INDEX_HPP_INCLUDED
+#define RECHARGEABLE_RANK_SELECT_INDEX_HPP_INCLUDED
+
+#include <rtl/flags/dynamic_bit_set.hpp>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * Precomputed rank and select over a large array of 64-bit words.
+	 *
+	 * The words are split into blocks of 512 bits. Each block stores the
+	 * number of bits set before it along with the running count at each
+	 * of its words packed into 9-bit fields. A rank is then a load of the
+	 * block, a shift of the packed counts and one popcount. A select
+	 * binary searches the blocks, scans the packed counts and selects
+	 * within a single word.
+	 *
+	 * The index adds 128 bits per 512 bits indexed. It refers to the
+	 * words without owning them and must be rebuilt when they change.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	class rank_select_index
+	{
+		public:
+
+			/// The number of words within a block
+			static const std::int32_t block_words = 8;
+			/// The number of bits within a block
+			static const std::int32_t block_bits = block_words * 64;
+
+			/**
+			 * Creates an empty instance of the rank_select_index class.
+			 */
+			rank_select_index()
+			: _words(nullptr)
+			, _wordCount(0)
+			, _count(0)
+			{ }
+
+			/**
+			 * Creates an instance of the rank_select_index class.
+			 *
+			 * \param words The words to index.
+			 * \param wordCount The number of words.
+			 */
+			rank_select_index(const std::uint64_t* words, std::int32_t wordCount)
+			: _words(nullptr)
+			, _wordCount(0)
+			, _count(0)
+			{
+				build(words, wordCount);
+			}
+
+			/**
+			 * Creates an instance of the rank_select_index class over a basic_dynamic_bit_set.
+			 *
+			 * \param bits The bits to index.
+			 */
+			template <typename Allocator>
+			explicit rank_select_index(const basic_dynamic_bit_set<Allocator>& bits)
+			: _words(nullptr)
+			, _wordCount(0)
+			, _count(0)
+			{
+				build(bits.data(), bits.word_count());
+			}
+
+			/**
+			 * Builds the index.
+			 *
+			 * \param words The words to index.
+			 * \param wordCount The number of words.
+			 */
+			void build(const std::uint64_t* words, std::int32_t wordCount)
+			{
+				RECHARGEABLE_ASSERT(((words != nullptr) || (wordCount == 0)), "Invalid words");
+				RECHARGEABLE_ASSERT(wordCount >= 0, "Invalid word count");
+
+				const std::int32_t blockCount = (wordCount + block_words - 1) / block_words;
+
+				_words = words;
+				_wordCount = wordCount;
+				_blocks.assign(static_cast<std::size_t>(blockCount) * 2, 0);
+
+				std::uint64_t total = 0;
+
+				for (std::int32_t block = 0; block < blockCount; ++block)
+				{
+					const std::int32_t first = block * block_words;
+					const std::int32_t last = (first + block_words < wordCount) ? first + block_words : wordCount;
+
+					std::uint64_t packed = 0;
+					std::uint64_t running = 0;
+
+					for (std::int32_t i = first; i < last; ++i)
+					{
+						// The running count before word i is stored for words 1 through 7
+						if (i != first)
+							packed |= running << (9 * (i - first - 1));
+
+						running += detail::popcount(words[i]);
+					}
+
+					// Words past the end of the array report the block total
+					for (std::int32_t i = last; i < first + block_words; ++i)
+						packed |= running << (9 * (i - first - 1));
+
+					_blocks[block * 2] = total;
+					_blocks[block * 2 + 1] = packed;
+
+					total += running;
+				}
+
+				_count = static_cast<std::int32_t>(total);
+			}
+
+			/**
+			 * Counts the bits set before a location.
+			 *
+			 * \param location The location to count up to. May be one past the last bit.
+			 * \returns The number of bits set before the location.
+			 */
+			std::int32_t rank(std::int32_t location) const
+			{
+				RECHARGEABLE_ASSERT((location >= 0) && (location <= _wordCount * 64), "Invalid location");
+
+				if (location == _wordCount * 64)
+					return _count;
+
+				const std::int32_t word = location >> 6;
+				const std::int32_t block = word >> 3;
+				const std::int32_t offset = word & (block_words - 1);
+
+				std::uint64_t total = _blocks[block * 2];
+
+				if (offset != 0)
+					total += (_blocks[block * 2 + 1] >> (9 * (offset - 1))) & 0x1ff;
+
+				return static_cast<std::int32_t>(total) + detail::popcount(_words[word] & ((std::uint64_t(1) << (location & 63)) - 1));
+			}
+
+			/**
+			 * Finds the location of the nth bit set.
+			 *
+			 * \param n The zero based index of the set bit.
+			 * \returns The location of the nth bit set, or -1 if fewer bits are set.
+			 */
+			std::int32_t select(std::int32_t n) const
+			{
+				RECHARGEABLE_ASSERT(n >= 0, "Invalid index");
+
+				if (n >= _count)
+					return -1;
+
+				// Find the last block starting at or before the bit
+				std::int32_t low = 0;
+				std::int32_t high = static_cast<std::int32_t>(_blocks.size() / 2) - 1;
+
+				while (low < high)
+				{
+					const std::int32_t middle = (low + high + 1) / 2;
+
+					if (_blocks[middle * 2] <= static_cast<std::uint64_t>(n))
+						low = middle;
+					else
+						high = middle - 1;
+				}
+
+				std::uint64_t remaining = static_cast<std::uint64_t>(n) - _blocks[low * 2];
+				const std::uint64_t packed = _blocks[low * 2 + 1];
+
+				// Find the word within the block
+				std::int32_t offset = 0;
+				std::uint64_t before = 0;
+
+				while (offset < block_words - 1)
+				{
+					const std::uint64_t running = (packed >> (9 * offset)) & 0x1ff;
+
+					if (running > remaining)
+						break;
+
+					before = running;
+					++offset;
+				}
+
+				const std::int32_t word = low * block_words + offset;
+
+				return (word * 64) + detail::select_bit(_words[word], static_cast<std::int32_t>(remaining - before));
+			}
+
+			/**
+			 * Gets the number of bits set.
+			 *
+			 * \returns The number of bits set.
+			 */
+			std::int32_t count() const
+			{
+				return _count;
+			}
+
+			/**
+			 * Gets the number of bytes used by the index.
+			 *
+			 * \returns The number of bytes used by the index.
+			 */
+			std::size_t memory_usage() const
+			{
+				return _blocks.size() * sizeof(std::uint64_t);
+			}
+
+		private:
+
+			/// The indexed words
+			const std::uint64_t* _words;
+			/// The number of indexed words
+			std::int32_t _wordCount;
+			/// The number of bits set
+			std::int32_t _count;
+			/// The rank before each block followed by its packed word counts
+			std::vector<std::uint64_t> _blocks;
+
+	} ; // end class rank_select_index
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_RANK_SELECT_INDEX_HPP_INCLUDED
@@ -0,0 +1,520 @@
+/**
+ * \file timed_flag_manager.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_TIMED_FLAG_MANAGER_HPP_INCLUDED
+#define RECHARGEABLE_TIMED_FLAG_MANAGER_HPP_INCLUDED
+
+#include <rtl/flags/flag_set.hpp>
+#include <rtl/flags/detail/intrinsics.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace rtl
+{
+	/**
+	 * Expires flags after a number of ticks using a hierarchical timer wheel.
+	 *
+	 * Each timed flag is a node in one of four wheels of 64 slots. The
+	 * first wheel holds timers due within 64 ticks, and each wheel after
+	 * covers 64 times the range of the one before it. Advancing a tick
+	 * visits one slot of the first wheel, and a slot of a higher wheel
+	 * only when the lower wheel wraps, at which point its timers cascade
+	 * down. Timers beyond the range of the last wheel are parked in it
+	 * and rescheduled each time their slot comes around.
+	 *
+	 * The cost of a tick is proportional to the number of timers that
+	 * expire or cascade rather than the number of entities or flags.
+	 *
+	 * The manager does not own the flags. Entities are indices into an
+	 * array of flag_sets passed to set and advance.
+	 *
+	 * \code
+	 * rtl::timed_flag_manager<Status::Type> timers;
+	 *
+	 * timers.set(&statuses[0], entity, Status::Stunned, 120);
+	 * ...
+	 * timers.advance(&statuses[0]);
+	 * \endcode
+	 *
+	 * \tparam Enum The enumeration of flags.
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	template <typename Enum>
+	class timed_flag_manager
+	{
+		public:
+
+			/// The number of wheels
+			static const std::int32_t levels = 4;
+			/// The number of bits of the tick selecting a slot within a wheel
+			static const std::int32_t slot_bits = 6;
+			/// The number of slots within a wheel
+			static const std::int32_t slot_count = 1 << slot_bits;
+
+			/**
+			 * Creates an instance of the timed_flag_manager class.
+			 *
+			 * \param now The current tick.
+			 */
+			explicit timed_flag_manager(std::uint64_t now = 0)
+			: _now(now)
+			, _free(-1)
+			{
+				for (std::int32_t level = 0; level < levels; ++level)
+				{
+					_occupied[level] = 0;
+
+					for (std::int32_t slot = 0; slot < slot_count; ++slot)
+						_slots[level][slot] = -1;
+				}
+			}
+
+			//----------------------------------------------------------------------
+			// Timers
+			//----------------------------------------------------------------------
+
+			/**
+			 * Sets a flag that expires after a number of ticks.
+			 *
+			 * A flag that already has a timer is rescheduled.
+			 *
+			 * \param flags The flag_sets of the entities.
+			 * \param entity The index of the entity.
+			 * \param flag The flag to set.
+			 * \param duration The number of ticks until the flag is cleared. Must be greater than zero.
+			 */
+			template <std::int32_t Size, typename Names>
+			void set(flag_set<Enum, Size, Names>* flags, std::int32_t entity, Enum flag, std::uint64_t duration)
+			{
+				RECHARGEABLE_ASSERT(entity >= 0, "Invalid entity");
+				RECHARGEABLE_ASSERT(duration > 0, "Duration must be greater than zero");
+
+				flags[entity].set(flag);
+
+				const std::uint64_t key = make_key(entity, flag);
+				typename lookup_type::iterator found = _lookup.find(key);
+				std::int32_t node;
+
+				if (found != _lookup.end())
+				{
+					node = found->second;
+					unlink(node);
+				}
+				else
+				{
+					node = allocate();
+					_nodes[node].entity = entity;
+					_nodes[node].flag = flag;
+					_lookup.emplace(key, node);
+				}
+
+				_nodes[node].expiry = _now + duration;
+				schedule(node);
+			}
+
+			/**
+			 * Stops the timer of a flag without clearing the flag.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flag The flag.
+			 * \returns \b true \b if a timer was stopped; \b false \b if the flag had no timer.
+			 */
+			bool cancel(std::int32_t entity, Enum flag)
+			{
+				typename lookup_type::iterator found = _lookup.find(make_key(entity, flag));
+
+				if (found == _lookup.end())
+					return false;
+
+				const std::int32_t node = found->second;
+
+				unlink(node);
+				release(node);
+				_lookup.erase(found);
+
+				return true;
+			}
+
+			/**
+			 * Gets the number of ticks until a flag expires.
+			 *
+			 * \param entity The index of the entity.
+			 * \param flag The flag.
+			 * \returns The number of ticks remaining, or 0 if the flag has no timer.
+			 */
+			std::uint64_t remaining(std::int32_t entity, Enum flag) const
+			{
+				typename lookup_type::const_iterator found = _lookup.find(make_key(entity, flag));
+
+				return (found != _lookup.end()) ? _nodes[found->second].expiry - _now : 0;
+			}
+
+			/**
+			 * Gets the number of running timers.
+			 */
+			std::size_t size() const
+			{
+				return _lookup.size();
+			}
+
+			/**
+			 * Gets the current tick.
+			 */
+			std::uint64_t now() const
+			{
+				return _now;
+			}
+
+			//----------------------------------------------------------------------
+			// Advancing
+			//----------------------------------------------------------------------
+
+			/**
+			 * Advances time, clearing the flags that expire.
+			 *
+			 * \param flags The flag_sets of the entities.
+			 * \param ticks The number of ticks to advance.
+			 * \returns The number of flags cleared.
+			 */
+			template <std::int32_t Size, typename Names>
+			std::size_t advance(flag_set<Enum, Size, Names>* flags, std::uint64_t ticks = 1)
+			{
+				return advance(flags, ticks, [] (std::int32_t, Enum) { });
+			}
+
+			/**
+			 * Advances time, clearing the flags that expire.
+			 *
+			 * The function is called for the expiries of a tick once every
+			 * timer of that tick has been processed, so it may set or cancel
+			 * timers, including those expiring on the same tick.
+			 *
+			 * \param flags The flag_sets of the entities.
+			 * \param ticks The number of ticks to advance.
+			 * \param function Invoked with the entity and flag of each expiry after the flag is cleared.
+			 * \returns The number of flags cleared.
+			 */
+			template <std::int32_t Size, typename Names, typename Function>
+			std::size_t advance(flag_set<Enum, Size, Names>* flags, std::uint64_t ticks, Function function)
+			{
+				const std::uint64_t target = _now + ticks;
+				std::size_t expired = 0;
+
+				while (_now < target)
+				{
+					// Skip the ticks where no slot holds a timer
+					const std::uint64_t next = _lookup.empty() ? target : next_event();
+
+					if (next > target)
+					{
+						_now = target;
+						break;
+					}
+
+					_now = next;
+
+					// Cascade the higher wheels whose slot changed, highest first
+					for (std::int32_t level = levels - 1; level > 0; --level)
+					{
+						if ((_now & ((std::uint64_t(1) << (level * slot_bits)) - 1)) == 0)
+							cascade(level, slot_of(_now, level));
+					}
+
+					expired += expire(flags, slot_of(_now, 0), function);
+				}
+
+				return expired;
+			}
+
+		private:
+
+			/**
+			 * A running timer.
+			 */
+			struct timer_node
+			{
+				/// The tick the flag expires on
+				std::uint64_t expiry;
+				/// The index of the entity
+				std::int32_t entity;
+				/// The flag to clear
+				Enum flag;
+				/// The previous node in the slot, or -1
+				std::int32_t previous;
+				/// The next node in the slot or free list, or -1
+				std::int32_t next;
+				/// The wheel holding the node
+				std::int32_t level;
+				/// The slot holding the node
+				std::int32_t slot;
+			} ;
+
+			/**
+			 * A flag that expired and is waiting for its callback.
+			 */
+			struct expired_flag
+			{
+				/// The index of the entity
+				std::int32_t entity;
+				/// The flag cleared
+				Enum flag;
+			} ;
+
+			typedef std::unordered_map<std::uint64_t, std::int32_t> lookup_type;
+
+			static std::uint64_t make_key(std::int32_t entity, Enum flag)
+			{
+				return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(entity)) << 32) | static_cast<std::uint32_t>(flag);
+			}
+
+			static std::int32_t slot_of(std::uint64_t tick, std::int32_t level)
+			{
+				return static_cast<std::int32_t>((tick >> (level * slot_bits)) & (slot_count - 1));
+			}
+
+			std::int32_t allocate()
+			{
+				if (_free < 0)
+				{
+					_nodes.push_back(timer_node());
+					return static_cast<std::int32_t>(_nodes.size()) - 1;
+				}
+
+				const std::int32_t node = _free;
+				_free = _nodes[node].next;
+
+				return node;
+			}
+
+			void release(std::int32_t node)
+			{
+				_nodes[node].next = _free;
+				_free = node;
+			}
+
+			/**
+			 * Finds the next tick that reaches an occupied slot.
+			 *
+			 * Below the last wheel every timer is in a slot ahead of the
+			 * current one, so the first wheel with an occupied slot ahead
+			 * gives the next tick anything can happen. Otherwise only
+			 * parked timers remain in the last wheel.
+			 */
+			std::uint64_t next_event() const
+			{
+				for (std::int32_t level = 0; level < levels; ++level)
+				{
+					const std::int32_t current = slot_of(_now, level);
+					const std::uint64_t ahead = (current == slot_count - 1) ? 0 : _occupied[level] & (~std::uint64_t(0) << (current + 1));
+
+					if (ahead != 0)
+					{
+						const std::int32_t shift = (level + 1) * slot_bits;
+
+						return ((_now >> shift) << shift) | (static_cast<std::uint64_t>(detail::count_trailing_zeros(ahead)) << (level * slot_bits));
+					}
+				}
+
+				// Wrap the last wheel to its first occupied slot
+				const std::int32_t shift = levels * slot_bits;
+				const std::uint64_t slot = (_occupied[levels - 1] != 0) ? detail::count_trailing_zeros(_occupied[levels - 1]) : 0;
+
+				return (((_now >> shift) + 1) << shift) | (slot << ((levels - 1) * slot_bits));
+			}
+
+			/**
+			 * Places a node in the wheel covering its expiry.
+			 */
+			void schedule(std::int32_t node)
+			{
+				timer_node& timer = _nodes[node];
+
+				RECHARGEABLE_ASSERT(timer.expiry >= _now, "Timer has already expired");
+
+				// The wheel is chosen by the highest bit where the expiry differs from now
+				const std::uint64_t difference = timer.expiry ^ _now;
+				std::int32_t level = (difference != 0) ? (63 - detail::count_leading_zeros(difference)) / slot_bits : 0;
+
+				// Timers beyond the last wheel wait in its slot for their expiry and are rescheduled each revolution until in range
+				if (level >= levels)
+					level = levels - 1;
+
+				const std::int32_t slot = slot_of(timer.expiry, level);
+
+				timer.level = level;
+				timer.slot = slot;
+				timer.previous = -1;
+				timer.next = _slots[level][slot];
+
+				if (timer.next >= 0)
+					_nodes[timer.next].previous = node;
+
+				_slots[level][slot] = node;
+				_occupied[level] |= std::uint64_t(1) << slot;
+			}
+
+			/**
+			 * Removes a node from its slot.
+			 */
+			void unlink(std::int32_t node)
+			{
+				const timer_node& timer = _nodes[node];
+
+				if (timer.previous >= 0)
+					_nodes[timer.previous].next = timer.next;
+				else
+					_slots[timer.level][timer.slot] = timer.next;
+
+				if (timer.next >= 0)
+					_nodes[timer.next].previous = timer.previous;
+
+				if (_slots[timer.level][timer.slot] < 0)
+					_occupied[timer.level] &= ~(std::uint64_t(1) << timer.slot);
+			}
+
+			/**
+			 * Detaches every node in a slot.
+			 *
+			 * \returns The first node of the detached list.
+			 */
+			std::int32_t take_slot(std::int32_t level, std::int32_t slot)
+			{
+				const std::int32_t first = _slots[level][slot];
+
+				_slots[level][slot] = -1;
+				_occupied[level] &= ~(std::uint64_t(1) << slot);
+
+				return first;
+			}
+
+			/**
+			 * Moves the nodes of a slot of a higher wheel to the wheels below.
+			 */
+			void cascade(std::int32_t level, std::int32_t slot)
+			{
+				if ((_occupied[level] & (std::uint64_t(1) << slot)) == 0)
+					return;
+
+				std::int32_t node = take_slot(level, slot);
+
+				while (node >= 0)
+				{
+					const std::int32_t next = _nodes[node].next;
+
+					schedule(node);
+					node = next;
+				}
+			}
+
+			/**
+			 * Clears the flags of the expired nodes in a slot of the first wheel.
+			 *
+			 * The whole slot is processed before any function is called, as
+			 * the function may modify the timers.
+			 */
+			template <typename FlagSet, typename Function>
+			std::size_t expire(FlagSet* flags, std::int32_t slot, Function& function)
+			{
+				if ((_occupied[0] & (std::uint64_t(1) << slot)) == 0)
+					return 0;
+
+				// Appended to rather than cleared in case a function advances again
+				const std::size_t first = _expired.size();
+				std::int32_t node = take_slot(0, slot);
+
+				while (node >= 0)
+				{
+					timer_node& timer = _nodes[node];
+					const std::int32_t next = timer.next;
+
+					if (timer.expiry <= _now)
+					{
+						expired_flag entry;
+						entry.entity = timer.entity;
+						entry.flag = timer.flag;
+
+						flags[timer.entity].clear(timer.flag);
+
+						_lookup.erase(make_key(timer.entity, timer.flag));
+						release(node);
+
+						_expired.push_back(entry);
+					}
+					else
+					{
+						schedule(node);
+					}
+
+					node = next;
+				}
+
+				const std::size_t expired = _expired.size() - first;
+
+				for (std::size_t i = first; i < first + expired; ++i)
+				{
+					const expired_flag entry = _expired[i];
+
+					function(entry.entity, entry.flag);
+				}
+
+				_expired.resize(first);
+
+				return expired;
+			}
+
+			/// The current tick
+			std::uint64_t _now;
+			/// The first node of each slot of each wheel, or -1
+			std::int32_t _slots[levels][slot_count];
+			/// The occupied slots of each wheel
+			std::uint64_t _occupied[levels];
+			/// The timer nodes
+			std::vector<timer_node> _nodes;
+			/// The first free node, or -1
+			std::int32_t _free;
+			/// Maps an entity and flag to its node
+			lookup_type _lookup;
+			/// The expiries waiting for their callbacks
+			std::vector<expired_flag> _expired;
+
+	} ; // end class timed_flag_manager
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_TIMED_FLAG_MANAGER_HPP_INCLUDED
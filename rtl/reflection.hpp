@@ -39,5 +39,6 @@
 #define RECHARGEABLE_REFLECTION_HPP_INCLUDED
 
 #include <rtl/reflection/class_info.hpp>
+#include <rtl/reflection/class_registry.hpp>
 
 #endif // end RECHARGEABLE_REFLECTION_HPP_INCLUDED
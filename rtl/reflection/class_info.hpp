@@ -38,13 +38,29 @@
 #ifndef RECHARGEABLE_CLASS_INFO_HPP_INCLUDED
 #define RECHARGEABLE_CLASS_INFO_HPP_INCLUDED
 
+#include <cstdint>
+
 namespace rtl
 {
+	class class_registry;
+
 	/**
 	 * Contains class information.
 	 *
 	 * Holds runtime type information on a class.
 	 *
+	 * Every class_info is kept in a list of all classes. Calling finalize
+	 * numbers the classes in a preorder walk of the hierarchy, so the
+	 * classes derived from a class are exactly those numbered within its
+	 * interval. After that is_derived compares the numbers of the two
+	 * classes rather than walking the chain of base classes. Classes
+	 * created after finalize fall back to walking the chain until
+	 * finalize is called again.
+	 *
+	 * Each class also has a 64-bit identifier hashed from its name, which
+	 * is stable across runs and builds and can be computed at compile
+	 * time with make_id.
+	 *
 	 * \author Don Olmstead
 	 * \version 0.1
 	 */
@@ -60,6 +76,14 @@ namespace rtl
 			 */
 			class_info(const char* name, const class_info* base);
 
+			/**
+			 * Destroys an instance of the class_info class.
+			 */
+			~class_info();
+
+			class_info(const class_info&) = delete;
+			class_info& operator= (const class_info&) = delete;
+
 			/**
 			 * Gets the name of the class.
 			 *
@@ -70,6 +94,26 @@ namespace rtl
 				return _name;
 			}
 
+			/**
+			 * Gets the identifier of the class.
+			 *
+			 * \returns The identifier hashed from the name of the class.
+			 */
+			inline std::uint64_t id() const
+			{
+				return _id;
+			}
+
+			/**
+			 * Gets the base class.
+			 *
+			 * \returns The base class, or null if the class has no base.
+			 */
+			inline const class_info* base() const
+			{
+				return _base;
+			}
+
 			/**
 			 * Determines if the class is exactly the same as the given class_info.
 			 *
@@ -84,20 +128,80 @@ namespace rtl
 			/**
 			 * Determines if the instance is derived from the given class_info.
 			 *
-			 * Traverses the hierarchy to determine if the instance is derived from the
-			 * given class_info.
+			 * When both classes have been numbered by finalize this is a
+			 * single comparison. Otherwise the hierarchy is traversed.
 			 *
 			 * \param type The class_info instance to compare against.
 			 * \returns \b true \b if the instance derives from the class; \b false \b otherwise.
 			 */
-			bool is_derived(const class_info& type) const;
+			inline bool is_derived(const class_info& type) const
+			{
+				if (_ordered && type._ordered)
+					return static_cast<std::uint32_t>(_preorder - type._preorder) <= type._descendants;
+
+				return walk_hierarchy(type);
+			}
+
+			/**
+			 * Numbers every class in a preorder walk of the hierarchy.
+			 *
+			 * Should be called once all the classes have been created, and
+			 * again if more are created later. Must not be called while other
+			 * threads are using the classes.
+			 */
+			static void finalize();
+
+			/**
+			 * Computes the identifier of a class from its name.
+			 *
+			 * Uses the 64-bit FNV-1a hash of the name.
+			 *
+			 * \param name The name of the class.
+			 * \returns The identifier of the class.
+			 */
+			static constexpr std::uint64_t make_id(const char* name)
+			{
+				std::uint64_t hash = 14695981039346656037ull;
+
+				for (; *name; ++name)
+				{
+					hash ^= static_cast<unsigned char>(*name);
+					hash *= 1099511628211ull;
+				}
+
+				return hash;
+			}
 
 		private:
 
-			/// Pointer to the base class
-			const class_info* _base;
+			friend class class_registry;
+
+			/**
+			 * Determines if the instance is derived from the given class_info
+			 * by traversing the chain of base classes.
+			 *
+			 * \param type The class_info instance to compare against.
+			 * \returns \b true \b if the instance derives from the class; \b false \b otherwise.
+			 */
+			bool walk_hierarchy(const class_info& type) const;
+
 			/// The name of the class
 			const char* _name;
+			/// Pointer to the base class
+			const class_info* _base;
+			/// The identifier hashed from the name
+			std::uint64_t _id;
+			/// The position of the class in a preorder walk of the hierarchy
+			std::int32_t _preorder;
+			/// The number of classes derived from the class
+			std::uint32_t _descendants;
+			/// Whether the class has been numbered by finalize
+			bool _ordered;
+			/// The next class in the list of all classes
+			class_info* _next;
+
+			/// The first class in the list of all classes
+			static class_info* _head;
 
 	} ; // end class class_info
 
@@ -0,0 +1,181 @@
+/**
+ * \file class_registry.hpp
+ * 
+ * \section COPYRIGHT
+ *
+ * Rechargeable Template Library
+ *
+ * ---------------------------------------------------------------------
+ *
+ * Copyright (c) 2011, Don Olmstead
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  3. Neither the name of organization nor the names of its contributors may be
+ *     used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RECHARGEABLE_CLASS_REGISTRY_HPP_INCLUDED
+#define RECHARGEABLE_CLASS_REGISTRY_HPP_INCLUDED
+
+#include <rtl/reflection/class_info.hpp>
+#include <cstddef>
+#include <cstring>
+
+namespace rtl
+{
+	/**
+	 * Finds class_info instances by name or identifier.
+	 *
+	 * The registry collects every class_info when build is called and
+	 * places them in a perfect hash table keyed on their identifiers.
+	 * Each bucket of identifiers has a seed chosen so that no two classes
+	 * land in the same slot, so a lookup hashes once, reads one seed and
+	 * one slot, and compares the identifier found there. Looking up a
+	 * name hashes it into an identifier first and then compares the name.
+	 * Lookups do not allocate.
+	 *
+	 * Classes created after build are not found until build is called
+	 * again. Destroyed classes are removed automatically. The tables are
+	 * plain arrays so classes destroyed during static destruction can
+	 * still remove themselves.
+	 *
+	 * \code
+	 * rtl::class_registry::build();
+	 *
+	 * const rtl::class_info* type = rtl::class_registry::find("Player");
+	 * \endcode
+	 *
+	 * \author Don Olmstead
+	 * \version 0.1
+	 */
+	class class_registry
+	{
+		public:
+
+			/**
+			 * Collects every class_info and builds the lookup tables.
+			 *
+			 * Also numbers the hierarchy through class_info::finalize. Must
+			 * not be called while other threads are using the registry.
+			 *
+			 * \returns \b true \b if the tables were built; \b false \b if two classes share an identifier.
+			 */
+			static bool build();
+
+			/**
+			 * Gets the number of registered classes.
+			 */
+			static inline std::size_t size()
+			{
+				return _count;
+			}
+
+			/**
+			 * Gets the first of the registered classes in the order they were created.
+			 */
+			static inline const class_info* const* begin()
+			{
+				return _classes;
+			}
+
+			/**
+			 * Gets the end of the registered classes.
+			 */
+			static inline const class_info* const* end()
+			{
+				return _classes + _count;
+			}
+
+			/**
+			 * Finds a class by identifier.
+			 *
+			 * \param id The identifier of the class.
+			 * \returns The class, or null if no class has the identifier.
+			 */
+			static inline const class_info* find(std::uint64_t id)
+			{
+				const std::uint64_t hash = mix(id);
+				const class_info* type = _slots[mix(hash + _seeds[hash & _bucketMask]) & _slotMask];
+
+				return ((type != 0) && (type->_id == id)) ? type : 0;
+			}
+
+			/**
+			 * Finds a class by name.
+			 *
+			 * \param name The name of the class.
+			 * \returns The class, or null if no class has the name.
+			 */
+			static inline const class_info* find(const char* name)
+			{
+				const class_info* type = find(class_info::make_id(name));
+
+				return ((type != 0) && (std::strcmp(type->_name, name) == 0)) ? type : 0;
+			}
+
+		private:
+
+			friend class class_info;
+
+			/**
+			 * Removes a class that is being destroyed.
+			 *
+			 * \param type The class to remove.
+			 */
+			static void remove(const class_info& type);
+
+			/**
+			 * Mixes the bits of a 64-bit value.
+			 *
+			 * Uses the finalizer of SplitMix64.
+			 *
+			 * \param value The value to mix.
+			 * \returns The mixed value.
+			 */
+			static inline std::uint64_t mix(std::uint64_t value)
+			{
+				value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+				value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+
+				return value ^ (value >> 31);
+			}
+
+			/// The registered classes
+			static const class_info** _classes;
+			/// The number of registered classes
+			static std::size_t _count;
+			/// The seed of each bucket
+			static std::uint64_t* _seeds;
+			/// The class in each slot of the table
+			static const class_info** _slots;
+			/// The mask selecting a bucket
+			static std::uint64_t _bucketMask;
+			/// The mask selecting a slot
+			static std::uint64_t _slotMask;
+
+	} ; // end class class_registry
+
+} // end namespace rtl
+
+#endif // end RECHARGEABLE_CLASS_REGISTRY_HPP_INCLUDED